@@ -35,11 +35,22 @@ struct build_arguments
     // Related to IBF
     std::filesystem::path out_path{"./"};
     uint64_t bins{64};
+    uint64_t reserved_bins{0};
     mutable uint64_t bits{4096}; // Allow to change bits for each partition
     uint64_t hash{2};
     uint8_t parts{1u};
     double fpr{0.05};
     bool compressed{false};
+    uint64_t memory_limit{0}; // In MiB
+    uint64_t uncompressed_levels{0};
+    std::filesystem::path checkpoint_dir{};
+
+    // Related to estimating the bin size
+    bool estimate_bin_size{false};
+    std::filesystem::path sketch_cache{};
+    uint64_t retain_hashes{0}; // In MiB
+    // Hashes of user bins that were read while estimating the bin size. Consumed by the index_factory.
+    mutable std::vector<std::vector<uint64_t>> retained_hashes{};
 
     // General arguments
     std::vector<std::vector<std::string>> bin_path{};
@@ -47,7 +58,9 @@ struct build_arguments
     uint8_t threads{1u};
     bool is_hibf{false};
     bool input_is_minimiser{false};
+    std::filesystem::path minimiser_cache_dir{};
     bool quiet{false};
+    bool dry_run{false};
 
     // Timers do not copy the stored duration upon copy construction/assignment
     mutable timer<concurrent::yes> wall_clock_timer{};
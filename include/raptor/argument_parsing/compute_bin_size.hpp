@@ -14,10 +14,19 @@
 
 #include <raptor/argument_parsing/build_arguments.hpp>
 #include <raptor/argument_parsing/upgrade_arguments.hpp>
+#include <raptor/hyperloglog.hpp>
 
 namespace raptor
 {
 
+namespace detail
+{
+
+//!\brief Loads a sketch stored via `--sketch-cache`. Returns `false` if the stored key does not match.
+bool load_sketch(std::filesystem::path const & path, std::string const & key, hyperloglog & sketch);
+
+} // namespace detail
+
 size_t compute_bin_size(raptor::build_arguments const & arguments);
 size_t max_bin_count(upgrade_arguments const & arguments);
 
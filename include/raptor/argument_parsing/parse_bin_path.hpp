@@ -14,6 +14,7 @@
 
 #include <raptor/argument_parsing/build_arguments.hpp>
 #include <raptor/argument_parsing/prepare_arguments.hpp>
+#include <raptor/argument_parsing/update_arguments.hpp>
 #include <raptor/argument_parsing/upgrade_arguments.hpp>
 
 namespace raptor
@@ -31,5 +32,6 @@ void parse_bin_path(std::filesystem::path const & bin_file,
 void parse_bin_path(build_arguments & arguments);
 void parse_bin_path(prepare_arguments & arguments);
 void parse_bin_path(upgrade_arguments & arguments);
+void parse_bin_path(update_arguments & arguments);
 
 } // namespace raptor
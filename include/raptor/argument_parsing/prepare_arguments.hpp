@@ -38,13 +38,13 @@ struct prepare_arguments
     std::vector<std::vector<std::string>> bin_path{};
     std::filesystem::path bin_file{};
     uint8_t threads{1u};
+    uint64_t memory_limit{0}; // In MiB
     bool quiet{false};
 
     // Timers do not copy the stored duration upon copy construction/assignment
     mutable timer<concurrent::yes> wall_clock_timer{};
     mutable timer<concurrent::yes> compute_minimiser_timer{};
     mutable timer<concurrent::yes> write_minimiser_timer{};
-    mutable timer<concurrent::yes> write_header_timer{};
 
     void print_timings() const
     {
@@ -55,7 +55,6 @@ struct prepare_arguments
         std::cerr << "Peak memory usage " << formatted_peak_ram() << '\n';
         std::cerr << "Compute minimiser [s]: " << compute_minimiser_timer.in_seconds() / threads << '\n';
         std::cerr << "Write minimiser files [s]: " << write_minimiser_timer.in_seconds() / threads << '\n';
-        std::cerr << "Write header files [s]: " << write_header_timer.in_seconds() / threads << '\n';
     }
 };
 
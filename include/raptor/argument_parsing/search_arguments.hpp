@@ -45,6 +45,8 @@ struct search_arguments
     // Related to IBF
     std::filesystem::path index_file{};
     bool compressed{false};
+    bool lazy_load{false};
+    uint64_t cache_limit{0}; // In MiB
 
     // General arguments
     std::vector<std::vector<std::string>> bin_path{};
@@ -64,6 +66,11 @@ struct search_arguments
     mutable timer<concurrent::yes> query_ibf_timer{};
     mutable timer<concurrent::yes> generate_results_timer{};
 
+    // Accesses of lazily loaded IBFs
+    mutable uint64_t ibf_cache_hits{};
+    mutable uint64_t ibf_cache_misses{};
+    mutable uint64_t ibf_cache_evictions{};
+
     void print_timings() const
     {
         if (quiet)
@@ -77,6 +84,12 @@ struct search_arguments
         std::cerr << "Compute minimiser [s]: " << compute_minimiser_timer.in_seconds() / threads << '\n';
         std::cerr << "Query IBF [s]: " << query_ibf_timer.in_seconds() / threads << '\n';
         std::cerr << "Generate results [s]: " << generate_results_timer.in_seconds() / threads << '\n';
+        if (lazy_load)
+        {
+            std::cerr << "IBF cache hits: " << ibf_cache_hits << '\n';
+            std::cerr << "IBF cache misses: " << ibf_cache_misses << '\n';
+            std::cerr << "IBF cache evictions: " << ibf_cache_evictions << '\n';
+        }
     }
 
     raptor::threshold::threshold_parameters make_threshold_parameters() const noexcept
@@ -0,0 +1,68 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::update_arguments.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include <seqan3/search/kmer_index/shape.hpp>
+
+#include <raptor/argument_parsing/memory_usage.hpp>
+#include <raptor/argument_parsing/timer.hpp>
+
+namespace raptor
+{
+
+struct update_arguments
+{
+    // Read from index
+    uint32_t window_size{};
+    seqan3::shape shape{};
+    uint8_t parts{1u};
+    bool compressed{};
+    bool is_hibf{};
+
+    // General arguments
+    std::filesystem::path index_file{};
+    std::filesystem::path output_file{};
+    std::filesystem::path insert_file{};
+    std::filesystem::path remove_file{};
+    std::filesystem::path replace_file{};
+    std::vector<std::vector<std::string>> insert_bin_path{};
+    std::vector<std::vector<std::string>> remove_bin_path{};
+    std::vector<std::vector<std::string>> replace_bin_path{};     // The user bins to replace.
+    std::vector<std::vector<std::string>> replacement_bin_path{}; // The new content of the replaced user bins.
+    uint8_t threads{1u};
+    bool quiet{false};
+
+    // Timers do not copy the stored duration upon copy construction/assignment
+    mutable timer<concurrent::yes> wall_clock_timer{};
+    mutable timer<concurrent::yes> load_index_timer{};
+    mutable timer<concurrent::yes> user_bin_io_timer{};
+    mutable timer<concurrent::yes> store_index_timer{};
+
+    void print_timings() const
+    {
+        if (quiet)
+            return;
+        std::cerr << std::fixed << std::setprecision(2) << "============= Timings =============\n";
+        std::cerr << "Wall clock time [s]: " << wall_clock_timer.in_seconds() << '\n';
+        std::cerr << "Peak memory usage " << formatted_peak_ram() << '\n';
+        std::cerr << "Load index [s]: " << load_index_timer.in_seconds() << '\n';
+        std::cerr << "User bin I/O avg per thread [s]: " << user_bin_io_timer.in_seconds() / threads << '\n';
+        std::cerr << "User bin I/O sum [s]: " << user_bin_io_timer.in_seconds() << '\n';
+        std::cerr << "Store index [s]: " << store_index_timer.in_seconds() << '\n';
+    }
+};
+
+} // namespace raptor
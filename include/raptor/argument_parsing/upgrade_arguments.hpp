@@ -25,7 +25,9 @@ struct upgrade_arguments
     uint32_t window_size{};
     seqan3::shape shape{};
     bool compressed{};
+    bool is_hibf{};
     bool input_is_minimiser{};
+    uint32_t index_version{};
     uint8_t parts{1u};
     uint8_t threads{1u};
     double fpr{std::numeric_limits<double>::quiet_NaN()};
@@ -33,6 +35,7 @@ struct upgrade_arguments
     std::filesystem::path bin_file{};
     std::filesystem::path index_file{};
     std::filesystem::path output_file{};
+    std::filesystem::path minimiser_cache_dir{};
 
     std::vector<std::vector<std::string>> bin_path{};
 };
@@ -0,0 +1,136 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::atomic_inserter.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <mutex>
+
+#include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
+
+#include <raptor/counting_kernel.hpp>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+//!\brief The geometry of an uncompressed seqan3::interleaved_bloom_filter that determines the positions of values.
+struct ibf_geometry
+{
+    uint64_t * data{nullptr};
+    uint64_t bin_size{};
+    int hash_shift{};
+    size_t hash_count{};
+    size_t bin_words{};
+
+    explicit ibf_geometry(seqan3::interleaved_bloom_filter<> & ibf) :
+        data{ibf.raw_data().data()},
+        bin_size{ibf.bin_size()},
+        hash_shift{std::countl_zero(bin_size)},
+        hash_count{ibf.hash_function_count()},
+        bin_words{(ibf.bin_count() + 63u) / 64u}
+    {}
+
+    //!\brief Sets the bits of `value` in `bin` via atomic fetch-or. Other threads may set bits of the same words.
+    void atomic_emplace(uint64_t const value, size_t const bin) const noexcept
+    {
+        uint64_t const bit = 1ULL << (bin % 64u);
+        uint64_t * const words = data + bin / 64u;
+        for (size_t h = 0; h < hash_count; ++h)
+        {
+            uint64_t & word = words[ibf_row(value, ibf_hash_seeds[h], bin_size, hash_shift, bin_words)];
+            std::atomic_ref<uint64_t>{word}.fetch_or(bit, std::memory_order_relaxed);
+        }
+    }
+};
+
+/*!\brief Checks whether raptor::detail::ibf_geometry::atomic_emplace sets the same bits as
+ *        seqan3::interleaved_bloom_filter::emplace. The result is computed once.
+ */
+inline bool atomic_inserter_is_compatible()
+{
+    static bool const is_compatible = []()
+    {
+        for (size_t const bins : {size_t{64u}, size_t{130u}})
+        {
+            for (size_t const hash_count : {size_t{1u}, ibf_hash_seeds.size()})
+            {
+                seqan3::interleaved_bloom_filter<> expected{seqan3::bin_count{bins},
+                                                            seqan3::bin_size{1031u},
+                                                            seqan3::hash_function_count{hash_count}};
+                seqan3::interleaved_bloom_filter<> actual{expected};
+                ibf_geometry const geometry{actual};
+
+                for (uint64_t value = 0; value < 256u; ++value)
+                {
+                    expected.emplace(value * 0x9E3779B97F4A7C15ULL, seqan3::bin_index{value % bins});
+                    geometry.atomic_emplace(value * 0x9E3779B97F4A7C15ULL, value % bins);
+                }
+
+                if (!(expected == actual))
+                    return false;
+            }
+        }
+        return true;
+    }();
+
+    return is_compatible;
+}
+
+} // namespace detail
+
+/*!\brief Inserts values into an uncompressed seqan3::interleaved_bloom_filter from several threads without locks.
+ * \details
+ * seqan3::interleaved_bloom_filter::emplace is not thread-safe, since the rows of neighbouring bins share 64 bit
+ * words. This inserter sets the bits via an atomic fetch-or on the words instead, hence threads may insert into any
+ * bins at the same time.
+ * The IBF's hash functions are an implementation detail of SeqAn. If raptor::detail::ibf_row does not match them, the
+ * inserter falls back to calling seqan3::interleaved_bloom_filter::emplace under a mutex.
+ * Can be used with raptor::emplacer.
+ */
+class atomic_inserter
+{
+public:
+    atomic_inserter() = delete;
+    atomic_inserter(atomic_inserter const &) = delete;
+    atomic_inserter & operator=(atomic_inserter const &) = delete;
+    atomic_inserter(atomic_inserter &&) = delete;
+    atomic_inserter & operator=(atomic_inserter &&) = delete;
+    ~atomic_inserter() = default;
+
+    explicit atomic_inserter(seqan3::interleaved_bloom_filter<> & ibf) :
+        ibf{std::addressof(ibf)},
+        geometry{ibf},
+        is_compatible{detail::atomic_inserter_is_compatible()}
+    {}
+
+    void emplace(uint64_t const value, seqan3::bin_index const bin)
+    {
+        if (is_compatible)
+            return geometry.atomic_emplace(value, bin.get());
+
+        std::lock_guard<std::mutex> guard{fallback_mutex};
+        ibf->emplace(value, bin);
+    }
+
+private:
+    seqan3::interleaved_bloom_filter<> * ibf{nullptr};
+    detail::ibf_geometry geometry;
+    bool is_compatible{};
+    std::mutex fallback_mutex{};
+};
+
+} // namespace raptor
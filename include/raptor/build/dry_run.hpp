@@ -0,0 +1,28 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::dry_run.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <raptor/argument_parsing/build_arguments.hpp>
+
+namespace raptor
+{
+
+/*!\brief Prints the estimated index size, peak memory usage, and I/O volume of a build without building the index.
+ * \details
+ * The number of minimisers of each file is, in this order of preference, read from minimiser files, the
+ * `--minimiser-cache`, or the `--sketch-cache`. Otherwise, it is derived from the size of the file. For the HIBF, the
+ * estimates of the layout file are used if available.
+ */
+void dry_run(build_arguments const & arguments);
+
+} // namespace raptor
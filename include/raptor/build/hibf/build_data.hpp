@@ -12,10 +12,9 @@
 
 #pragma once
 
-#include <atomic>
-#include <seqan3/std/new>
-
 #include <raptor/build/hibf/node_data.hpp>
+#include <raptor/build/hibf/sorted_kmers.hpp>
+#include <raptor/build/hibf/task_pool.hpp>
 #include <raptor/hierarchical_interleaved_bloom_filter.hpp>
 
 namespace raptor::hibf
@@ -24,27 +23,23 @@ namespace raptor::hibf
 template <seqan3::data_layout data_layout_mode>
 struct build_data
 {
-    alignas(std::hardware_destructive_interference_size) std::atomic<size_t> ibf_number{};
-    alignas(std::hardware_destructive_interference_size) std::atomic<size_t> user_bin_number{};
-
     size_t number_of_user_bins{};
     size_t number_of_ibfs{};
 
+    //!\brief The IBFs of this many levels are not compressed. See build_arguments::uncompressed_levels.
+    size_t uncompressed_levels{};
+
     lemon::ListDigraph ibf_graph{};
     lemon::ListDigraph::NodeMap<node_data> node_map{ibf_graph};
 
     hierarchical_interleaved_bloom_filter<data_layout_mode> hibf{};
     std::vector<double> fp_correction{};
 
-    size_t request_ibf_idx()
-    {
-        return std::atomic_fetch_add(&ibf_number, 1u);
-    }
+    //!\brief Bounds the memory used for the k-mers of merged bins.
+    kmer_spill spill{};
 
-    size_t request_user_bin_idx()
-    {
-        return std::atomic_fetch_add(&user_bin_number, 1u);
-    }
+    //!\brief Runs the subtrees and user bins of all levels in parallel.
+    task_pool pool{};
 
     void resize()
     {
@@ -52,6 +47,32 @@ struct build_data
         hibf.user_bins.set_ibf_count(number_of_ibfs);
         hibf.user_bins.set_user_bin_count(number_of_user_bins);
         hibf.next_ibf_id.resize(number_of_ibfs);
+
+        if (keeps_uncompressed_ibfs())
+            hibf.uncompressed_ibfs.resize(number_of_ibfs);
+    }
+
+    bool keeps_uncompressed_ibfs() const
+    {
+        return data_layout_mode == seqan3::data_layout::compressed && uncompressed_levels > 0u;
+    }
+
+    //!\brief Whether the IBF of `node` is kept uncompressed in a compressed HIBF.
+    bool keep_uncompressed(lemon::ListDigraph::Node node) const
+    {
+        if (!keeps_uncompressed_ibfs())
+            return false;
+
+        // The root is on level 0.
+        size_t level{};
+        for (lemon::ListDigraph::InArcIt arc{ibf_graph, node}; arc != lemon::INVALID;
+             arc = lemon::ListDigraph::InArcIt{ibf_graph, node})
+        {
+            node = ibf_graph.source(arc);
+            ++level;
+        }
+
+        return level < uncompressed_levels;
     }
 
     /*!\brief Precompute f_h factors that adjust the split bin size to prevent FPR inflation due to multiple testing.
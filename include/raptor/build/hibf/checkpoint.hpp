@@ -0,0 +1,50 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::hibf::store_checkpoint and raptor::hibf::load_checkpoint.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <raptor/argument_parsing/build_arguments.hpp>
+#include <raptor/build/hibf/build_data.hpp>
+#include <raptor/build/hibf/sorted_kmers.hpp>
+
+namespace raptor::hibf
+{
+
+/*!\brief Stores the IBF of a finished node and the k-mers it contributes to its parent in `--checkpoint-dir`.
+ * \details
+ * The checkpoint of a node is identified by its path in the layout. It is only valid for the same layout file and
+ * parameters. A node is stored after all nodes of its subtree, hence a valid checkpoint implies that the checkpoints of
+ * the whole subtree exist. `kmers` are merged.
+ */
+template <seqan3::data_layout data_layout_mode>
+void store_checkpoint(kmer_runs & kmers,
+                      size_t const ibf_pos,
+                      lemon::ListDigraph::Node const & node,
+                      build_data<data_layout_mode> & data,
+                      build_arguments const & arguments);
+
+//!\brief Returns `true` if there is a valid checkpoint for the node.
+template <seqan3::data_layout data_layout_mode>
+bool has_checkpoint(lemon::ListDigraph::Node const & node,
+                    build_data<data_layout_mode> & data,
+                    build_arguments const & arguments);
+
+/*!\brief Loads the IBFs of the subtree of the node from the checkpoints and adds its k-mers to the `parent_kmers`.
+ * \returns The position of the node's IBF.
+ */
+template <seqan3::data_layout data_layout_mode>
+size_t load_checkpoint(kmer_runs & parent_kmers,
+                       lemon::ListDigraph::Node const & node,
+                       build_data<data_layout_mode> & data,
+                       build_arguments const & arguments);
+
+} // namespace raptor::hibf
@@ -12,16 +12,16 @@
 
 #pragma once
 
-#include <robin_hood.h>
-
 #include <raptor/argument_parsing/build_arguments.hpp>
 #include <raptor/build/hibf/chopper_pack_record.hpp>
 
 namespace raptor::hibf
 {
 
-void compute_kmers(robin_hood::unordered_flat_set<size_t> & kmers,
+//!\brief Computes the sorted, duplicate-free k-mers of the record. `threads` are used for sorting.
+void compute_kmers(std::vector<uint64_t> & kmers,
                    build_arguments const & arguments,
-                   chopper_pack_record const & record);
+                   chopper_pack_record const & record,
+                   size_t const threads = 1u);
 
 } // namespace raptor::hibf
@@ -12,17 +12,16 @@
 
 #pragma once
 
-#include <robin_hood.h>
-
 #include <raptor/argument_parsing/build_arguments.hpp>
 #include <raptor/build/hibf/build_data.hpp>
+#include <raptor/build/hibf/sorted_kmers.hpp>
 
 namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-seqan3::interleaved_bloom_filter<> construct_ibf(robin_hood::unordered_flat_set<size_t> & parent_kmers,
-                                                 robin_hood::unordered_flat_set<size_t> & kmers,
+seqan3::interleaved_bloom_filter<> construct_ibf(kmer_runs & parent_kmers,
+                                                 kmer_runs & kmers,
                                                  size_t const number_of_bins,
                                                  lemon::ListDigraph::Node const & node,
                                                  build_data<data_layout_mode> & data,
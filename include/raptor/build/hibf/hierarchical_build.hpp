@@ -12,16 +12,15 @@
 
 #pragma once
 
-#include <robin_hood.h>
-
 #include <raptor/argument_parsing/build_arguments.hpp>
 #include <raptor/build/hibf/build_data.hpp>
+#include <raptor/build/hibf/sorted_kmers.hpp>
 
 namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-size_t hierarchical_build(robin_hood::unordered_flat_set<size_t> & parent_kmers,
+size_t hierarchical_build(kmer_runs & parent_kmers,
                           lemon::ListDigraph::Node const & current_node,
                           build_data<data_layout_mode> & data,
                           build_arguments const & arguments,
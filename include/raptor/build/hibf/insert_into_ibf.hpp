@@ -12,25 +12,31 @@
 
 #pragma once
 
-#include <robin_hood.h>
-
 #include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
 
 #include <raptor/argument_parsing/build_arguments.hpp>
+#include <raptor/build/atomic_inserter.hpp>
 #include <raptor/build/hibf/chopper_pack_record.hpp>
+#include <raptor/build/hibf/sorted_kmers.hpp>
 
 namespace raptor::hibf
 {
 
 // automatically does naive splitting if number_of_bins > 1
-void insert_into_ibf(robin_hood::unordered_flat_set<size_t> const & kmers,
+void insert_into_ibf(std::vector<uint64_t> const & kmers,
+                     size_t const number_of_bins,
+                     size_t const bin_index,
+                     atomic_inserter & ibf,
+                     timer<concurrent::yes> & fill_ibf_timer);
+
+//!\brief Inserts the merged runs. Same splitting as for a sorted vector of k-mers.
+void insert_into_ibf(kmer_runs & kmers,
                      size_t const number_of_bins,
                      size_t const bin_index,
-                     seqan3::interleaved_bloom_filter<> & ibf,
+                     atomic_inserter & ibf,
                      timer<concurrent::yes> & fill_ibf_timer);
 
-void insert_into_ibf(build_arguments const & arguments,
-                     chopper_pack_record const & record,
-                     seqan3::interleaved_bloom_filter<> & ibf);
+//!\brief Inserts a record that is not split. The minimisers are inserted while the files are read.
+void insert_into_ibf(build_arguments const & arguments, chopper_pack_record const & record, atomic_inserter & ibf);
 
 } // namespace raptor::hibf
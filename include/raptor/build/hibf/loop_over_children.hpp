@@ -12,21 +12,29 @@
 
 #pragma once
 
-#include <robin_hood.h>
-
 #include <raptor/argument_parsing/build_arguments.hpp>
 #include <raptor/build/hibf/build_data.hpp>
+#include <raptor/build/hibf/sorted_kmers.hpp>
 
 namespace raptor::hibf
 {
 
+//!\brief A merged bin whose subtree is built by raptor::hibf::hierarchical_build.
+struct merged_bin
+{
+    lemon::ListDigraph::Node child{};
+    size_t parent_bin_index{};
+    size_t ibf_pos{};
+    kmer_runs kmers{};
+};
+
+/*!\brief Returns the merged bins of all children except the favourite child, largest subtree first.
+ * \details Longest processing time first: Idle threads steal the oldest tasks, i.e., the largest subtrees.
+ *          The IBF positions of the subtrees are assigned in the same order when the layout is read, see
+ *          raptor::hibf::node_data::ibf_position.
+ */
 template <seqan3::data_layout data_layout_mode>
-void loop_over_children(robin_hood::unordered_flat_set<size_t> & parent_kmers,
-                        seqan3::interleaved_bloom_filter<> & ibf,
-                        std::vector<int64_t> & ibf_positions,
-                        lemon::ListDigraph::Node const & current_node,
-                        build_data<data_layout_mode> & data,
-                        build_arguments const & arguments,
-                        bool is_root);
+std::vector<merged_bin> loop_over_children(lemon::ListDigraph::Node const & current_node,
+                                           build_data<data_layout_mode> & data);
 
 } // namespace raptor::hibf
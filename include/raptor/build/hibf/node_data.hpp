@@ -28,6 +28,9 @@ struct node_data // rename:ibf_data? or ibf_node_data
     size_t number_of_technical_bins{};
     lemon::ListDigraph::Node favourite_child{lemon::INVALID};
     std::vector<chopper_pack_record> remaining_records{}; // non-merged bins (either split or single)
+    size_t estimated_size{}; // of all user bins in the subtree, used to schedule the largest subtrees first
+    size_t ibf_position{}; // position of this IBF in the HIBF
+    std::vector<size_t> user_bin_positions{}; // position of each remaining record in the HIBF's user bins
 
     bool operator==(node_data const & rhs) const
     {
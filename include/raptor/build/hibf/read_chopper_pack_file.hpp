@@ -20,6 +20,8 @@ namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-void read_chopper_pack_file(build_data<data_layout_mode> & data, std::string const & chopper_pack_filename);
+void read_chopper_pack_file(build_data<data_layout_mode> & data,
+                            std::string const & chopper_pack_filename,
+                            size_t const threads = 1u);
 
 } // namespace raptor::hibf
@@ -0,0 +1,204 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::hibf::sort_and_deduplicate, raptor::hibf::kmer_spill, and raptor::hibf::kmer_runs.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+namespace raptor::hibf
+{
+
+//!\brief Sorts the k-mers via a (parallel) LSD radix sort and removes duplicates.
+void sort_and_deduplicate(std::vector<uint64_t> & kmers, size_t const threads);
+
+/*!\brief Limits the memory used by all raptor::hibf::kmer_runs that share this object.
+ * \details Runs that do not fit into the memory limit are written to temporary files in a new directory
+ *          (raptor::detail::create_temporary_directory). Only this directory is removed on destruction.
+ *          Without a memory limit, nothing is written to disk.
+ */
+class kmer_spill
+{
+public:
+    kmer_spill() = default;
+    kmer_spill(kmer_spill const &) = delete;
+    kmer_spill & operator=(kmer_spill const &) = delete;
+    kmer_spill(kmer_spill &&) = delete;
+    kmer_spill & operator=(kmer_spill &&) = delete;
+    ~kmer_spill();
+
+    /*!\brief Sets the memory limit in bytes.
+     * \details The directory is created when the first run is written. Its name starts with `tmp_prefix`.
+     */
+    void configure(size_t const limit, std::filesystem::path tmp_prefix);
+
+    bool enabled() const noexcept
+    {
+        return memory_limit > 0u;
+    }
+
+    //!\brief Returns `false` if the bytes do not fit into the memory limit.
+    bool reserve(size_t const bytes) noexcept;
+    void release(size_t const bytes) noexcept;
+
+    //!\brief Returns a new, unique file name.
+    std::filesystem::path new_file();
+
+private:
+    size_t memory_limit{};
+    std::atomic<size_t> used_memory{};
+    std::atomic<size_t> file_counter{};
+    std::filesystem::path prefix{};
+    std::filesystem::path directory{};
+    std::mutex directory_mutex{};
+};
+
+namespace detail
+{
+
+//!\brief Reads a sorted run of k-mers, either from memory or from a file.
+class kmer_run_reader
+{
+public:
+    explicit kmer_run_reader(std::vector<uint64_t> const & run) : data{run.data()}, end{run.data() + run.size()}
+    {}
+
+    explicit kmer_run_reader(std::filesystem::path const & path) :
+        stream{std::make_unique<std::ifstream>(path, std::ios::binary)},
+        buffer(buffer_size)
+    {
+        refill();
+    }
+
+    //!\brief Returns `false` if the run is exhausted.
+    bool next(uint64_t & value)
+    {
+        if (data == end && (!stream || !refill()))
+            return false;
+
+        value = *data++;
+        return true;
+    }
+
+private:
+    static constexpr size_t buffer_size{1ULL << 15}; // 256 KiB
+
+    uint64_t const * data{nullptr};
+    uint64_t const * end{nullptr};
+    std::unique_ptr<std::ifstream> stream{};
+    std::vector<uint64_t> buffer{};
+
+    bool refill()
+    {
+        stream->read(reinterpret_cast<char *>(buffer.data()), buffer_size * sizeof(uint64_t));
+        data = buffer.data();
+        end = data + stream->gcount() / sizeof(uint64_t);
+        return data != end;
+    }
+};
+
+} // namespace detail
+
+/*!\brief Sorted, duplicate-free k-mer sets that have yet to be merged.
+ * \details
+ * Runs are kept in memory. If a raptor::hibf::kmer_spill with a memory limit is given, runs that exceed the limit are
+ * written to temporary files. All operations stream over the runs via a k-way merge.
+ */
+class kmer_runs
+{
+public:
+    kmer_runs() = default;
+    kmer_runs(kmer_runs const &) = delete;
+    kmer_runs & operator=(kmer_runs const &) = delete;
+    kmer_runs(kmer_runs && other) noexcept;
+    kmer_runs & operator=(kmer_runs && other) noexcept;
+    ~kmer_runs();
+
+    explicit kmer_runs(kmer_spill & spill) : spill{std::addressof(spill)}
+    {}
+
+    //!\brief Adds a sorted, duplicate-free run.
+    void push_back(std::vector<uint64_t> && run);
+    //!\brief Merges the runs of `other` into one run and adds it.
+    void push_back(kmer_runs && other);
+
+    bool empty() const noexcept
+    {
+        return memory_runs.empty() && file_runs.empty();
+    }
+
+    //!\brief Merges all runs into one run.
+    void merge();
+
+    //!\brief Returns the number of distinct k-mers. Merges all runs.
+    size_t count();
+
+    //!\brief Calls `callback` for each distinct k-mer in ascending order.
+    template <typename callback_t>
+    void for_each(callback_t && callback) const
+    {
+        std::vector<detail::kmer_run_reader> readers{};
+        readers.reserve(memory_runs.size() + file_runs.size());
+        for (auto const & run : memory_runs)
+            readers.emplace_back(run);
+        for (auto const & path : file_runs)
+            readers.emplace_back(path);
+
+        // (value, reader)
+        using cursor_t = std::pair<uint64_t, size_t>;
+        std::priority_queue<cursor_t, std::vector<cursor_t>, std::greater<cursor_t>> heap{};
+        uint64_t value{};
+
+        for (size_t i = 0; i < readers.size(); ++i)
+            if (readers[i].next(value))
+                heap.emplace(value, i);
+
+        bool first{true};
+        uint64_t last{};
+
+        while (!heap.empty())
+        {
+            auto const [current, reader] = heap.top();
+            heap.pop();
+
+            if (first || current != last)
+            {
+                callback(current);
+                last = current;
+                first = false;
+            }
+
+            if (readers[reader].next(value))
+                heap.emplace(value, reader);
+        }
+    }
+
+private:
+    // More file runs are merged into one file.
+    static constexpr size_t max_file_runs{64u};
+
+    kmer_spill * spill{nullptr};
+    std::vector<std::vector<uint64_t>> memory_runs{};
+    std::vector<std::filesystem::path> file_runs{};
+    size_t memory_bytes{};
+
+    void clear();
+};
+
+} // namespace raptor::hibf
@@ -0,0 +1,114 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::hibf::task_pool and raptor::hibf::task_group.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace raptor::hibf
+{
+
+class task_group;
+
+/*!\brief A work-stealing thread pool for nested tasks.
+ * \details
+ * Each thread has its own queue. A thread runs the most recently added task of its own queue and otherwise steals
+ * the oldest task of another queue. Threads that wait for a raptor::hibf::task_group run other tasks in the meantime,
+ * hence tasks may create and wait for further tasks without blocking the pool. Threads without a task to run sleep
+ * until a task is added or, for waiting threads, until their group is done.
+ * A pool with `n` threads starts `n - 1` worker threads; the remaining thread is the one waiting for the tasks.
+ */
+class task_pool
+{
+public:
+    task_pool();
+    task_pool(task_pool const &) = delete;
+    task_pool & operator=(task_pool const &) = delete;
+    task_pool(task_pool &&) = delete;
+    task_pool & operator=(task_pool &&) = delete;
+    ~task_pool();
+
+    //!\brief Starts the worker threads. Without calling `start`, all tasks run in the waiting thread.
+    void start(size_t const threads);
+
+private:
+    friend task_group;
+
+    struct task
+    {
+        std::function<void()> function{};
+        task_group * group{nullptr};
+    };
+
+    struct queue
+    {
+        std::mutex mutex{};
+        std::deque<task> tasks{};
+    };
+
+    // Queue 0 is shared by all threads that are not part of the pool.
+    std::vector<std::unique_ptr<queue>> queues{};
+    std::vector<std::thread> workers{};
+    std::atomic<size_t> queued_tasks{};
+    std::atomic<bool> stop{false};
+    // Guards changes of `queued_tasks`, `stop`, and raptor::hibf::task_group::pending that sleeping threads wait for.
+    std::mutex sleep_mutex{};
+    std::condition_variable sleep_condition{};
+
+    void push(task && new_task);
+    //!\brief Runs one task. Returns `false` if there was no task.
+    bool run_one();
+    size_t queue_of_this_thread() const noexcept;
+};
+
+/*!\brief A set of tasks that can be waited for.
+ * \details The destructor waits for all tasks, such that tasks may capture local variables by reference.
+ */
+class task_group
+{
+public:
+    task_group(task_group const &) = delete;
+    task_group & operator=(task_group const &) = delete;
+    task_group(task_group &&) = delete;
+    task_group & operator=(task_group &&) = delete;
+    ~task_group();
+
+    explicit task_group(task_pool & pool) : pool{pool}
+    {}
+
+    void run(std::function<void()> function);
+
+    //!\brief Runs tasks until all tasks of this group are done. Rethrows the first exception thrown by a task.
+    void wait();
+
+private:
+    friend task_pool;
+
+    task_pool & pool;
+    std::atomic<size_t> pending{};
+    std::mutex exception_mutex{};
+    std::exception_ptr exception{};
+
+    //!\brief Runs tasks until all tasks of this group are done.
+    void help_until_done();
+    void finish(std::exception_ptr task_exception) noexcept;
+};
+
+} // namespace raptor::hibf
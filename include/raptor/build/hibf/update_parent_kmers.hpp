@@ -12,15 +12,16 @@
 
 #pragma once
 
-#include <robin_hood.h>
-
+#include <raptor/build/hibf/sorted_kmers.hpp>
 #include <raptor/argument_parsing/timer.hpp>
 
 namespace raptor::hibf
 {
 
-void update_parent_kmers(robin_hood::unordered_flat_set<size_t> & parent_kmers,
-                         robin_hood::unordered_flat_set<size_t> const & kmers,
-                         timer<concurrent::yes> & merge_kmers_timer);
+//!\brief Adds the sorted, duplicate-free k-mers as a run to the parent.
+void update_parent_kmers(kmer_runs & parent_kmers, std::vector<uint64_t> && kmers);
+
+//!\brief Merges the runs of a child and adds them as one run to the parent.
+void update_parent_kmers(kmer_runs & parent_kmers, kmer_runs && kmers, timer<concurrent::yes> & merge_kmers_timer);
 
 } // namespace raptor::hibf
@@ -18,9 +18,11 @@
 namespace raptor::hibf
 {
 
+//!\brief Stores the filenames of `record` as user bin `user_bin_idx` and marks its technical bins.
 template <seqan3::data_layout data_layout_mode>
 void update_user_bins(build_data<data_layout_mode> & data,
                       std::vector<int64_t> & filename_indices,
-                      chopper_pack_record const & record);
+                      chopper_pack_record const & record,
+                      size_t const user_bin_idx);
 
 } // namespace raptor::hibf
@@ -12,14 +12,18 @@
 
 #pragma once
 
+#include <span>
+
 #include <seqan3/search/views/minimiser_hash.hpp>
 
 #include <raptor/adjust_seed.hpp>
+#include <raptor/build/atomic_inserter.hpp>
 #include <raptor/build/emplace_iterator.hpp>
 #include <raptor/build/partition_config.hpp>
 #include <raptor/call_parallel_on_bins.hpp>
 #include <raptor/dna4_traits.hpp>
 #include <raptor/file_reader.hpp>
+#include <raptor/huge_pages.hpp>
 #include <raptor/index.hpp>
 
 namespace raptor
@@ -40,7 +44,9 @@ public:
         if (arguments->input_is_minimiser)
             reader = file_reader<file_types::minimiser>{};
         else
-            reader = file_reader<file_types::sequence>{arguments->shape, arguments->window_size};
+            reader = file_reader<file_types::sequence>{arguments->shape,
+                                                       arguments->window_size,
+                                                       arguments->minimiser_cache_dir};
     }
 
     explicit index_factory(build_arguments const & args, partition_config const & cfg) :
@@ -50,7 +56,9 @@ public:
         if (arguments->input_is_minimiser)
             reader = file_reader<file_types::minimiser>{}; // GCOVR_EXCL_LINE
         else
-            reader = file_reader<file_types::sequence>{arguments->shape, arguments->window_size};
+            reader = file_reader<file_types::sequence>{arguments->shape,
+                                                       arguments->window_size,
+                                                       arguments->minimiser_cache_dir};
     }
 
     [[nodiscard]] raptor_index<> operator()(size_t const part = 0u) const
@@ -69,8 +77,55 @@ private:
 
         arguments->index_allocation_timer.start();
         raptor_index<> index{*arguments};
+        advise_huge_pages(index.ibf());
         arguments->index_allocation_timer.stop();
 
+        // The hashes may have already been read while determining the bin size.
+        auto has_retained_hashes = [&](size_t const bin_number)
+        {
+            return bin_number < arguments->retained_hashes.size() && !arguments->retained_hashes[bin_number].empty();
+        };
+
+        // Big sequence files are read by all threads, one user bin after another. See raptor::large_user_bins.
+        std::vector<bool> is_large(arguments->bin_path.size());
+        if (!arguments->input_is_minimiser)
+            is_large = large_user_bins(arguments->bin_path, arguments->threads);
+
+        auto emplace_large_user_bin = [&](size_t const bin_number)
+        {
+            timer<concurrent::no> local_timer{};
+            // All threads emplace into the same bin. Its rows share words with the rows of neighbouring bins.
+            atomic_inserter inserter{index.ibf()};
+            local_timer.start();
+            std::visit(
+                [&](auto const & reader)
+                {
+                    reader.for_each_span(
+                        arguments->bin_path[bin_number],
+                        [&](std::span<uint64_t const> const hashes)
+                        {
+                            if (config == nullptr)
+                                std::ranges::copy(hashes, emplacer(inserter, seqan3::bin_index{bin_number}));
+                            else
+                                std::ranges::copy_if(hashes,
+                                                     emplacer(inserter, seqan3::bin_index{bin_number}),
+                                                     [&](uint64_t const hash)
+                                                     {
+                                                         return config->hash_partition(hash) == part;
+                                                     });
+                        },
+                        arguments->threads);
+                },
+                reader);
+            local_timer.stop();
+            arguments->user_bin_io_timer += local_timer;
+            arguments->fill_ibf_timer += local_timer;
+        };
+
+        for (size_t bin_number = 0; bin_number < is_large.size(); ++bin_number)
+            if (is_large[bin_number] && !has_retained_hashes(bin_number))
+                emplace_large_user_bin(bin_number);
+
         auto worker = [&](auto && zipped_view, auto &&)
         {
             timer<concurrent::no> local_timer{};
@@ -78,6 +133,25 @@ private:
             local_timer.start();
             for (auto && [file_names, bin_number] : zipped_view)
             {
+                if (is_large[bin_number] && !has_retained_hashes(bin_number))
+                    continue;
+
+                if (has_retained_hashes(bin_number))
+                {
+                    std::vector<uint64_t> & hashes = arguments->retained_hashes[bin_number];
+                    if (config == nullptr)
+                        std::ranges::copy(hashes, emplacer(ibf, seqan3::bin_index{bin_number}));
+                    else
+                        std::ranges::copy_if(hashes,
+                                             emplacer(ibf, seqan3::bin_index{bin_number}),
+                                             [&](uint64_t const hash)
+                                             {
+                                                 return config->hash_partition(hash) == part;
+                                             });
+                    hashes = std::vector<uint64_t>{};
+                    continue;
+                }
+
                 std::visit(
                     [&](auto const & reader)
                     {
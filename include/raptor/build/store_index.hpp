@@ -17,18 +17,43 @@
 #include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
 
 #include <raptor/index.hpp>
+#include <raptor/io/chunked_index_buffer.hpp>
+#include <raptor/io/hibf_offsets.hpp>
 #include <raptor/strong_types.hpp>
 
 namespace raptor
 {
 
+namespace detail
+{
+
+template <typename index_t>
+void write_index(index_t const & index,
+                 std::filesystem::path const & path,
+                 size_t const threads,
+                 size_t const chunk_size = chunked_index_output_buffer::default_chunk_size)
+{
+    chunked_index_output_buffer buffer{path, threads, chunk_size};
+    {
+        std::ostream os{std::addressof(buffer)};
+        cereal::BinaryOutputArchive oarchive{os};
+        oarchive(index);
+
+        // Allows loading the IBFs of an HIBF lazily.
+        if constexpr (index_structure::is_hibf<std::remove_cvref_t<decltype(index.ibf())>>)
+            hibf_offsets::compute(index).write(os);
+    }
+    buffer.close();
+}
+
+} // namespace detail
+
 // Compresion handled in chopper_build
 template <index_structure::is_hibf data_t, typename arguments_t>
-static inline void store_index(std::filesystem::path const & path, raptor_index<data_t> && index, arguments_t const &)
+static inline void
+store_index(std::filesystem::path const & path, raptor_index<data_t> && index, arguments_t const & arguments)
 {
-    std::ofstream os{path, std::ios::binary};
-    cereal::BinaryOutputArchive oarchive{os};
-    oarchive(index);
+    detail::write_index(index, path, arguments.threads);
 }
 
 template <index_structure::is_ibf data_t, typename arguments_t>
@@ -37,16 +62,12 @@ store_index(std::filesystem::path const & path, raptor_index<data_t> && index, a
 {
     if (!arguments.compressed)
     {
-        std::ofstream os{path, std::ios::binary};
-        cereal::BinaryOutputArchive oarchive{os};
-        oarchive(index);
+        detail::write_index(index, path, arguments.threads);
     }
     else
     {
         raptor_index<index_structure::ibf_compressed> compressed_index{std::move(index)};
-        std::ofstream os{path, std::ios::binary};
-        cereal::BinaryOutputArchive oarchive{os};
-        oarchive(compressed_index);
+        detail::write_index(compressed_index, path, arguments.threads);
     }
 }
 
@@ -63,9 +84,7 @@ static inline void store_index(std::filesystem::path const & path,
                                                                  arguments.fpr,
                                                                  std::move(ibf)};
 
-    std::ofstream os{path, std::ios::binary};
-    cereal::BinaryOutputArchive oarchive{os};
-    oarchive(index);
+    detail::write_index(index, path, arguments.threads);
 }
 
 } // namespace raptor
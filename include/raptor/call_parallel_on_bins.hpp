@@ -16,6 +16,8 @@
 #include <seqan3/utility/views/chunk.hpp>
 #include <seqan3/utility/views/zip.hpp>
 
+#include <raptor/io/record_chunks.hpp>
+
 namespace raptor
 {
 
@@ -32,4 +34,34 @@ void call_parallel_on_bins(algorithm_t && worker,
     executioner.bulk_execute(std::move(worker), std::move(chunked_view), []() {});
 }
 
+/*!\brief Returns for each user bin whether its splittable files are bigger than the share of one thread.
+ * \details
+ * Processing such a user bin on one thread would keep the thread busy while the others are idle. Splittable files
+ * can be read with multiple threads, see raptor::file_reader::for_each_span.
+ */
+inline std::vector<bool> large_user_bins(std::vector<std::vector<std::string>> const & bin_paths, size_t const threads)
+{
+    std::vector<bool> is_large(bin_paths.size());
+    if (threads <= 1u)
+        return is_large;
+
+    std::vector<size_t> splittable_sizes(bin_paths.size());
+    size_t total_size{};
+    for (size_t i = 0; i < bin_paths.size(); ++i)
+    {
+        for (auto && file_name : bin_paths[i])
+        {
+            size_t const file_size = std::filesystem::file_size(file_name);
+            total_size += file_size;
+            if (detail::is_splittable(file_name))
+                splittable_sizes[i] += file_size;
+        }
+    }
+
+    for (size_t i = 0; i < bin_paths.size(); ++i)
+        is_large[i] = splittable_sizes[i] * threads > total_size;
+
+    return is_large;
+}
+
 } // namespace raptor
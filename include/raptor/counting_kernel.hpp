@@ -0,0 +1,338 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::counting_kernel.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <ranges>
+#include <vector>
+
+#include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+//!\brief The seeds seqan3::interleaved_bloom_filter uses for its hash functions.
+inline constexpr std::array<uint64_t, 5> ibf_hash_seeds{13572355802537770549ULL,
+                                                        13043817825332782213ULL,
+                                                        10650232656628343401ULL,
+                                                        16499269484942379435ULL,
+                                                        4893150838803335377ULL};
+
+//!\brief The position of a value's row, i.e., its bits in all bins, for one hash function. In 64 bit words.
+inline uint64_t ibf_row(uint64_t value,
+                        uint64_t const seed,
+                        uint64_t const bin_size,
+                        int const hash_shift,
+                        uint64_t const bin_words) noexcept
+{
+    value *= seed;
+    value ^= value >> hash_shift;
+    value *= 11400714819323198485ULL;
+#ifdef __SIZEOF_INT128__
+    value = static_cast<uint64_t>((static_cast<__uint128_t>(value) * static_cast<__uint128_t>(bin_size)) >> 64);
+#else
+    value %= bin_size;
+#endif
+    return value * bin_words;
+}
+
+} // namespace detail
+
+/*!\brief Counts the occurrences of values in each bin of an uncompressed seqan3::interleaved_bloom_filter.
+ * \tparam hash_count_ The number of hash functions. `0` if it is only known at runtime.
+ * \tparam bin_words_ The number of 64 bit words per row, i.e., `⌈bins / 64⌉`. `0` if it is only known at runtime.
+ * \tparam prefetch_distance_ The rows of a value are prefetched this many values ahead. `0` disables prefetching.
+ * \details
+ * Gives the same result as the counting agent of the IBF. If the number of hash functions and words are known at
+ * compile time, the loops over them are unrolled and vectorised.
+ *
+ * The rows of a value are at random positions of a large bit vector and usually not cached. Instead of waiting for
+ * each row when it is needed, the row addresses of the next `prefetch_distance_` values are computed in advance and
+ * prefetched, so that the memory accesses of several values overlap.
+ * The IBF's hash functions are an implementation detail of SeqAn. Use raptor::with_counting_kernel, which checks
+ * that they match before choosing a counting_kernel.
+ */
+template <size_t hash_count_ = 0u, size_t bin_words_ = 0u, size_t prefetch_distance_ = 8u>
+class counting_kernel
+{
+private:
+    static constexpr size_t max_hash_count{detail::ibf_hash_seeds.size()};
+
+    //!\brief The rows of one value.
+    using rows_t = std::array<uint64_t const *, max_hash_count>;
+
+    uint64_t const * data{nullptr};
+    uint64_t bin_size{};
+    int hash_shift{};
+    size_t hash_count{};
+    size_t bin_words{};
+
+    //!\brief The AND of the rows of the current value.
+    std::conditional_t<bin_words_ == 0u, std::vector<uint64_t>, std::array<uint64_t, bin_words_>> hits{};
+
+public:
+    counting_kernel() = default;
+    counting_kernel(counting_kernel const &) = default;
+    counting_kernel & operator=(counting_kernel const &) = default;
+    counting_kernel(counting_kernel &&) = default;
+    counting_kernel & operator=(counting_kernel &&) = default;
+    ~counting_kernel() = default;
+
+    explicit counting_kernel(seqan3::interleaved_bloom_filter<seqan3::data_layout::uncompressed> const & ibf) :
+        data{ibf.raw_data().data()},
+        bin_size{ibf.bin_size()},
+        hash_shift{std::countl_zero(bin_size)},
+        hash_count{hash_count_ == 0u ? ibf.hash_function_count() : hash_count_},
+        bin_words{bin_words_ == 0u ? (ibf.bin_count() + 63u) / 64u : bin_words_},
+        result_buffer(ibf.bin_count(), 0u)
+    {
+        assert(hash_count == ibf.hash_function_count());
+        assert(bin_words == (ibf.bin_count() + 63u) / 64u);
+        assert(hash_count <= max_hash_count);
+
+        if constexpr (bin_words_ == 0u)
+            hits.resize(bin_words);
+    }
+
+    //!\brief Stores the result of bulk_count().
+    seqan3::counting_vector<uint16_t> result_buffer;
+
+    //!\brief Counts the occurrences of the values in each bin.
+    template <std::ranges::forward_range value_range_t>
+    [[nodiscard]] seqan3::counting_vector<uint16_t> const & bulk_count(value_range_t && values) & noexcept
+    {
+        assert(data != nullptr);
+        std::ranges::fill(result_buffer, 0u);
+
+        if constexpr (prefetch_distance_ == 0u)
+        {
+            for (uint64_t const value : values)
+                count(compute_rows(value));
+        }
+        else
+        {
+            // pending[i % prefetch_distance_] holds the rows of the i-th value.
+            std::array<rows_t, prefetch_distance_> pending;
+            auto ahead = std::ranges::begin(values);
+            auto const end = std::ranges::end(values);
+
+            size_t in_flight{};
+            for (; in_flight < prefetch_distance_ && ahead != end; ++in_flight, ++ahead)
+                pending[in_flight] = prefetch(compute_rows(*ahead));
+
+            size_t i{};
+            for (; ahead != end; ++i, ++ahead)
+            {
+                rows_t & slot = pending[i % prefetch_distance_];
+                count(slot);
+                slot = prefetch(compute_rows(*ahead));
+            }
+
+            for (size_t const last = i + in_flight; i < last; ++i)
+                count(pending[i % prefetch_distance_]);
+        }
+
+        return result_buffer;
+    }
+
+    template <std::ranges::range value_range_t>
+    [[nodiscard]] seqan3::counting_vector<uint16_t> const & bulk_count(value_range_t && values) && noexcept = delete;
+
+private:
+    size_t get_hash_count() const noexcept
+    {
+        if constexpr (hash_count_ != 0u)
+            return hash_count_;
+        else
+            return hash_count;
+    }
+
+    size_t get_bin_words() const noexcept
+    {
+        if constexpr (bin_words_ != 0u)
+            return bin_words_;
+        else
+            return bin_words;
+    }
+
+    rows_t compute_rows(uint64_t const value) const noexcept
+    {
+        size_t const number_of_words = get_bin_words();
+        rows_t rows;
+        for (size_t h = 0; h < get_hash_count(); ++h)
+            rows[h] = data + detail::ibf_row(value, detail::ibf_hash_seeds[h], bin_size, hash_shift, number_of_words);
+        return rows;
+    }
+
+    rows_t const & prefetch(rows_t const & rows) const noexcept
+    {
+        for (size_t h = 0; h < get_hash_count(); ++h)
+            for (size_t word = 0; word < get_bin_words(); word += 8u) // 8 words per 64 byte cache line
+                __builtin_prefetch(rows[h] + word);
+        return rows;
+    }
+
+    void count(rows_t const & rows) noexcept
+    {
+        size_t const number_of_hashes = get_hash_count();
+        size_t const number_of_words = get_bin_words();
+
+#pragma omp simd
+        for (size_t word = 0; word < number_of_words; ++word)
+            hits[word] = rows[0][word];
+
+        for (size_t h = 1; h < number_of_hashes; ++h)
+        {
+            uint64_t const * const row = rows[h];
+#pragma omp simd
+            for (size_t word = 0; word < number_of_words; ++word)
+                hits[word] &= row[word];
+        }
+
+        for (size_t word = 0; word < number_of_words; ++word)
+        {
+            size_t const offset = word * 64u;
+            for (uint64_t bits = hits[word]; bits != 0u; bits &= bits - 1u)
+                ++result_buffer[offset + std::countr_zero(bits)];
+        }
+    }
+};
+
+namespace detail
+{
+
+/*!\brief Checks whether raptor::counting_kernel computes the same rows as seqan3::interleaved_bloom_filter.
+ * \details Inserts values into small IBFs and compares the results of both. The result is computed once.
+ */
+inline bool counting_kernel_is_compatible()
+{
+    static bool const is_compatible = []()
+    {
+        for (size_t const bins : {64u, 130u})
+        {
+            seqan3::interleaved_bloom_filter<> ibf{seqan3::bin_count{bins},
+                                                  seqan3::bin_size{1031u},
+                                                  seqan3::hash_function_count{ibf_hash_seeds.size()}};
+            for (uint64_t value = 0; value < 256u; ++value)
+                ibf.emplace(value * 0x9E3779B97F4A7C15ULL, seqan3::bin_index{value % bins});
+
+            auto agent = ibf.counting_agent<uint16_t>();
+            counting_kernel<> kernel{ibf};
+            for (uint64_t value = 0; value < 512u; ++value)
+            {
+                std::array<uint64_t, 1> const query{value * 0x9E3779B97F4A7C15ULL};
+                auto const & expected = agent.bulk_count(query);
+                if (!std::ranges::equal(kernel.bulk_count(query), expected))
+                    return false;
+            }
+        }
+        return true;
+    }();
+
+    return is_compatible;
+}
+
+template <size_t hash_count, size_t bin_words, typename fn_t>
+void call_with_counting_kernel(seqan3::interleaved_bloom_filter<> const & ibf, fn_t && fn)
+{
+    fn(
+        [&ibf]()
+        {
+            return counting_kernel<hash_count, bin_words>{ibf};
+        });
+}
+
+template <size_t hash_count, typename fn_t>
+void call_with_counting_kernel(seqan3::interleaved_bloom_filter<> const & ibf, fn_t && fn)
+{
+    switch ((ibf.bin_count() + 63u) / 64u)
+    {
+    case 1u: // 64 bins
+        return call_with_counting_kernel<hash_count, 1u>(ibf, fn);
+    case 16u: // 1024 bins
+        return call_with_counting_kernel<hash_count, 16u>(ibf, fn);
+    case 128u: // 8192 bins
+        return call_with_counting_kernel<hash_count, 128u>(ibf, fn);
+    default:
+        return call_with_counting_kernel<hash_count, 0u>(ibf, fn);
+    }
+}
+
+} // namespace detail
+
+/*!\brief Counts the occurrences of `values` in each bin of `ibf` and calls `fn` with the result.
+ * \details
+ * Uses a raptor::counting_kernel if possible, i.e., for an uncompressed IBF and `uint16_t` counts. Otherwise, the IBF's
+ * own counting agent is used. In contrast to raptor::with_counting_kernel, the kernel is not specialised on the
+ * geometry of the IBF. This is meant for counting in many different IBFs, e.g., of an HIBF.
+ */
+template <std::integral value_t = uint16_t,
+          seqan3::data_layout data_layout_mode,
+          std::ranges::forward_range value_range_t,
+          typename fn_t>
+void with_counts(seqan3::interleaved_bloom_filter<data_layout_mode> const & ibf, value_range_t && values, fn_t && fn)
+{
+    if constexpr (data_layout_mode == seqan3::data_layout::uncompressed && std::same_as<value_t, uint16_t>)
+    {
+        if (detail::counting_kernel_is_compatible())
+        {
+            counting_kernel<> kernel{ibf};
+            return fn(kernel.bulk_count(values));
+        }
+    }
+
+    auto agent = ibf.template counting_agent<value_t>();
+    fn(agent.bulk_count(values));
+}
+
+/*!\brief Calls `fn` with a function that creates the fastest counting agent for the IBF.
+ * \details
+ * The created agent has a `bulk_count(values)` member that returns a seqan3::counting_vector<uint16_t>.
+ * For an uncompressed IBF, this is a raptor::counting_kernel specialised for 2 or 3 hash functions and 64, 1024, or
+ * 8192 bins if possible. Otherwise, it is the IBF's own counting agent.
+ */
+template <seqan3::data_layout data_layout_mode, typename fn_t>
+void with_counting_kernel(seqan3::interleaved_bloom_filter<data_layout_mode> const & ibf, fn_t && fn)
+{
+    if constexpr (data_layout_mode == seqan3::data_layout::uncompressed)
+    {
+        if (detail::counting_kernel_is_compatible())
+        {
+            switch (ibf.hash_function_count())
+            {
+            case 2u:
+                return detail::call_with_counting_kernel<2u>(ibf, fn);
+            case 3u:
+                return detail::call_with_counting_kernel<3u>(ibf, fn);
+            default:
+                return detail::call_with_counting_kernel<0u, 0u>(ibf, fn);
+            }
+        }
+    }
+
+    fn(
+        [&ibf]()
+        {
+            return ibf.template counting_agent<uint16_t>();
+        });
+}
+
+} // namespace raptor
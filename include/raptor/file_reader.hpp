@@ -12,11 +12,19 @@
 
 #pragma once
 
+#include <optional>
+#include <span>
+
 #include <seqan3/io/sequence_file/input.hpp>
 #include <seqan3/search/views/minimiser_hash.hpp>
 
 #include <raptor/adjust_seed.hpp>
 #include <raptor/dna4_traits.hpp>
+#include <raptor/io/mapped_file.hpp>
+#include <raptor/io/minimiser_file.hpp>
+#include <raptor/io/record_chunks.hpp>
+#include <raptor/minimiser_cache.hpp>
+#include <raptor/search/do_parallel.hpp>
 
 namespace raptor
 {
@@ -42,11 +50,24 @@ public:
     file_reader & operator=(file_reader &&) = default;
     ~file_reader() = default;
 
-    explicit file_reader(seqan3::shape const shape, uint32_t const window_size) :
+    /*!\brief Constructs a file reader for the given k-mer parameters.
+     * \details If a cache directory is given, raptor::file_reader::hash_into, raptor::file_reader::hash_into_if, and
+     *          raptor::file_reader::for_each_span read the distinct minimisers of each file from a
+     *          raptor::minimiser_cache, or store them while reading the file. Since the cache stores distinct
+     *          minimisers, these functions may report each minimiser only once per file. This does not change the
+     *          result of inserting the minimisers into an IBF or a set. raptor::file_reader::on_hash and
+     *          raptor::file_reader::for_each_hash always read the file, since their callers count minimisers.
+     */
+    explicit file_reader(seqan3::shape const shape,
+                         uint32_t const window_size,
+                         std::filesystem::path const & cache_directory = {}) :
         minimiser_view{seqan3::views::minimiser_hash(shape,
                                                      seqan3::window_size{window_size},
                                                      seqan3::seed{adjust_seed(shape.count())})}
-    {}
+    {
+        if (!cache_directory.empty())
+            cache = minimiser_cache{cache_directory, shape, window_size};
+    }
 
     template <std::output_iterator<uint64_t> it_t>
     void hash_into(std::vector<std::string> const & filenames, it_t target) const
@@ -58,6 +79,16 @@ public:
     template <std::output_iterator<uint64_t> it_t>
     void hash_into(std::string const & filename, it_t target) const
     {
+        if (cache)
+        {
+            for_each_span(filename,
+                          [&target](std::span<uint64_t const> const values)
+                          {
+                              target = std::ranges::copy(values, target).out;
+                          });
+            return;
+        }
+
         sequence_file_t fin{filename};
         for (auto && record : fin)
             std::ranges::copy(record.sequence() | minimiser_view, target);
@@ -73,6 +104,16 @@ public:
     template <std::output_iterator<uint64_t> it_t>
     void hash_into_if(std::string const & filename, it_t target, auto && pred) const
     {
+        if (cache)
+        {
+            for_each_span(filename,
+                          [&target, &pred](std::span<uint64_t const> const values)
+                          {
+                              target = std::ranges::copy_if(values, target, pred).out;
+                          });
+            return;
+        }
+
         sequence_file_t fin{filename};
         for (auto && record : fin)
             std::ranges::copy_if(record.sequence() | minimiser_view, target, pred);
@@ -84,6 +125,7 @@ public:
             on_hash(filename, callback);
     }
 
+    //!\brief Calls the callback with the minimisers of each record. Does not use the cache.
     void on_hash(std::string const & filename, auto && callback) const
     {
         sequence_file_t fin{filename};
@@ -97,6 +139,7 @@ public:
             for_each_hash(filename, callback);
     }
 
+    //!\brief Calls the callback with each minimiser, including duplicates. Does not use the cache.
     void for_each_hash(std::string const & filename, auto && callback) const
     {
         sequence_file_t fin{filename};
@@ -104,10 +147,108 @@ public:
             std::ranges::for_each(record.sequence() | minimiser_view, callback);
     }
 
+    /*!\brief Calls `callback` with spans (`std::span<uint64_t const>`) of the minimisers of the files.
+     * \details
+     * With more than one thread, big uncompressed FASTA and FASTQ files (raptor::detail::is_splittable) are split into
+     * record-aligned chunks that are processed in parallel. The callback is then called concurrently and must
+     * synchronise itself.
+     * With a cache, the spans of a cached file are read sequentially. Otherwise, the file is read as without a cache
+     * and its entry is built on the side.
+     */
+    void for_each_span(std::vector<std::string> const & filenames, auto && callback, size_t const threads = 1u) const
+    {
+        for (auto && filename : filenames)
+            for_each_span(filename, callback, threads);
+    }
+
+    void for_each_span(std::string const & filename, auto && callback, size_t const threads = 1u) const
+    {
+        if (!cache)
+            return read_spans(filename, callback, threads);
+
+        if (cache->for_each_span(filename, callback))
+            return;
+
+        minimiser_cache::writer writer{*cache, filename};
+        read_spans(filename,
+                   [&](std::span<uint64_t const> const values)
+                   {
+                       callback(values);
+                       writer.insert(values);
+                   },
+                   threads);
+        writer.commit();
+    }
+
 private:
     using sequence_file_t = seqan3::sequence_file_input<dna4_traits, seqan3::fields<seqan3::field::seq>>;
     using view_t = decltype(seqan3::views::minimiser_hash(seqan3::shape{}, seqan3::window_size{}, seqan3::seed{}));
     view_t minimiser_view = seqan3::views::minimiser_hash(seqan3::shape{}, seqan3::window_size{}, seqan3::seed{});
+    std::optional<minimiser_cache> cache{};
+
+    // 512 KiB
+    static constexpr size_t batch_size{1ULL << 16};
+
+    //!\brief raptor::file_reader::for_each_span without the cache.
+    void read_spans(std::string const & filename, auto && callback, size_t const threads) const
+    {
+        if (threads <= 1u || !detail::is_splittable(filename))
+        {
+            sequence_file_t fin{filename};
+            for_each_batch(fin, callback);
+            return;
+        }
+
+        detail::mapped_file const file{filename};
+        std::string_view const data{file.data(), file.size()};
+        std::vector<std::string_view> const chunks = detail::split_records(data, data.size() / detail::min_chunk_size);
+        detail::record_format const format = detail::detect_record_format(data);
+
+        auto worker = [&](size_t const start, size_t const end)
+        {
+            for (size_t i = start; i < end; ++i)
+            {
+                detail::memory_streambuf buffer{chunks[i]};
+                std::istream stream{&buffer};
+
+                if (format == detail::record_format::fastq)
+                {
+                    sequence_file_t fin{stream, seqan3::format_fastq{}};
+                    for_each_batch(fin, callback);
+                }
+                else
+                {
+                    sequence_file_t fin{stream, seqan3::format_fasta{}};
+                    for_each_batch(fin, callback);
+                }
+            }
+        };
+
+        do_parallel(worker, chunks.size(), std::min(threads, chunks.size()));
+    }
+
+    //!\brief Calls `callback` with batches of raptor::file_reader::batch_size minimisers.
+    void for_each_batch(sequence_file_t & fin, auto && callback) const
+    {
+        std::vector<uint64_t> batch{};
+        batch.reserve(batch_size);
+
+        for (auto && record : fin)
+        {
+            for (uint64_t const hash : record.sequence() | minimiser_view)
+            {
+                batch.push_back(hash);
+                if (batch.size() == batch_size)
+                {
+                    callback(std::span<uint64_t const>{batch});
+                    batch.clear();
+                }
+            }
+        }
+
+        if (!batch.empty())
+            callback(std::span<uint64_t const>{batch});
+    }
 };
 
 template <>
@@ -121,7 +262,7 @@ public:
     file_reader & operator=(file_reader &&) = default;
     ~file_reader() = default;
 
-    explicit file_reader(seqan3::shape const, uint32_t const)
+    explicit file_reader(seqan3::shape const, uint32_t const, std::filesystem::path const & = {})
     {}
 
     template <std::output_iterator<uint64_t> it_t>
@@ -134,13 +275,11 @@ public:
     template <std::output_iterator<uint64_t> it_t>
     void hash_into(std::string const & filename, it_t target) const
     {
-        std::ifstream fin{filename, std::ios::binary};
-        uint64_t value;
-        while (fin.read(reinterpret_cast<char *>(&value), sizeof(value)))
-        {
-            *target = value;
-            ++target;
-        }
+        for_each_span(filename,
+                      [&target](std::span<uint64_t const> const values)
+                      {
+                          target = std::ranges::copy(values, target).out;
+                      });
     }
 
     template <std::output_iterator<uint64_t> it_t>
@@ -153,14 +292,11 @@ public:
     template <std::output_iterator<uint64_t> it_t>
     void hash_into_if(std::string const & filename, it_t target, auto && pred) const
     {
-        std::ifstream fin{filename, std::ios::binary};
-        uint64_t value;
-        while (fin.read(reinterpret_cast<char *>(&value), sizeof(value)))
-            if (pred(value))
-            {
-                *target = value;
-                ++target;
-            }
+        for_each_span(filename,
+                      [&target, &pred](std::span<uint64_t const> const values)
+                      {
+                          target = std::ranges::copy_if(values, target, pred).out;
+                      });
     }
 
     void for_each_hash(std::vector<std::string> const & filenames, auto && callback) const
@@ -171,10 +307,24 @@ public:
 
     void for_each_hash(std::string const & filename, auto && callback) const
     {
-        std::ifstream fin{filename, std::ios::binary};
-        uint64_t value;
-        while (fin.read(reinterpret_cast<char *>(&value), sizeof(value)))
-            callback(value);
+        minimiser_file_reader const reader{filename};
+        reader.for_each(callback);
+    }
+
+    /*!\brief Calls `callback` with spans (`std::span<uint64_t const>`) of the minimisers of the files.
+     * \details Minimiser files are read sequentially. `threads` only exists for compatibility with
+     *          raptor::file_reader<file_types::sequence>.
+     */
+    void for_each_span(std::vector<std::string> const & filenames, auto && callback, size_t const = 1u) const
+    {
+        for (auto && filename : filenames)
+            for_each_span(filename, callback);
+    }
+
+    void for_each_span(std::string const & filename, auto && callback, size_t const = 1u) const
+    {
+        minimiser_file_reader const reader{filename};
+        reader.for_each_span(callback);
     }
 };
 
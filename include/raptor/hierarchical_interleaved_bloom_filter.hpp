@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <memory>
 #include <ranges>
+#include <stdexcept>
 
 #include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
 
+#include <raptor/counting_kernel.hpp>
+#include <raptor/lazy_ibf_loader.hpp>
+
 #ifndef RAPTOR_HIBF_HAS_COUNT
 #    define RAPTOR_HIBF_HAS_COUNT 0
 #endif
@@ -75,6 +80,11 @@ namespace raptor
  * raptor::hierarchical_interleaved_bloom_filter::counting_agent() and use
  * the returned raptor::hierarchical_interleaved_bloom_filter::counting_agent_type.
  *
+ * ## Hybrid layout
+ * In a compressed HIBF, some IBFs may be kept uncompressed, see
+ * raptor::hierarchical_interleaved_bloom_filter::uncompressed_ibfs. This is useful for the upper levels, which are
+ * accessed by most queries.
+ *
  * ## Thread safety
  *
  * The Interleaved Bloom Filter promises the basic thread-safety by the STL that all
@@ -105,6 +115,9 @@ public:
     //!\brief The type of an individual Bloom filter.
     using ibf_t = seqan3::interleaved_bloom_filter<data_layout_mode_>;
 
+    //!\brief The type of an IBF that is kept uncompressed in a compressed HIBF.
+    using uncompressed_ibf_t = seqan3::interleaved_bloom_filter<seqan3::data_layout::uncompressed>;
+
     /*!\name Constructors, destructor and assignment
      * \{
      */
@@ -119,9 +132,70 @@ public:
 
     //!\}
 
-    //!\brief The individual interleaved Bloom filters.
+    //!\brief The individual interleaved Bloom filters. Empty if the IBFs are loaded lazily.
     std::vector<ibf_t> ibf_vector;
 
+    //!\brief Loads the IBFs on first access instead. Set by raptor::detail::load_index_lazily.
+    std::shared_ptr<lazy_ibf_loader<ibf_t>> lazy_ibfs{};
+
+    /*!\brief IBFs of a compressed HIBF that are kept uncompressed, by IBF ID.
+     * \details
+     * If `uncompressed_ibfs[i]` has bins, it replaces `ibf_vector[i]`, which is then empty. The vector may be shorter
+     * than ibf_vector and is always empty for an uncompressed HIBF. It is loaded with the bookkeeping, i.e., it is
+     * always loaded completely.
+     */
+    std::vector<uncompressed_ibf_t> uncompressed_ibfs{};
+
+    //!\brief Whether the IBF with the given ID is kept uncompressed in a compressed HIBF.
+    bool is_uncompressed(size_t const ibf_idx) const noexcept
+    {
+        return ibf_idx < uncompressed_ibfs.size() && uncompressed_ibfs[ibf_idx].bin_count() != 0u;
+    }
+
+    /*!\brief Stores a newly built IBF.
+     * \details A compressed HIBF compresses the IBF, unless `keep_uncompressed` is `true`.
+     *          uncompressed_ibfs must already have an element for the ID if `keep_uncompressed` is `true`.
+     */
+    void store_ibf(size_t const ibf_idx, uncompressed_ibf_t && ibf, bool const keep_uncompressed = false)
+    {
+        if constexpr (data_layout_mode == seqan3::data_layout::compressed)
+        {
+            if (keep_uncompressed)
+            {
+                assert(ibf_idx < uncompressed_ibfs.size());
+                uncompressed_ibfs[ibf_idx] = std::move(ibf);
+                return;
+            }
+        }
+        ibf_vector[ibf_idx] = std::move(ibf);
+    }
+
+    /*!\brief Calls `fn` with the IBF with the given ID, which may be uncompressed in a compressed HIBF.
+     * \details Prefer this over ibf(), which only returns IBFs of the HIBF's data layout.
+     */
+    template <typename fn_t>
+    decltype(auto) with_ibf(size_t const ibf_idx, fn_t && fn) const
+    {
+        if constexpr (data_layout_mode == seqan3::data_layout::compressed)
+        {
+            if (is_uncompressed(ibf_idx))
+                return fn(uncompressed_ibfs[ibf_idx]);
+        }
+        auto const ibf_ptr = ibf(ibf_idx); // Keeps a lazily loaded IBF loaded while `fn` runs.
+        return fn(*ibf_ptr);
+    }
+
+    /*!\brief Returns the IBF with the given ID. Use this instead of ibf_vector if the IBFs may be loaded lazily.
+     * \details Lazily loaded IBFs may be evicted. Keep the returned pointer while using the IBF.
+     */
+    typename lazy_ibf_loader<ibf_t>::ibf_pointer ibf(size_t const ibf_idx) const
+    {
+        if (lazy_ibfs)
+            return (*lazy_ibfs)[ibf_idx];
+        // Does not own the IBF.
+        return {std::shared_ptr<ibf_t const>{}, std::addressof(ibf_vector[ibf_idx])};
+    }
+
     /*!\brief Stores for each bin in each IBF of the HIBF the ID of the next IBF.
      * \details
      * Assume we look up a bin `b` in IBF `i`, i.e. `next_ibf_id[i][b]`.
@@ -134,6 +208,64 @@ public:
     //!\brief The underlying user bins.
     user_bins user_bins;
 
+    /*!\brief Consecutive technical bins of an IBF that belong to the same user bin or merged bin.
+     * \details
+     * A split bin is a single run. For a merged bin, `target` is the ID of the lower-level IBF and has the
+     * `merged_flag` set. Otherwise, `target` is the index of the user bin.
+     */
+    struct bin_run
+    {
+        static constexpr uint32_t merged_flag{1u << 31};
+
+        uint32_t end{};    //!< One past the last technical bin of the run.
+        uint32_t target{}; //!< The user bin index, or the ID of the lower-level IBF combined with `merged_flag`.
+    };
+
+    /*!\brief The runs of all IBFs, used for querying. Computed from next_ibf_id and user_bins by update_bin_runs().
+     * \details The runs of IBF `i` are `bin_runs[bin_run_offsets[i]]` up to `bin_runs[bin_run_offsets[i + 1]]`.
+     */
+    std::vector<uint32_t> bin_run_offsets{};
+    //!\copydoc bin_run_offsets
+    std::vector<bin_run> bin_runs{};
+
+    /*!\brief Recomputes bin_runs from next_ibf_id and user_bins.
+     * \details Must be called after next_ibf_id or user_bins have been changed. Called when loading an HIBF.
+     */
+    void update_bin_runs()
+    {
+        auto checked = [](int64_t const value)
+        {
+            if (value < 0 || static_cast<uint64_t>(value) >= bin_run::merged_flag)
+                throw std::length_error{"The HIBF has too many IBFs or user bins."};
+            return static_cast<uint32_t>(value);
+        };
+
+        bin_run_offsets.assign(1u, 0u);
+        bin_runs.clear();
+
+        for (size_t ibf_idx = 0; ibf_idx < next_ibf_id.size(); ++ibf_idx)
+        {
+            size_t const number_of_bins = next_ibf_id[ibf_idx].size();
+
+            for (size_t bin = 0; bin < number_of_bins; ++bin)
+            {
+                int64_t const filename_index = user_bins.filename_index(ibf_idx, bin);
+                bool const is_merged = filename_index < 0;
+                uint32_t const target =
+                    is_merged ? checked(next_ibf_id[ibf_idx][bin]) | bin_run::merged_flag : checked(filename_index);
+                bool const continues_split_bin =
+                    !is_merged && bin_runs.size() > bin_run_offsets.back() && bin_runs.back().target == target;
+
+                if (continues_split_bin)
+                    bin_runs.back().end = checked(bin + 1u);
+                else
+                    bin_runs.push_back(bin_run{.end = checked(bin + 1u), .target = target});
+            }
+
+            bin_run_offsets.push_back(checked(bin_runs.size()));
+        }
+    }
+
     //!\brief Returns a membership_agent to be used for counting.
     membership_agent membership_agent() const
     {
@@ -163,8 +295,29 @@ public:
     void CEREAL_SERIALIZE_FUNCTION_NAME(archive_t & archive)
     {
         archive(ibf_vector);
+        serialize_bookkeeping(archive);
+    }
+
+    /*!\brief Serialises everything but ibf_vector, i.e., the data that is serialised after the IBFs.
+     * \tparam archive_t Type of `archive`; must satisfy seqan3::cereal_archive.
+     * \param[in] archive The archive being serialised from/to. Must be positioned after the IBFs.
+     * \param[in] with_uncompressed_ibfs Whether uncompressed_ibfs is serialised. Indices of version 2 do not store it.
+     */
+    template <seqan3::cereal_archive archive_t>
+    void serialize_bookkeeping(archive_t & archive, bool const with_uncompressed_ibfs = true)
+    {
         archive(next_ibf_id);
         archive(user_bins);
+
+        if constexpr (data_layout_mode == seqan3::data_layout::compressed)
+        {
+            if (with_uncompressed_ibfs)
+                archive(uncompressed_ibfs);
+        }
+
+        // The runs are not stored.
+        if constexpr (seqan3::cereal_input_archive<archive_t>)
+            update_bin_runs();
     }
     //!\endcond
 };
@@ -320,30 +473,42 @@ private:
     template <std::ranges::forward_range value_range_t>
     void bulk_contains_impl(value_range_t && values, int64_t const ibf_idx, size_t const threshold)
     {
-        auto agent = hibf_ptr->ibf_vector[ibf_idx].template counting_agent<uint16_t>();
-        auto & result = agent.bulk_count(values);
+        auto descend = [&](seqan3::counting_vector<uint16_t> const & result)
+        {
+            bulk_contains_impl(values, result, ibf_idx, threshold);
+        };
+
+        hibf_ptr->with_ibf(ibf_idx,
+                           [&](auto const & ibf)
+                           {
+                               with_counts(ibf, values, descend);
+                           });
+    }
 
-        uint16_t sum{};
+    //!\brief Descends into the merged bins of the IBF with ID `ibf_idx` whose counts reach the threshold.
+    template <std::ranges::forward_range value_range_t>
+    void bulk_contains_impl(value_range_t && values,
+                            seqan3::counting_vector<uint16_t> const & result,
+                            int64_t const ibf_idx,
+                            size_t const threshold)
+    {
+        bin_run const * run = hibf_ptr->bin_runs.data() + hibf_ptr->bin_run_offsets[ibf_idx];
+        bin_run const * const runs_end = hibf_ptr->bin_runs.data() + hibf_ptr->bin_run_offsets[ibf_idx + 1];
+        size_t bin{};
 
-        for (size_t bin{}; bin < result.size(); ++bin)
+        for (; run != runs_end; ++run)
         {
-            sum += result[bin];
+            uint16_t sum{};
+            for (; bin < run->end; ++bin)
+                sum += result[bin];
 
-            auto const current_filename_index = hibf_ptr->user_bins.filename_index(ibf_idx, bin);
+            if (sum < threshold)
+                continue;
 
-            if (current_filename_index < 0) // merged bin
-            {
-                if (sum >= threshold)
-                    bulk_contains_impl(values, hibf_ptr->next_ibf_id[ibf_idx][bin], threshold);
-                sum = 0u;
-            }
-            else if (bin + 1u == result.size() ||                                                    // last bin
-                     current_filename_index != hibf_ptr->user_bins.filename_index(ibf_idx, bin + 1)) // end of split bin
-            {
-                if (sum >= threshold)
-                    result_buffer.emplace_back(current_filename_index);
-                sum = 0u;
-            }
+            if (run->target & bin_run::merged_flag)
+                bulk_contains_impl(values, run->target & ~bin_run::merged_flag, threshold);
+            else
+                result_buffer.emplace_back(run->target);
         }
     }
 
@@ -363,7 +528,9 @@ public:
      * \param hibf The hierarchical_interleaved_bloom_filter.
      */
     explicit membership_agent(hibf_t const & hibf) : hibf_ptr(std::addressof(hibf))
-    {}
+    {
+        assert(hibf.bin_run_offsets.size() == hibf.next_ibf_id.size() + 1u); // update_bin_runs() was called
+    }
     //!\}
 
     //!\brief Stores the result of bulk_contains().
@@ -430,29 +597,42 @@ private:
     template <std::ranges::forward_range value_range_t>
     void bulk_count_impl(value_range_t && values, int64_t const ibf_idx, size_t const threshold)
     {
-        auto agent = hibf_ptr->ibf_vector[ibf_idx].template counting_agent<value_t>();
-        auto & result = agent.bulk_count(values);
+        auto descend = [&](seqan3::counting_vector<value_t> const & result)
+        {
+            bulk_count_impl(values, result, ibf_idx, threshold);
+        };
+
+        hibf_ptr->with_ibf(ibf_idx,
+                           [&](auto const & ibf)
+                           {
+                               with_counts<value_t>(ibf, values, descend);
+                           });
+    }
 
-        value_t sum{};
+    //!\brief Descends into the merged bins of the IBF with ID `ibf_idx` whose counts reach the threshold.
+    template <std::ranges::forward_range value_range_t>
+    void bulk_count_impl(value_range_t && values,
+                         seqan3::counting_vector<value_t> const & result,
+                         int64_t const ibf_idx,
+                         size_t const threshold)
+    {
+        bin_run const * run = hibf_ptr->bin_runs.data() + hibf_ptr->bin_run_offsets[ibf_idx];
+        bin_run const * const runs_end = hibf_ptr->bin_runs.data() + hibf_ptr->bin_run_offsets[ibf_idx + 1];
+        size_t bin{};
 
-        for (size_t bin{}; bin < result.size(); ++bin)
+        for (; run != runs_end; ++run)
         {
-            sum += result[bin];
-            auto const current_filename_index = hibf_ptr->user_bins.filename_index(ibf_idx, bin);
+            value_t sum{};
+            for (; bin < run->end; ++bin)
+                sum += result[bin];
 
-            if (current_filename_index < 0) // merged bin
-            {
-                if (sum >= threshold)
-                    bulk_count_impl(values, hibf_ptr->next_ibf_id[ibf_idx][bin], threshold);
-                sum = 0u;
-            }
-            else if (bin + 1u == result.size() ||                                                    // last bin
-                     current_filename_index != hibf_ptr->user_bins.filename_index(ibf_idx, bin + 1)) // end of split bin
-            {
-                if (sum >= threshold)
-                    result_buffer[current_filename_index] = sum;
-                sum = 0u;
-            }
+            if (sum < threshold)
+                continue;
+
+            if (run->target & bin_run::merged_flag)
+                bulk_count_impl(values, run->target & ~bin_run::merged_flag, threshold);
+            else
+                result_buffer[run->target] = sum;
         }
     }
 
@@ -0,0 +1,86 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::advise_huge_pages.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if __has_include(<sys/mman.h>)
+#    include <sys/mman.h>
+#endif
+
+#include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
+
+namespace raptor
+{
+
+template <seqan3::data_layout data_layout_mode_>
+class hierarchical_interleaved_bloom_filter;
+
+namespace detail
+{
+
+//!\brief The size of a transparent huge page on x86_64 and most aarch64 systems.
+inline constexpr uintptr_t huge_page_size{1ULL << 21}; // 2 MiB
+
+/*!\brief Asks the kernel to back the 2 MiB-aligned part of the memory with transparent huge pages.
+ * \details
+ * Memory that is already in use, e.g. because it was zeroed or read from disk, is collapsed into huge pages right away
+ * if the kernel supports it (Linux 6.1). Both are only hints; errors are ignored.
+ */
+inline void advise_huge_pages(void const * const data, size_t const bytes) noexcept
+{
+#ifdef MADV_HUGEPAGE
+    uintptr_t const address = reinterpret_cast<uintptr_t>(data);
+    uintptr_t const begin = (address + huge_page_size - 1u) & ~(huge_page_size - 1u);
+    uintptr_t const end = (address + bytes) & ~(huge_page_size - 1u);
+
+    if (begin >= end)
+        return;
+
+    void * const aligned_data = reinterpret_cast<void *>(begin);
+    madvise(aligned_data, end - begin, MADV_HUGEPAGE);
+#    ifdef MADV_COLLAPSE
+    madvise(aligned_data, end - begin, MADV_COLLAPSE);
+#    endif
+#else
+    (void)data;
+    (void)bytes;
+#endif
+}
+
+} // namespace detail
+
+/*!\brief Backs the bit vector of an uncompressed IBF with transparent huge pages.
+ * \details
+ * Queries access the bit vector at random positions. With 4 KiB pages, almost every access of a large IBF misses the
+ * TLB. Compressed IBFs are not changed.
+ */
+template <seqan3::data_layout data_layout_mode>
+void advise_huge_pages(seqan3::interleaved_bloom_filter<data_layout_mode> const & ibf) noexcept
+{
+    if constexpr (data_layout_mode == seqan3::data_layout::uncompressed)
+        detail::advise_huge_pages(ibf.raw_data().data(), ibf.bit_size() / 8u);
+}
+
+//!\overload
+template <seqan3::data_layout data_layout_mode>
+void advise_huge_pages(hierarchical_interleaved_bloom_filter<data_layout_mode> const & hibf) noexcept
+{
+    for (auto const & ibf : hibf.ibf_vector)
+        advise_huge_pages(ibf);
+    for (auto const & ibf : hibf.uncompressed_ibfs)
+        advise_huge_pages(ibf);
+}
+
+} // namespace raptor
@@ -0,0 +1,108 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::hyperloglog.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace raptor
+{
+
+/*!\brief A HyperLogLog sketch for estimating the number of distinct hash values.
+ * \details
+ * Uses \f$2^{14}\f$ registers, which results in a relative standard error of about 0.8%.
+ * The input values do not need to be uniformly distributed; they are mixed before being added.
+ */
+class hyperloglog
+{
+public:
+    static constexpr uint8_t precision{14u};
+    static constexpr size_t register_count{size_t{1u} << precision};
+    //!\brief The relative standard error of the estimate: \f$1.04 / \sqrt{m}\f$.
+    static constexpr double relative_error{1.04 / 128.0};
+
+    hyperloglog() = default;
+    hyperloglog(hyperloglog const &) = default;
+    hyperloglog(hyperloglog &&) = default;
+    hyperloglog & operator=(hyperloglog const &) = default;
+    hyperloglog & operator=(hyperloglog &&) = default;
+    ~hyperloglog() = default;
+
+    void add(uint64_t const value) noexcept
+    {
+        uint64_t const hash = mix(value);
+        size_t const index = hash >> (64u - precision);
+        uint64_t const remainder = hash << precision;
+        uint8_t const rank = (remainder == 0u) ? 64u - precision + 1u : std::countl_zero(remainder) + 1u;
+        registers[index] = std::max(registers[index], rank);
+    }
+
+    //!\brief Merges another sketch into this one. The result is the sketch of the union.
+    void merge(hyperloglog const & other) noexcept
+    {
+        for (size_t i = 0; i < register_count; ++i)
+            registers[i] = std::max(registers[i], other.registers[i]);
+    }
+
+    [[nodiscard]] double estimate() const noexcept
+    {
+        constexpr double m = register_count;
+        constexpr double alpha = 0.7213 / (1.0 + 1.079 / m);
+
+        double sum{};
+        size_t zeros{};
+        for (uint8_t const value : registers)
+        {
+            sum += std::ldexp(1.0, -static_cast<int>(value));
+            zeros += (value == 0u);
+        }
+
+        double const raw = alpha * m * m / sum;
+
+        // Linear counting for small cardinalities.
+        if (raw <= 2.5 * m && zeros > 0u)
+            return m * std::log(m / zeros);
+
+        return raw;
+    }
+
+    void store(std::ostream & stream) const
+    {
+        stream.write(reinterpret_cast<char const *>(registers.data()), register_count);
+    }
+
+    //!\brief Returns `false` if the stream does not contain a complete sketch.
+    bool load(std::istream & stream)
+    {
+        stream.read(reinterpret_cast<char *>(registers.data()), register_count);
+        return stream.gcount() == static_cast<std::streamsize>(register_count);
+    }
+
+private:
+    std::vector<uint8_t> registers = std::vector<uint8_t>(register_count);
+
+    //!\brief The splitmix64 finaliser. Minimiser values are not uniformly distributed.
+    static constexpr uint64_t mix(uint64_t value) noexcept
+    {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+};
+
+} // namespace raptor
@@ -64,10 +64,12 @@ private:
     double fpr_{};
     bool is_hibf_{index_structure::is_hibf<data_t>};
     data_t ibf_{};
+    uint32_t parsed_version_{version};
 
 public:
     static constexpr seqan3::data_layout data_layout_mode = data_t::data_layout_mode;
-    static constexpr uint32_t version{2u};
+    //!\brief Version 3 stores the uncompressed IBFs of compressed HIBFs. Version 2 can still be loaded.
+    static constexpr uint32_t version{3u};
 
     raptor_index() = default;
     raptor_index(raptor_index const &) = default;
@@ -99,7 +101,7 @@ public:
         compressed_{arguments.compressed},
         bin_path_{arguments.bin_path},
         fpr_{arguments.fpr},
-        ibf_{seqan3::bin_count{arguments.bins},
+        ibf_{seqan3::bin_count{arguments.bins + arguments.reserved_bins},
              seqan3::bin_size{arguments.bits / arguments.parts},
              seqan3::hash_function_count{arguments.hash}}
     {
@@ -152,6 +154,11 @@ public:
         return compressed_;
     }
 
+    std::vector<std::vector<std::string>> & bin_path()
+    {
+        return bin_path_;
+    }
+
     std::vector<std::vector<std::string>> const & bin_path() const
     {
         return bin_path_;
@@ -167,6 +174,18 @@ public:
         return is_hibf_;
     }
 
+    //!\brief The version of the loaded index. raptor_index::version if the index was not loaded.
+    uint32_t parsed_version() const
+    {
+        return parsed_version_;
+    }
+
+    //!\brief Whether indices of the version can be loaded. Older indices need `raptor upgrade`.
+    static constexpr bool is_supported_version(uint32_t const parsed_version) noexcept
+    {
+        return parsed_version == 2u || parsed_version == version;
+    }
+
     data_t & ibf()
     {
         return ibf_;
@@ -190,10 +209,11 @@ public:
     {
         uint32_t parsed_version{raptor_index<>::version};
         archive(parsed_version);
-        if (parsed_version == raptor_index<>::version)
+        if (is_supported_version(parsed_version))
         {
             try
             {
+                parsed_version_ = parsed_version;
                 archive(window_size_);
                 archive(shape_);
                 archive(parts_);
@@ -204,7 +224,15 @@ public:
                 archive(bin_path_);
                 archive(fpr_);
                 archive(is_hibf_);
-                archive(ibf_);
+                if constexpr (index_structure::is_hibf<data_t>)
+                {
+                    archive(ibf_.ibf_vector);
+                    ibf_.serialize_bookkeeping(archive, parsed_version >= 3u);
+                }
+                else
+                {
+                    archive(ibf_);
+                }
             }
             catch (std::exception const & e)
             {
@@ -230,10 +258,11 @@ public:
     {
         uint32_t parsed_version{};
         archive(parsed_version);
-        if (parsed_version == version)
+        if (is_supported_version(parsed_version))
         {
             try
             {
+                parsed_version_ = parsed_version;
                 archive(window_size_);
                 archive(shape_);
                 archive(parts_);
@@ -255,21 +284,29 @@ public:
         }
     }
 
-    //!\brief Load parameters from old index format for use with raptor upgrade.
+    /*!\brief Load parameters from old index format for use with raptor upgrade.
+     * \details Indices of version 2 are loaded with all parameters and only need to be stored with the current version.
+     */
     template <seqan3::cereal_input_archive archive_t>
     void load_old_parameters(archive_t & archive)
     {
         uint32_t parsed_version{};
         archive(parsed_version);
-        if (parsed_version == 1u)
+        if (parsed_version == 1u || parsed_version == 2u)
         {
             try
             {
+                parsed_version_ = parsed_version;
                 archive(window_size_);
                 archive(shape_);
                 archive(parts_);
                 archive(compressed_);
                 archive(bin_path_);
+                if (parsed_version == 2u)
+                {
+                    archive(fpr_);
+                    archive(is_hibf_);
+                }
             }
             // GCOVR_EXCL_START
             catch (std::exception const & e)
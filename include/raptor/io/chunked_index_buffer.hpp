@@ -0,0 +1,164 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::chunked_index_output_buffer and raptor::chunked_index_input_buffer.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <ios>
+#include <memory>
+#include <streambuf>
+#include <vector>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+//!\brief A checksummed, contiguous range of an index file.
+struct index_segment
+{
+    uint64_t offset{};
+    uint64_t length{};
+    uint64_t checksum{};
+};
+
+//!\brief Computes the checksums of consecutive segments from a stream of bytes.
+class segment_hasher;
+
+/*!\brief The trailer that is appended to an index file after the serialised index.
+ * \details
+ * ```
+ * [serialised index][segment table (index_segment[segment_count])][segment_count][payload_size][magic]
+ * ```
+ * Since the trailer follows the serialised index, loading an index with a plain `std::ifstream` still works.
+ */
+struct index_trailer
+{
+    static constexpr uint64_t magic{0x4B43484354504152ULL}; // "RAPTCHCK"
+    static constexpr size_t fixed_size{3u * sizeof(uint64_t)};
+};
+
+} // namespace detail
+
+/*!\brief A stream buffer that writes an index in parallel and appends checksums.
+ * \details
+ * Small writes are buffered and written sequentially. Large blocks, e.g., the bitvector of an IBF, are split into
+ * chunks that are written concurrently via `pwrite`. Each segment of at most `chunk_size` bytes gets an XXH3 checksum.
+ * The written bytes are identical to the ones a `std::ofstream` would produce; the checksums are appended after the
+ * serialised index by raptor::chunked_index_output_buffer::close.
+ * The index is written to a temporary file in the same directory, which replaces `path` once `close` succeeded. If the
+ * buffer is destroyed without calling `close`, e.g., because serialising the index threw, the temporary file is removed
+ * and `path` is left untouched.
+ */
+class chunked_index_output_buffer : public std::streambuf
+{
+public:
+    static constexpr size_t default_chunk_size{1ULL << 24}; // 16 MiB
+
+    chunked_index_output_buffer() = delete;
+    chunked_index_output_buffer(chunked_index_output_buffer const &) = delete;
+    chunked_index_output_buffer & operator=(chunked_index_output_buffer const &) = delete;
+    chunked_index_output_buffer(chunked_index_output_buffer &&) = delete;
+    chunked_index_output_buffer & operator=(chunked_index_output_buffer &&) = delete;
+    ~chunked_index_output_buffer() override;
+
+    explicit chunked_index_output_buffer(std::filesystem::path const & path,
+                                         size_t const threads,
+                                         size_t const chunk_size = default_chunk_size);
+
+    /*!\brief Writes all remaining data and the checksums, then replaces `path` with the written file.
+     * \details Must be called after the index was written successfully.
+     */
+    void close();
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(char_type const * s, std::streamsize n) override;
+    int sync() override;
+
+private:
+    std::filesystem::path path{};
+    std::filesystem::path tmp_path{};
+    int fd{-1};
+    size_t threads{1u};
+    size_t chunk_size{default_chunk_size};
+    uint64_t file_offset{};
+    uint64_t open_segment_offset{};
+    uint64_t open_segment_length{};
+    std::vector<char_type> buffer{};
+    std::vector<detail::index_segment> segments{};
+    std::unique_ptr<detail::segment_hasher> hasher;
+
+    void flush_buffer();
+    void close_segment();
+    void write_large_block(char_type const * data, size_t const size);
+};
+
+/*!\brief A stream buffer that reads an index in parallel and verifies its checksums.
+ * \details
+ * Large reads are split into chunks that are read concurrently via `pread`. If the file has no checksums, e.g.,
+ * because it was written by an older version of Raptor, the index is read without verification.
+ * A `std::runtime_error` is thrown if a checksum does not match.
+ *
+ * Seeking, e.g., to an IBF of an HIBF, is supported. Before seeking, the rest of the segment that was read partially
+ * is verified. After seeking, the bytes of the segment before the new position are read and hashed, too. After
+ * reading a range in the middle of the file, raptor::chunked_index_input_buffer::finish verifies the last segment.
+ */
+class chunked_index_input_buffer : public std::streambuf
+{
+public:
+    chunked_index_input_buffer() = delete;
+    chunked_index_input_buffer(chunked_index_input_buffer const &) = delete;
+    chunked_index_input_buffer & operator=(chunked_index_input_buffer const &) = delete;
+    chunked_index_input_buffer(chunked_index_input_buffer &&) = delete;
+    chunked_index_input_buffer & operator=(chunked_index_input_buffer &&) = delete;
+    ~chunked_index_input_buffer() override;
+
+    explicit chunked_index_input_buffer(std::filesystem::path const & path, size_t const threads);
+
+    //!\brief Whether the file contains checksums.
+    bool has_checksums() const noexcept
+    {
+        return !segments.empty();
+    }
+
+    /*!\brief Reads and verifies the rest of the segment that was read partially.
+     * \details Afterwards, the buffer is at the end of the file.
+     */
+    void finish();
+
+protected:
+    int_type underflow() override;
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+    std::streamsize xsgetn(char_type * s, std::streamsize n) override;
+
+private:
+    int fd{-1};
+    size_t threads{1u};
+    uint64_t file_offset{};
+    uint64_t payload_size{};
+    std::vector<char_type> buffer{};
+    std::vector<detail::index_segment> segments{};
+    size_t current_segment{};
+    uint64_t open_segment_length{};
+    std::unique_ptr<detail::segment_hasher> hasher;
+
+    void read_trailer(uint64_t const file_size);
+    void read_large_block(char_type * data, size_t const size);
+    void read_and_verify(uint64_t const end);
+    void verify_open_segment();
+    void verify(char_type const * data, size_t const size);
+};
+
+} // namespace raptor
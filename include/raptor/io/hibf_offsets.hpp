@@ -0,0 +1,170 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::hibf_offsets.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+
+#include <raptor/io/chunked_index_buffer.hpp>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+//!\brief A stream buffer that only counts the written bytes.
+class byte_counter : public std::streambuf
+{
+public:
+    uint64_t count{};
+
+protected:
+    int_type overflow(int_type ch) override
+    {
+        ++count;
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(char_type const *, std::streamsize n) override
+    {
+        count += n;
+        return n;
+    }
+};
+
+//!\brief The number of bytes cereal::BinaryOutputArchive writes for the values.
+template <typename... values_t>
+uint64_t serialised_size(values_t const &... values)
+{
+    byte_counter counter{};
+    {
+        std::ostream os{std::addressof(counter)};
+        cereal::BinaryOutputArchive oarchive{os};
+        oarchive(values...);
+    }
+    return counter.count;
+}
+
+//!\brief The number of bytes cereal::BinaryOutputArchive writes for the bookkeeping of the HIBF.
+template <typename hibf_t>
+uint64_t serialised_bookkeeping_size(hibf_t const & hibf)
+{
+    byte_counter counter{};
+    {
+        std::ostream os{std::addressof(counter)};
+        cereal::BinaryOutputArchive oarchive{os};
+        // Saving does not modify the HIBF.
+        const_cast<hibf_t &>(hibf).serialize_bookkeeping(oarchive);
+    }
+    return counter.count;
+}
+
+} // namespace detail
+
+/*!\brief The positions of the IBFs of an HIBF in its index file.
+ * \details
+ * The offsets are written directly after the serialised index, and before the checksums of
+ * raptor::chunked_index_output_buffer:
+ * ```
+ * [serialised index][IBF offsets (uint64_t[ibf_count])][bookkeeping offset][ibf_count][magic][checksums]
+ * ```
+ * The bookkeeping offset is the position of the data serialised after the IBFs, see
+ * raptor::hierarchical_interleaved_bloom_filter::serialize_bookkeeping.
+ * Loading the index as usual ignores the offsets.
+ */
+struct hibf_offsets
+{
+    static constexpr uint64_t magic{0x4642494854504152ULL}; // "RAPTHIBF"
+    static constexpr size_t fixed_size{3u * sizeof(uint64_t)};
+
+    std::vector<uint64_t> ibf_offsets{};
+    uint64_t bookkeeping_offset{};
+
+    //!\brief Computes the offsets of the IBFs in the file that `index` is serialised to.
+    template <typename index_t>
+    static hibf_offsets compute(index_t const & index)
+    {
+        auto const & hibf = index.ibf();
+        uint64_t const index_size = detail::serialised_size(index);
+
+        hibf_offsets result{};
+        result.bookkeeping_offset = index_size - detail::serialised_bookkeeping_size(hibf);
+        result.ibf_offsets.resize(hibf.ibf_vector.size());
+
+        uint64_t end = result.bookkeeping_offset;
+        for (size_t i = hibf.ibf_vector.size(); i > 0u; --i)
+        {
+            end -= detail::serialised_size(hibf.ibf_vector[i - 1u]);
+            result.ibf_offsets[i - 1u] = end;
+        }
+
+        return result;
+    }
+
+    void write(std::ostream & os) const
+    {
+        std::array<uint64_t, 3> const fixed{bookkeeping_offset, ibf_offsets.size(), magic};
+        os.write(reinterpret_cast<char const *>(ibf_offsets.data()), ibf_offsets.size() * sizeof(uint64_t));
+        os.write(reinterpret_cast<char const *>(fixed.data()), fixed_size);
+    }
+
+    //!\brief Returns `false` if the file contains no offsets, e.g., because it was written by an older version.
+    bool read(std::filesystem::path const & path)
+    {
+        std::ifstream is{path, std::ios::binary};
+        uint64_t const file_size = std::filesystem::file_size(path);
+        uint64_t payload_size = file_size;
+
+        auto read_fixed = [&is](uint64_t const position)
+        {
+            std::array<uint64_t, 3> fixed{};
+            is.seekg(position);
+            is.read(reinterpret_cast<char *>(fixed.data()), fixed_size);
+            return fixed;
+        };
+
+        // Skip the checksums.
+        if (file_size >= detail::index_trailer::fixed_size)
+        {
+            auto const [segment_count, stored_payload_size, stored_magic] =
+                read_fixed(file_size - detail::index_trailer::fixed_size);
+            uint64_t const table_size = segment_count * sizeof(detail::index_segment);
+            if (stored_magic == detail::index_trailer::magic
+                && stored_payload_size + table_size + detail::index_trailer::fixed_size == file_size)
+                payload_size = stored_payload_size;
+        }
+
+        if (payload_size < fixed_size)
+            return false;
+
+        auto const [stored_bookkeeping_offset, ibf_count, stored_magic] = read_fixed(payload_size - fixed_size);
+        if (!is || stored_magic != magic || (ibf_count + 3u) * sizeof(uint64_t) > payload_size)
+            return false;
+
+        bookkeeping_offset = stored_bookkeeping_offset;
+        ibf_offsets.resize(ibf_count);
+        is.seekg(payload_size - fixed_size - ibf_count * sizeof(uint64_t));
+        is.read(reinterpret_cast<char *>(ibf_offsets.data()), ibf_count * sizeof(uint64_t));
+        return static_cast<bool>(is);
+    }
+};
+
+} // namespace raptor
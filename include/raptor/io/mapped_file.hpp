@@ -0,0 +1,120 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::detail::mapped_file.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>) && __has_include(<fcntl.h>) && __has_include(<unistd.h>)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <unistd.h>
+#    define RAPTOR_HAS_MMAP 1
+#else
+#    define RAPTOR_HAS_MMAP 0
+#endif
+
+namespace raptor::detail
+{
+
+/*!\brief The read-only content of a file.
+ * \details
+ * The file is memory-mapped and read ahead by the kernel (`MADV_SEQUENTIAL`). Without `mmap`, the file is read into
+ * memory. In both cases, the data is aligned to at least 8 bytes.
+ */
+class mapped_file
+{
+public:
+    mapped_file() = default;
+    mapped_file(mapped_file const &) = delete;
+    mapped_file & operator=(mapped_file const &) = delete;
+
+    mapped_file(mapped_file && other) noexcept :
+        mapping{std::exchange(other.mapping, nullptr)},
+        bytes{std::exchange(other.bytes, 0u)},
+        buffer{std::move(other.buffer)}
+    {}
+
+    mapped_file & operator=(mapped_file && other) noexcept
+    {
+        if (this != std::addressof(other))
+        {
+            unmap();
+            mapping = std::exchange(other.mapping, nullptr);
+            bytes = std::exchange(other.bytes, 0u);
+            buffer = std::move(other.buffer);
+        }
+        return *this;
+    }
+
+    ~mapped_file()
+    {
+        unmap();
+    }
+
+    explicit mapped_file(std::filesystem::path const & path) : bytes{std::filesystem::file_size(path)}
+    {
+        // mmap fails for empty files.
+        if (bytes == 0u)
+            return;
+
+#if RAPTOR_HAS_MMAP
+        int const fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw std::runtime_error{"Could not open " + path.string()};
+
+        void * const address = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED)
+            throw std::runtime_error{"Could not map " + path.string()};
+
+        mapping = address;
+        ::madvise(mapping, bytes, MADV_SEQUENTIAL);
+#else
+        buffer.resize((bytes + sizeof(uint64_t) - 1u) / sizeof(uint64_t));
+        std::ifstream is{path, std::ios::binary};
+        if (!is.read(reinterpret_cast<char *>(buffer.data()), bytes))
+            throw std::runtime_error{"Could not read " + path.string()};
+#endif
+    }
+
+    char const * data() const noexcept
+    {
+        return mapping != nullptr ? static_cast<char const *>(mapping) : reinterpret_cast<char const *>(buffer.data());
+    }
+
+    size_t size() const noexcept
+    {
+        return bytes;
+    }
+
+private:
+    void * mapping{nullptr};
+    size_t bytes{};
+    std::vector<uint64_t> buffer{};
+
+    void unmap() noexcept
+    {
+#if RAPTOR_HAS_MMAP
+        if (mapping != nullptr)
+            ::munmap(mapping, bytes);
+#endif
+        mapping = nullptr;
+    }
+};
+
+} // namespace raptor::detail
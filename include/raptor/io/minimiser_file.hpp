@@ -0,0 +1,427 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::minimiser_file_header, raptor::minimiser_file_writer, and raptor::minimiser_file_reader.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <seqan3/search/kmer_index/shape.hpp>
+
+#include <raptor/io/mapped_file.hpp>
+
+namespace raptor
+{
+
+/*!\brief The parameters and size of a minimiser file.
+ * \details
+ * Minimiser files written by `raptor prepare` start with this header, see raptor::minimiser_file_writer.
+ * Files of older versions contain only the raw minimiser values; their header is read from the `.header` file next
+ * to them and has version `0`.
+ */
+struct minimiser_file_header
+{
+    static constexpr uint64_t magic{0x494E494D54504152ULL}; // "RAPTMINI"
+    static constexpr uint64_t current_version{1u};
+    static constexpr size_t size{8u * sizeof(uint64_t)};
+
+    uint64_t version{current_version};
+    uint64_t shape{};
+    uint32_t window_size{};
+    uint8_t cutoff{};
+    //!\brief The number of minimisers.
+    uint64_t count{};
+    uint64_t block_count{};
+    //!\brief The position of the block index in the file.
+    uint64_t index_offset{};
+
+    seqan3::shape to_shape() const
+    {
+        return seqan3::shape{seqan3::bin_literal{shape}};
+    }
+
+    void write(std::ostream & os) const
+    {
+        std::array<uint64_t, 8> const fields{magic, version, shape, window_size,
+                                             cutoff, count, block_count, index_offset};
+        os.write(reinterpret_cast<char const *>(fields.data()), size);
+    }
+
+    //!\brief Reads an embedded header from the first bytes of a file. Returns `false` if they are not one.
+    bool read(char const * const data, size_t const bytes)
+    {
+        std::array<uint64_t, 8> fields{};
+        if (bytes < size)
+            return false;
+
+        std::memcpy(fields.data(), data, size);
+        if (fields[0] != magic)
+            return false;
+
+        if (fields[1] > current_version)
+            throw std::runtime_error{"The minimiser file was written by a newer version of Raptor."};
+
+        version = fields[1];
+        shape = fields[2];
+        window_size = static_cast<uint32_t>(fields[3]);
+        cutoff = static_cast<uint8_t>(fields[4]);
+        count = fields[5];
+        block_count = fields[6];
+        index_offset = fields[7];
+        return true;
+    }
+
+    //!\brief Reads the header of a minimiser file. Throws if neither the file nor its `.header` file has one.
+    static minimiser_file_header read(std::filesystem::path const & path)
+    {
+        minimiser_file_header header{};
+        {
+            std::array<char, size> data{};
+            std::ifstream is{path, std::ios::binary};
+            is.read(data.data(), size);
+            if (header.read(data.data(), is.gcount()))
+                return header;
+        }
+
+        std::filesystem::path header_path{path};
+        header_path.replace_extension("header");
+        std::ifstream is{header_path};
+        std::string shape_string{};
+        uint16_t cutoff{};
+        header.version = 0u;
+        if (!(is >> shape_string >> header.window_size >> cutoff >> header.count))
+            throw std::runtime_error{"Could not read the header of the minimiser file " + path.string()};
+
+        header.shape = std::stoull(shape_string, nullptr, 2);
+        header.cutoff = static_cast<uint8_t>(cutoff);
+        return header;
+    }
+};
+
+namespace detail
+{
+
+//!\brief Minimisers per block of a raptor::minimiser_file_header::current_version file.
+inline constexpr size_t minimiser_block_size{1024u};
+
+/*!\brief Encodes a block of strictly ascending minimisers.
+ * \details
+ * A block stores the first value, followed by the gaps to the respective previous value, minus one, bit-packed with
+ * the width of the largest gap:
+ * ```
+ * [first value (uint64_t)][width (uint8_t)][gaps (uint64_t[ceil((n - 1) * width / 64)])]
+ * ```
+ * Minimisers of k-mers have at most 2k bits, so the gaps of a file with many minimisers are small.
+ */
+inline void encode_minimiser_block(std::vector<uint64_t> const & values, std::vector<char> & output)
+{
+    assert(!values.empty());
+    assert(std::ranges::adjacent_find(values, std::ranges::greater_equal{}) == values.end());
+
+    uint64_t max_gap{};
+    for (size_t i = 1; i < values.size(); ++i)
+        max_gap = std::max(max_gap, values[i] - values[i - 1u] - 1u);
+
+    uint8_t const width = std::bit_width(max_gap);
+    std::vector<uint64_t> words(((values.size() - 1u) * width + 63u) / 64u);
+
+    // With width 0, all gaps are 0 and no words are needed.
+    for (size_t i = 1, bit = 0; width != 0u && i < values.size(); ++i, bit += width)
+    {
+        uint64_t const gap = values[i] - values[i - 1u] - 1u;
+        size_t const word = bit / 64u;
+        size_t const offset = bit % 64u;
+        words[word] |= gap << offset;
+        if (offset + width > 64u)
+            words[word + 1u] |= gap >> (64u - offset);
+    }
+
+    size_t const position = output.size();
+    output.resize(position + sizeof(uint64_t) + 1u + words.size() * sizeof(uint64_t));
+    std::memcpy(output.data() + position, values.data(), sizeof(uint64_t));
+    output[position + sizeof(uint64_t)] = static_cast<char>(width);
+    std::memcpy(output.data() + position + sizeof(uint64_t) + 1u, words.data(), words.size() * sizeof(uint64_t));
+}
+
+//!\brief The number of bytes of an encoded block with `count` values and the given width.
+constexpr size_t minimiser_block_bytes(size_t const count, uint8_t const width) noexcept
+{
+    return sizeof(uint64_t) + 1u + ((count - 1u) * width + 63u) / 64u * sizeof(uint64_t);
+}
+
+//!\brief Decodes a block of `count` values into `output`. Returns the number of bytes of the block.
+inline size_t decode_minimiser_block(char const * const data, size_t const count, uint64_t * const output)
+{
+    uint64_t value{};
+    std::memcpy(&value, data, sizeof(uint64_t));
+    uint8_t const width = static_cast<uint8_t>(data[sizeof(uint64_t)]);
+    char const * const words = data + sizeof(uint64_t) + 1u;
+    uint64_t const mask = width == 64u ? ~0ULL : (1ULL << width) - 1u;
+
+    auto word = [words](size_t const idx)
+    {
+        uint64_t result{};
+        std::memcpy(&result, words + idx * sizeof(uint64_t), sizeof(uint64_t));
+        return result;
+    };
+
+    output[0] = value;
+    for (size_t i = 1, bit = 0; i < count; ++i, bit += width)
+    {
+        uint64_t gap{};
+        if (width != 0u)
+        {
+            size_t const idx = bit / 64u;
+            size_t const offset = bit % 64u;
+            gap = word(idx) >> offset;
+            if (offset + width > 64u)
+                gap |= word(idx + 1u) << (64u - offset);
+        }
+        value += (gap & mask) + 1u;
+        output[i] = value;
+    }
+
+    return minimiser_block_bytes(count, width);
+}
+
+} // namespace detail
+
+/*!\brief Writes a minimiser file.
+ * \details
+ * The minimisers must be pushed in strictly ascending order. The file layout is
+ * ```
+ * [header][block 0][block 1]...[block index: (first value, offset)[block_count]]
+ * ```
+ * see raptor::minimiser_file_header and raptor::detail::encode_minimiser_block. The header is written last by
+ * raptor::minimiser_file_writer::finish.
+ */
+class minimiser_file_writer
+{
+public:
+    minimiser_file_writer(minimiser_file_writer const &) = delete;
+    minimiser_file_writer & operator=(minimiser_file_writer const &) = delete;
+    minimiser_file_writer(minimiser_file_writer &&) = default;
+    minimiser_file_writer & operator=(minimiser_file_writer &&) = default;
+    ~minimiser_file_writer() = default;
+
+    minimiser_file_writer(std::filesystem::path path,
+                          seqan3::shape const & shape,
+                          uint32_t const window_size,
+                          uint8_t const cutoff) :
+        path{std::move(path)},
+        stream{this->path, std::ios::binary}
+    {
+        header.shape = shape.to_ulong();
+        header.window_size = window_size;
+        header.cutoff = cutoff;
+        header.write(stream); // Placeholder.
+        values.reserve(detail::minimiser_block_size);
+    }
+
+    void push_back(uint64_t const value)
+    {
+        values.push_back(value);
+        if (values.size() == detail::minimiser_block_size)
+            flush();
+    }
+
+    //!\brief Writes the remaining minimisers, the block index, and the header. Returns the number of minimisers.
+    uint64_t finish()
+    {
+        flush();
+        header.index_offset = static_cast<uint64_t>(stream.tellp());
+        stream.write(reinterpret_cast<char const *>(index.data()), index.size() * sizeof(uint64_t));
+        header.block_count = index.size() / 2u;
+        stream.seekp(0);
+        header.write(stream);
+        stream.close();
+
+        if (!stream)
+            throw std::runtime_error{"Could not write minimiser file " + path.string()};
+
+        return header.count;
+    }
+
+private:
+    std::filesystem::path path{};
+    std::ofstream stream{};
+    minimiser_file_header header{};
+    std::vector<uint64_t> values{};
+    std::vector<char> buffer{};
+    //!\brief (first value, offset) of each block.
+    std::vector<uint64_t> index{};
+
+    void flush()
+    {
+        if (values.empty())
+            return;
+
+        index.push_back(values.front());
+        index.push_back(static_cast<uint64_t>(stream.tellp()));
+        header.count += values.size();
+
+        buffer.clear();
+        detail::encode_minimiser_block(values, buffer);
+        stream.write(buffer.data(), buffer.size());
+        values.clear();
+    }
+};
+
+/*!\brief Reads a minimiser file.
+ * \details
+ * Reads both raptor::minimiser_file_writer files and the raw minimiser values of older versions. The file is
+ * memory-mapped, see raptor::detail::mapped_file. Minimisers are handed out as spans: the raw values of older versions
+ * directly from the mapped file, and the values of version 1 files one decoded block at a time.
+ *
+ * The block index of version 1 files allows decoding only the block that may contain a value. For files of older
+ * versions, the header only has version `0`; use raptor::minimiser_file_header::read to read their `.header` file.
+ */
+class minimiser_file_reader
+{
+public:
+    minimiser_file_reader(minimiser_file_reader const &) = delete;
+    minimiser_file_reader & operator=(minimiser_file_reader const &) = delete;
+    minimiser_file_reader(minimiser_file_reader &&) = default;
+    minimiser_file_reader & operator=(minimiser_file_reader &&) = default;
+    ~minimiser_file_reader() = default;
+
+    explicit minimiser_file_reader(std::filesystem::path const & path)
+    {
+        if (!std::filesystem::exists(path))
+            throw std::runtime_error{"Could not open minimiser file " + path.string()};
+
+        file = detail::mapped_file{path};
+
+        if (!file_header.read(file.data(), file.size()))
+            file_header = minimiser_file_header{.version = 0u};
+        else if (file_header.index_offset < minimiser_file_header::size
+                 || file_header.index_offset + 2u * file_header.block_count * sizeof(uint64_t) > file.size())
+            throw std::runtime_error{"The minimiser file " + path.string() + " is corrupted."};
+    }
+
+    minimiser_file_header const & header() const noexcept
+    {
+        return file_header;
+    }
+
+    /*!\brief Calls `callback` with consecutive spans of minimisers (`std::span<uint64_t const>`).
+     * \details Minimisers of version 1 files are in ascending order.
+     */
+    template <typename callback_t>
+    void for_each_span(callback_t && callback) const
+    {
+        if (file_header.version == 0u)
+        {
+            // The mapping is page-aligned. Trailing bytes that do not form a value are ignored.
+            callback(std::span<uint64_t const>{reinterpret_cast<uint64_t const *>(file.data()),
+                                               file.size() / sizeof(uint64_t)});
+            return;
+        }
+
+        std::array<uint64_t, detail::minimiser_block_size> values;
+        size_t offset{minimiser_file_header::size};
+        for (size_t block = 0; block < file_header.block_count; ++block)
+        {
+            size_t const count = block_size(block);
+            offset += detail::decode_minimiser_block(checked_block(offset, count), count, values.data());
+            callback(std::span<uint64_t const>{values.data(), count});
+        }
+    }
+
+    //!\brief Calls `callback` for each minimiser.
+    template <typename callback_t>
+    void for_each(callback_t && callback) const
+    {
+        for_each_span(
+            [&callback](std::span<uint64_t const> const values)
+            {
+                for (uint64_t const value : values)
+                    callback(value);
+            });
+    }
+
+    //!\brief Returns whether the file contains the value. For version 1 files, only decodes one block.
+    bool contains(uint64_t const value) const
+    {
+        if (file_header.version == 0u)
+        {
+            bool found{false};
+            for_each_span(
+                [&](std::span<uint64_t const> const values)
+                {
+                    found |= std::ranges::find(values, value) != values.end();
+                });
+            return found;
+        }
+
+        // The last block whose first value is not greater than the value. The index is (first value, offset).
+        char const * const index = file.data() + file_header.index_offset;
+        auto index_entry = [index](size_t const block, size_t const field)
+        {
+            uint64_t result{};
+            std::memcpy(&result, index + (2u * block + field) * sizeof(uint64_t), sizeof(uint64_t));
+            return result;
+        };
+
+        size_t first{0u};
+        size_t last{file_header.block_count};
+        while (first < last)
+        {
+            size_t const middle = first + (last - first) / 2u;
+            if (index_entry(middle, 0u) <= value)
+                first = middle + 1u;
+            else
+                last = middle;
+        }
+
+        if (first == 0u)
+            return false;
+
+        size_t const block = first - 1u;
+        std::array<uint64_t, detail::minimiser_block_size> values;
+        size_t const count = block_size(block);
+        detail::decode_minimiser_block(checked_block(index_entry(block, 1u), count), count, values.data());
+        return std::ranges::binary_search(values.begin(), values.begin() + count, value);
+    }
+
+private:
+    detail::mapped_file file{};
+    minimiser_file_header file_header{};
+
+    size_t block_size(size_t const block) const noexcept
+    {
+        return std::min<size_t>(detail::minimiser_block_size, file_header.count - block * detail::minimiser_block_size);
+    }
+
+    //!\brief Returns the data of the block at `offset`. Throws if the block exceeds the blocks of the file.
+    char const * checked_block(size_t const offset, size_t const count) const
+    {
+        size_t const end = file_header.index_offset;
+        if (offset + sizeof(uint64_t) + 1u > end
+            || offset + detail::minimiser_block_bytes(count, static_cast<uint8_t>(file.data()[offset + 8u])) > end)
+            throw std::runtime_error{"The minimiser file is corrupted."};
+
+        return file.data() + offset;
+    }
+};
+
+} // namespace raptor
@@ -0,0 +1,122 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::detail::split_records, raptor::detail::is_splittable and raptor::detail::memory_streambuf.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <streambuf>
+#include <string_view>
+#include <vector>
+
+namespace raptor::detail
+{
+
+//!\brief Files smaller than twice this size are not split.
+inline constexpr size_t min_chunk_size{1ULL << 24}; // 16 MiB
+
+//!\brief Returns whether the file is an uncompressed file that is big enough to be split.
+inline bool is_splittable(std::filesystem::path const & path)
+{
+    std::filesystem::path const extension = path.extension();
+    bool const is_compressed = extension == ".gz" || extension == ".bgzf" || extension == ".bz2";
+    return !is_compressed && std::filesystem::file_size(path) >= 2u * min_chunk_size;
+}
+
+//!\brief The formats that raptor::detail::split_records can split.
+enum class record_format
+{
+    unknown,
+    fasta,
+    fastq
+};
+
+//!\brief Determines the format from the first character of a sequence file.
+inline record_format detect_record_format(std::string_view const data) noexcept
+{
+    if (data.empty())
+        return record_format::unknown;
+    if (data.front() == '>' || data.front() == ';')
+        return record_format::fasta;
+    if (data.front() == '@')
+        return record_format::fastq;
+    return record_format::unknown;
+}
+
+/*!\brief Returns the position of the first record that starts at or after `position`.
+ * \details
+ * A FASTA record starts with a line beginning with `>`.
+ * A FASTQ record starts with a line beginning with `@` whose second next line begins with `+`. Quality lines may
+ * begin with `@`, but the second next line of a quality line is a sequence line. Multi-line FASTQ is not supported.
+ */
+inline size_t next_record(std::string_view const data, size_t position, record_format const format) noexcept
+{
+    auto next_line = [&data](size_t const pos) -> size_t
+    {
+        size_t const newline = data.find('\n', pos);
+        return newline == std::string_view::npos ? data.size() : newline + 1u;
+    };
+
+    // Start at the beginning of a line.
+    if (position != 0u && data[position - 1u] != '\n')
+        position = next_line(position);
+
+    for (; position < data.size(); position = next_line(position))
+    {
+        if (format == record_format::fasta && data[position] == '>')
+            return position;
+
+        if (format == record_format::fastq && data[position] == '@')
+        {
+            size_t const plus_line = next_line(next_line(position));
+            if (plus_line < data.size() && data[plus_line] == '+')
+                return position;
+        }
+    }
+
+    return data.size();
+}
+
+/*!\brief Splits a FASTA or FASTQ file into at most `count` chunks of about equal size that start with a record.
+ * \details Returns the whole file as one chunk if the format is not recognised.
+ */
+inline std::vector<std::string_view> split_records(std::string_view const data, size_t const count)
+{
+    record_format const format = detect_record_format(data);
+    if (format == record_format::unknown || count <= 1u)
+        return {data};
+
+    std::vector<std::string_view> chunks{};
+    size_t begin{};
+    for (size_t i = 1; i <= count && begin < data.size(); ++i)
+    {
+        size_t const split = std::max(begin + 1u, data.size() / count * i);
+        size_t const end = i == count ? data.size() : next_record(data, split, format);
+        chunks.push_back(data.substr(begin, end - begin));
+        begin = end;
+    }
+
+    return chunks;
+}
+
+//!\brief A read-only stream buffer over memory, e.g., a chunk of a raptor::detail::mapped_file.
+class memory_streambuf : public std::streambuf
+{
+public:
+    explicit memory_streambuf(std::string_view const data)
+    {
+        char * const begin = const_cast<char *>(data.data());
+        setg(begin, begin, begin + data.size());
+    }
+};
+
+} // namespace raptor::detail
@@ -0,0 +1,62 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::detail::create_temporary_directory.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#if __has_include(<unistd.h>)
+#    include <stdlib.h>
+#    include <unistd.h>
+#    define RAPTOR_HAS_MKDTEMP 1
+#else
+#    include <random>
+#    define RAPTOR_HAS_MKDTEMP 0
+#endif
+
+namespace raptor::detail
+{
+
+/*!\brief Creates a new, empty directory whose name starts with `prefix` and returns its path.
+ * \details The directory did not exist before. Hence, it can be removed without touching files of other processes.
+ */
+inline std::filesystem::path create_temporary_directory(std::filesystem::path const & prefix)
+{
+    if (prefix.has_parent_path())
+        std::filesystem::create_directories(prefix.parent_path());
+
+#if RAPTOR_HAS_MKDTEMP
+    std::string name{prefix.string() + ".XXXXXX"};
+    if (::mkdtemp(name.data()) == nullptr)
+        throw std::filesystem::filesystem_error{"Could not create a temporary directory",
+                                                prefix,
+                                                std::error_code{errno, std::generic_category()}};
+    return name;
+#else
+    std::random_device random{};
+    for (size_t attempt = 0; attempt < 100u; ++attempt)
+    {
+        std::filesystem::path path{prefix};
+        path += '.' + std::to_string(random());
+        if (std::filesystem::create_directory(path))
+            return path;
+    }
+    throw std::filesystem::filesystem_error{"Could not create a temporary directory",
+                                            prefix,
+                                            std::make_error_code(std::errc::file_exists)};
+#endif
+}
+
+} // namespace raptor::detail
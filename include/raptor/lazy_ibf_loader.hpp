@@ -0,0 +1,208 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::lazy_ibf_loader.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <istream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <cereal/archives/binary.hpp>
+
+#include <raptor/huge_pages.hpp>
+#include <raptor/io/chunked_index_buffer.hpp>
+
+namespace raptor
+{
+
+//!\brief Counts the accesses of a raptor::lazy_ibf_loader.
+struct lazy_ibf_statistics
+{
+    uint64_t hits{};
+    uint64_t misses{};
+    uint64_t evictions{};
+};
+
+/*!\brief Loads the IBFs of an HIBF from the index file when they are first accessed.
+ * \details
+ * The offsets of the IBFs in the index file are stored after the index, see raptor::hibf_offsets.
+ * IBFs are read via raptor::chunked_index_input_buffer, which verifies the checksums of the segments containing them.
+ * Concurrent accesses to the same IBF wait until it is loaded. Without a memory limit, IBFs are never evicted and
+ * accessing a loaded IBF does not lock.
+ *
+ * If a memory limit is given, the least recently used IBFs are evicted once the loaded IBFs exceed the limit, and are
+ * loaded again on their next access. The size of an IBF is its size in the index file. An IBF that is still in use is
+ * only freed after the last raptor::lazy_ibf_loader::ibf_pointer to it is destroyed.
+ */
+template <typename ibf_t>
+class lazy_ibf_loader
+{
+public:
+    //!\brief Keeps an IBF loaded while it is in use.
+    using ibf_pointer = std::shared_ptr<ibf_t const>;
+
+    lazy_ibf_loader(lazy_ibf_loader const &) = delete;
+    lazy_ibf_loader & operator=(lazy_ibf_loader const &) = delete;
+    lazy_ibf_loader(lazy_ibf_loader &&) = delete;
+    lazy_ibf_loader & operator=(lazy_ibf_loader &&) = delete;
+    ~lazy_ibf_loader() = default;
+
+    /*!\brief Constructs the loader.
+     * \param index_file The index file.
+     * \param ibf_offsets The offsets of the IBFs in the index file.
+     * \param end_offset The offset where the last IBF ends.
+     * \param memory_limit The maximum number of bytes of loaded IBFs. `0` means no limit.
+     */
+    lazy_ibf_loader(std::filesystem::path index_file,
+                    std::vector<uint64_t> ibf_offsets,
+                    uint64_t const end_offset,
+                    uint64_t const memory_limit = 0u) :
+        index_file{std::move(index_file)},
+        ibf_offsets{std::move(ibf_offsets)},
+        memory_limit{memory_limit},
+        entries(this->ibf_offsets.size()),
+        loading(std::make_unique<std::mutex[]>(this->ibf_offsets.size()))
+    {
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            uint64_t const next_offset = i + 1u < entries.size() ? this->ibf_offsets[i + 1u] : end_offset;
+            entries[i].bytes = next_offset - this->ibf_offsets[i];
+        }
+    }
+
+    //!\brief Returns the IBF with the given ID. Loads it if it is not loaded.
+    ibf_pointer operator[](size_t const ibf_idx) const
+    {
+        if (ibf_pointer ibf = lookup(ibf_idx))
+            return ibf;
+
+        // Only one thread loads a specific IBF. Other threads wait and then find it loaded.
+        std::lock_guard loading_guard{loading[ibf_idx]};
+        if (ibf_pointer ibf = lookup(ibf_idx))
+            return ibf;
+
+        ibf_pointer ibf = load(ibf_idx);
+        insert(ibf_idx, ibf);
+        return ibf;
+    }
+
+    size_t size() const noexcept
+    {
+        return entries.size();
+    }
+
+    lazy_ibf_statistics statistics() const
+    {
+        return {hits.load(), misses.load(), evictions.load()};
+    }
+
+private:
+    struct entry
+    {
+        ibf_pointer ibf{};
+        //!\brief Set after `ibf` is assigned. Without a memory limit, `ibf` does not change afterwards.
+        std::atomic<bool> loaded{false};
+        std::list<size_t>::iterator lru_position{};
+        uint64_t bytes{};
+    };
+
+    std::filesystem::path index_file{};
+    std::vector<uint64_t> ibf_offsets{};
+    uint64_t memory_limit{};
+
+    //!\brief Guards entries, lru, and loaded_bytes. Not needed to read a loaded IBF without a memory limit.
+    mutable std::mutex mutex{};
+    mutable std::vector<entry> entries{};
+    //!\brief IDs of the loaded IBFs, the most recently used one first. Only used with a memory limit.
+    mutable std::list<size_t> lru{};
+    mutable uint64_t loaded_bytes{};
+    mutable std::atomic<uint64_t> hits{};
+    mutable std::atomic<uint64_t> misses{};
+    mutable std::atomic<uint64_t> evictions{};
+    std::unique_ptr<std::mutex[]> loading{};
+
+    ibf_pointer lookup(size_t const ibf_idx) const
+    {
+        entry & current = entries[ibf_idx];
+
+        if (memory_limit == 0u)
+        {
+            if (!current.loaded.load(std::memory_order_acquire))
+                return {};
+
+            hits.fetch_add(1u, std::memory_order_relaxed);
+            return current.ibf;
+        }
+
+        std::lock_guard guard{mutex};
+        if (!current.ibf)
+            return {};
+
+        hits.fetch_add(1u, std::memory_order_relaxed);
+        lru.splice(lru.begin(), lru, current.lru_position);
+        return current.ibf;
+    }
+
+    void insert(size_t const ibf_idx, ibf_pointer const & ibf) const
+    {
+        std::lock_guard guard{mutex};
+        entry & current = entries[ibf_idx];
+        misses.fetch_add(1u, std::memory_order_relaxed);
+        current.ibf = ibf;
+        current.loaded.store(true, std::memory_order_release);
+
+        if (memory_limit == 0u)
+            return;
+
+        current.lru_position = lru.insert(lru.begin(), ibf_idx);
+        loaded_bytes += current.bytes;
+
+        // The IBF that was just loaded is never evicted.
+        while (loaded_bytes > memory_limit && lru.size() > 1u)
+        {
+            entry & evicted = entries[lru.back()];
+            lru.pop_back();
+            evicted.ibf.reset();
+            evicted.loaded.store(false, std::memory_order_relaxed);
+            loaded_bytes -= evicted.bytes;
+            evictions.fetch_add(1u, std::memory_order_relaxed);
+        }
+    }
+
+    //!\brief Loads an IBF and verifies the checksums of all segments that contain some of its bytes.
+    ibf_pointer load(size_t const ibf_idx) const
+    {
+        chunked_index_input_buffer buffer{index_file, 1u};
+        std::istream is{std::addressof(buffer)};
+        // Rethrows checksum mismatches instead of only setting the badbit.
+        is.exceptions(std::ios::badbit);
+        is.seekg(ibf_offsets[ibf_idx]);
+        if (!is)
+            throw std::runtime_error{"Could not read IBF " + std::to_string(ibf_idx) + " from " + index_file.string()};
+
+        auto ibf = std::make_shared<ibf_t>();
+        {
+            cereal::BinaryInputArchive iarchive{is};
+            iarchive(*ibf);
+        }
+        buffer.finish();
+        advise_huge_pages(*ibf);
+        return ibf;
+    }
+};
+
+} // namespace raptor
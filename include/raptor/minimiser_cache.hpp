@@ -0,0 +1,394 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::minimiser_cache.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if __has_include(<unistd.h>)
+#    include <unistd.h>
+#else
+#    include <random>
+#endif
+
+#include <seqan3/search/kmer_index/shape.hpp>
+
+#include <raptor/adjust_seed.hpp>
+#include <raptor/build/hibf/sorted_kmers.hpp>
+#include <raptor/radix_sort.hpp>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+/*!\brief Identifies the minimisers of a file.
+ * \details The key changes whenever the file is modified or different k-mer parameters are used.
+ */
+inline std::string
+file_cache_key(std::filesystem::path const & file, seqan3::shape const & shape, uint32_t const window_size)
+{
+    std::ostringstream key{};
+    key << std::filesystem::absolute(file).string() << '\t' << std::filesystem::file_size(file) << '\t'
+        << std::filesystem::last_write_time(file).time_since_epoch().count() << '\t' << shape.to_ulong() << '\t'
+        << window_size << '\t' << adjust_seed(shape.count());
+    return key.str();
+}
+
+//!\brief The file in the cache directory that belongs to the given key.
+inline std::filesystem::path file_cache_path(std::filesystem::path const & cache_directory,
+                                             std::string const & key,
+                                             std::string const & extension)
+{
+    // FNV-1a
+    uint64_t hash{0xCBF29CE484222325ULL};
+    for (char const c : key)
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ULL;
+
+    std::ostringstream file_name{};
+    file_name << std::hex << hash << extension;
+    return cache_directory / file_name.str();
+}
+
+//!\brief The ID of the calling process. Thread IDs are only unique within a process.
+inline uint64_t process_id()
+{
+#if __has_include(<unistd.h>)
+    return static_cast<uint64_t>(::getpid());
+#else
+    static uint64_t const id = std::random_device{}();
+    return id;
+#endif
+}
+
+/*!\brief Returns a file name that is unique to the calling thread and process. Renaming it to `path` is atomic.
+ * \details Several processes may write to the same cache directory at the same time.
+ */
+inline std::filesystem::path file_cache_tmp_path(std::filesystem::path const & path)
+{
+    std::filesystem::path tmp_path{path};
+    tmp_path += '.' + std::to_string(process_id()) + '.'
+              + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    return tmp_path;
+}
+
+} // namespace detail
+
+/*!\brief Stores the distinct minimisers of sequence files on disk.
+ * \details
+ * Each entry is identified by the absolute path, size, and modification time of the file, and the shape, window size
+ * and seed used to compute the minimisers. Entries of modified files are not used and overwritten.
+ *
+ * The format of an entry is:
+ * ```
+ * [key]\n[number of minimisers (uint64_t)][sorted minimisers (uint64_t)]
+ * ```
+ * Entries are built by raptor::minimiser_cache::writer and read in spans, hence neither needs memory proportional to
+ * the number of minimisers of a file.
+ */
+class minimiser_cache
+{
+public:
+    class writer;
+
+    minimiser_cache() = default;
+    minimiser_cache(minimiser_cache const &) = default;
+    minimiser_cache(minimiser_cache &&) = default;
+    minimiser_cache & operator=(minimiser_cache const &) = default;
+    minimiser_cache & operator=(minimiser_cache &&) = default;
+    ~minimiser_cache() = default;
+
+    explicit minimiser_cache(std::filesystem::path directory, seqan3::shape const shape, uint32_t const window_size) :
+        directory{std::move(directory)},
+        shape{shape},
+        window_size{window_size}
+    {
+        std::filesystem::create_directories(this->directory);
+    }
+
+    /*!\brief Calls `callback` with spans (`std::span<uint64_t const>`) of the distinct minimisers of the file, in
+     *        ascending order.
+     * \details Returns `false` if there is no valid entry for the file. `callback` is not called in this case.
+     */
+    template <typename callback_t>
+    bool for_each_span(std::string const & filename, callback_t && callback) const
+    {
+        std::string const key = detail::file_cache_key(filename, shape, window_size);
+        std::filesystem::path const path = detail::file_cache_path(directory, key, extension);
+        std::ifstream file{path, std::ios::binary};
+        std::string stored_key{};
+
+        // The stored key guards against hash collisions of the file name.
+        if (!std::getline(file, stored_key) || stored_key != key)
+            return false;
+
+        uint64_t count{};
+        if (!file.read(reinterpret_cast<char *>(&count), sizeof(count)))
+            return false;
+
+        // Entries are renamed into place once complete. A size mismatch means the entry is damaged.
+        std::error_code ec{};
+        uint64_t const file_size = std::filesystem::file_size(path, ec);
+        if (ec || file_size != static_cast<uint64_t>(file.tellg()) + count * sizeof(uint64_t))
+            return false;
+
+        std::vector<uint64_t> buffer(std::min<uint64_t>(count, span_size));
+        while (count > 0u)
+        {
+            size_t const size = std::min<uint64_t>(count, span_size);
+            if (!file.read(reinterpret_cast<char *>(buffer.data()), size * sizeof(uint64_t)))
+                throw std::runtime_error{"Could not read the minimiser cache entry " + path.string()};
+            callback(std::span<uint64_t const>{buffer.data(), size});
+            count -= size;
+        }
+
+        return true;
+    }
+
+    //!\brief Reads only the number of minimisers. Returns `false` if there is no valid entry for the file.
+    bool count(std::string const & filename, size_t & count) const
+    {
+        std::string const key = detail::file_cache_key(filename, shape, window_size);
+        std::ifstream file{detail::file_cache_path(directory, key, extension), std::ios::binary};
+        std::string stored_key{};
+
+        if (!std::getline(file, stored_key) || stored_key != key)
+            return false;
+
+        uint64_t stored_count{};
+        if (!file.read(reinterpret_cast<char *>(&stored_count), sizeof(stored_count)))
+            return false;
+
+        count = stored_count;
+        return true;
+    }
+
+private:
+    static inline std::string const extension{".minimisers"};
+    // 512 KiB
+    static constexpr size_t span_size{1ULL << 16};
+
+    std::filesystem::path directory{};
+    seqan3::shape shape{};
+    uint32_t window_size{};
+};
+
+/*!\brief Builds the entry of a file from its minimisers, which may contain duplicates and can be given in any order.
+ * \details
+ * Minimisers are collected in a buffer. A full buffer is radix-sorted and deduplicated into a sorted run, which is
+ * written to a temporary file next to the entry. raptor::minimiser_cache::writer::commit merges the runs into the
+ * entry. Hence, the memory is bounded by the buffer capacity, independent of the size of the file.
+ * raptor::minimiser_cache::writer::insert may be called concurrently. If `commit` is not called, e.g., because reading
+ * the file failed, no entry is stored. The temporary files are removed in any case.
+ */
+class minimiser_cache::writer
+{
+public:
+    // 32 MiB
+    static constexpr size_t default_buffer_capacity{1ULL << 22};
+
+    writer() = delete;
+    writer(writer const &) = delete;
+    writer & operator=(writer const &) = delete;
+    writer(writer &&) = delete;
+    writer & operator=(writer &&) = delete;
+
+    ~writer()
+    {
+        std::error_code ec{};
+        for (auto const & run : created_runs)
+            std::filesystem::remove(run, ec);
+    }
+
+    writer(minimiser_cache const & cache,
+           std::string const & filename,
+           size_t const buffer_capacity = default_buffer_capacity) :
+        key{detail::file_cache_key(filename, cache.shape, cache.window_size)},
+        path{detail::file_cache_path(cache.directory, key, extension)},
+        buffer_capacity{std::max<size_t>(buffer_capacity, 1u)}
+    {}
+
+    //!\brief Adds minimisers. Thread-safe; sorting a full buffer does not block other threads.
+    void insert(std::span<uint64_t const> const values)
+    {
+        std::vector<uint64_t> full_buffer{};
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            buffer.insert(buffer.end(), values.begin(), values.end());
+            if (buffer.size() < buffer_capacity)
+                return;
+            full_buffer.swap(buffer);
+        }
+
+        sort_and_deduplicate(full_buffer);
+        std::filesystem::path run = new_run();
+        {
+            std::ofstream file{run, std::ios::binary};
+            file.write(reinterpret_cast<char const *>(full_buffer.data()), full_buffer.size() * sizeof(uint64_t));
+            if (!file)
+                throw std::runtime_error{"Could not write " + run.string()};
+        }
+        full_buffer = std::vector<uint64_t>{};
+
+        std::vector<std::filesystem::path> runs_to_merge{};
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            file_runs.push_back(std::move(run));
+            // Bounds the number of files that are read at the same time.
+            if (file_runs.size() > max_file_runs)
+                runs_to_merge.swap(file_runs);
+        }
+
+        if (!runs_to_merge.empty())
+        {
+            std::filesystem::path merged_run = new_run();
+            {
+                std::ofstream file{merged_run, std::ios::binary};
+                merge(runs_to_merge, {}, file);
+            }
+            std::lock_guard<std::mutex> guard{mutex};
+            file_runs.push_back(std::move(merged_run));
+        }
+    }
+
+    //!\brief Stores the entry. Must be called after all minimisers of the file were inserted.
+    void commit()
+    {
+        sort_and_deduplicate(buffer);
+
+        // Several threads may process the same file.
+        std::filesystem::path const tmp_path = detail::file_cache_tmp_path(path);
+        {
+            std::ofstream file{tmp_path, std::ios::binary};
+            file << key << '\n';
+            std::streampos const count_position = file.tellp();
+            uint64_t count{};
+            file.write(reinterpret_cast<char const *>(&count), sizeof(count));
+
+            count = merge(file_runs, buffer, file);
+
+            file.seekp(count_position);
+            file.write(reinterpret_cast<char const *>(&count), sizeof(count));
+            if (!file)
+                throw std::runtime_error{"Could not write " + tmp_path.string()};
+        }
+        std::filesystem::rename(tmp_path, path);
+
+        file_runs.clear();
+        buffer = std::vector<uint64_t>{};
+    }
+
+private:
+    // More file runs are merged into one file.
+    static constexpr size_t max_file_runs{64u};
+
+    std::string key{};
+    std::filesystem::path path{};
+    size_t buffer_capacity{default_buffer_capacity};
+
+    std::mutex mutex{};
+    std::vector<uint64_t> buffer{};
+    std::vector<std::filesystem::path> file_runs{};
+    // All run files, including merged ones. Removed by the destructor.
+    std::vector<std::filesystem::path> created_runs{};
+
+    static void sort_and_deduplicate(std::vector<uint64_t> & values)
+    {
+        detail::radix_sort(values, 1u);
+        auto const duplicates = std::ranges::unique(values);
+        values.erase(duplicates.begin(), duplicates.end());
+    }
+
+    std::filesystem::path new_run()
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        std::filesystem::path run = detail::file_cache_tmp_path(path);
+        run += ".run" + std::to_string(created_runs.size());
+        created_runs.push_back(run);
+        return run;
+    }
+
+    /*!\brief Writes the distinct values of the runs and of the sorted, distinct `values` to `file`, in ascending order.
+     * \details Returns the number of written values. The run files are removed.
+     */
+    static size_t merge(std::vector<std::filesystem::path> const & runs,
+                        std::vector<uint64_t> const & values,
+                        std::ofstream & file)
+    {
+        std::vector<hibf::detail::kmer_run_reader> readers{};
+        readers.reserve(runs.size() + 1u);
+        for (auto const & run : runs)
+            readers.emplace_back(run);
+        readers.emplace_back(values);
+
+        std::vector<uint64_t> output{};
+        output.reserve(span_size);
+        size_t count{};
+        auto flush = [&]()
+        {
+            file.write(reinterpret_cast<char const *>(output.data()), output.size() * sizeof(uint64_t));
+            count += output.size();
+            output.clear();
+        };
+
+        // (value, reader)
+        using cursor_t = std::pair<uint64_t, size_t>;
+        std::priority_queue<cursor_t, std::vector<cursor_t>, std::greater<cursor_t>> heap{};
+        uint64_t value{};
+
+        for (size_t i = 0; i < readers.size(); ++i)
+            if (readers[i].next(value))
+                heap.emplace(value, i);
+
+        bool first{true};
+        uint64_t last{};
+
+        while (!heap.empty())
+        {
+            auto const [current, reader] = heap.top();
+            heap.pop();
+
+            if (first || current != last)
+            {
+                output.push_back(current);
+                if (output.size() == span_size)
+                    flush();
+                last = current;
+                first = false;
+            }
+
+            if (readers[reader].next(value))
+                heap.emplace(value, reader);
+        }
+        flush();
+
+        std::error_code ec{};
+        for (auto const & run : runs)
+            std::filesystem::remove(run, ec);
+
+        return count;
+    }
+};
+
+} // namespace raptor
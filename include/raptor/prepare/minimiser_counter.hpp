@@ -0,0 +1,262 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::minimiser_counter.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <span>
+#include <vector>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+//!\brief Sorted, distinct minimisers and how often they occur.
+struct counted_run
+{
+    std::vector<uint64_t> values{};
+    std::vector<uint8_t> counts{};
+
+    static constexpr size_t bytes_per_entry{sizeof(uint64_t) + sizeof(uint8_t)};
+
+    size_t bytes() const noexcept
+    {
+        return values.size() * bytes_per_entry;
+    }
+};
+
+//!\brief Reads a raptor::detail::counted_run, either from memory or from a file.
+class counted_run_reader
+{
+public:
+    explicit counted_run_reader(counted_run const & run) :
+        values{run.values.data()},
+        counts{run.counts.data()},
+        end{run.values.data() + run.values.size()}
+    {}
+
+    explicit counted_run_reader(std::filesystem::path const & path) :
+        stream{std::make_unique<std::ifstream>(path, std::ios::binary)},
+        buffer(buffer_size * counted_run::bytes_per_entry)
+    {
+        refill();
+    }
+
+    //!\brief Returns `false` if the run is exhausted.
+    bool next(uint64_t & value, uint8_t & count)
+    {
+        if (stream)
+        {
+            if (position == buffer_end && !refill())
+                return false;
+
+            std::memcpy(&value, buffer.data() + position, sizeof(uint64_t));
+            count = static_cast<uint8_t>(buffer[position + sizeof(uint64_t)]);
+            position += counted_run::bytes_per_entry;
+            return true;
+        }
+
+        if (values == end)
+            return false;
+
+        value = *values++;
+        count = *counts++;
+        return true;
+    }
+
+private:
+    static constexpr size_t buffer_size{1ULL << 15}; // 288 KiB
+
+    uint64_t const * values{nullptr};
+    uint8_t const * counts{nullptr};
+    uint64_t const * end{nullptr};
+    std::unique_ptr<std::ifstream> stream{};
+    std::vector<char> buffer{};
+    size_t position{};
+    size_t buffer_end{};
+
+    bool refill()
+    {
+        stream->read(buffer.data(), buffer.size());
+        position = 0u;
+        buffer_end = stream->gcount() - stream->gcount() % counted_run::bytes_per_entry;
+        return buffer_end != 0u;
+    }
+};
+
+} // namespace detail
+
+/*!\brief Counts how often each minimiser occurs, saturating at 254.
+ * \details
+ * Minimisers are collected in a buffer. A full buffer is radix-sorted and run-length counted into a sorted run.
+ * Runs are merged when they are read via raptor::minimiser_counter::for_each.
+ *
+ * With a memory limit, half of the limit is used for the buffer (and the buffer of the radix sort), the other half for
+ * the runs. Runs exceeding the limit are merged and written to temporary files in a new directory
+ * (raptor::detail::create_temporary_directory). Only this directory is removed on destruction. Without a memory limit,
+ * nothing is written to disk.
+ *
+ * A counter is not thread-safe. To count with several threads, each thread uses its own counter, and the counts are
+ * combined by the static raptor::minimiser_counter::for_each.
+ */
+class minimiser_counter
+{
+public:
+    minimiser_counter() = default;
+    minimiser_counter(minimiser_counter const &) = delete;
+    minimiser_counter & operator=(minimiser_counter const &) = delete;
+    minimiser_counter(minimiser_counter &&) = delete;
+    minimiser_counter & operator=(minimiser_counter &&) = delete;
+    ~minimiser_counter();
+
+    /*!\brief Constructs a counter with a memory limit.
+     * \param memory_limit The memory limit in bytes. `0` means no limit.
+     * \param tmp_prefix The prefix of the directory for temporary files. Created when the first run is written.
+     */
+    minimiser_counter(size_t const memory_limit, std::filesystem::path tmp_prefix);
+
+    void insert(uint64_t const value)
+    {
+        if (buffer.size() == buffer_capacity)
+            flush();
+        buffer.push_back(value);
+    }
+
+    //!\brief Calls `callback` for each minimiser that occurs at least `cutoff` times, in ascending order.
+    template <typename callback_t>
+    void for_each(uint8_t const cutoff, callback_t && callback)
+    {
+        minimiser_counter * const self{this};
+        for_each(std::span<minimiser_counter * const>{&self, 1u}, cutoff, callback);
+    }
+
+    /*!\brief Calls `callback` for each minimiser that occurs at least `cutoff` times in all `counters` together, in
+     *        ascending order.
+     */
+    template <typename callback_t>
+    static void
+    for_each(std::span<minimiser_counter * const> const counters, uint8_t const cutoff, callback_t && callback)
+    {
+        size_t files{};
+        for (minimiser_counter * const counter : counters)
+        {
+            counter->flush();
+            files += counter->file_runs.size();
+        }
+
+        // Bounds the number of files that are read at the same time.
+        if (files > max_file_runs)
+            for (minimiser_counter * const counter : counters)
+                if (!counter->file_runs.empty())
+                    counter->spill(true);
+
+        merge_runs(std::span<minimiser_counter const * const>{counters.data(), counters.size()},
+                   [&](uint64_t const value, uint8_t const count)
+                   {
+                       if (count >= cutoff)
+                           callback(value);
+                   });
+    }
+
+private:
+    // Without a memory limit: 32 MiB buffer.
+    static constexpr size_t default_buffer_capacity{1ULL << 22};
+    static constexpr size_t min_buffer_capacity{1ULL << 10};
+    // More memory runs are merged into one run.
+    static constexpr size_t max_memory_runs{16u};
+    // More file runs are merged into one file.
+    static constexpr size_t max_file_runs{64u};
+    static constexpr uint8_t max_count{254u};
+
+    size_t buffer_capacity{default_buffer_capacity};
+    size_t run_memory_limit{};
+    std::filesystem::path prefix{};
+    std::filesystem::path directory{};
+    size_t file_counter{};
+
+    std::vector<uint64_t> buffer{};
+    std::vector<detail::counted_run> memory_runs{};
+    std::vector<std::filesystem::path> file_runs{};
+    size_t memory_bytes{};
+
+    //!\brief Sorts and counts the buffer into a new run.
+    void flush();
+
+    //!\brief Merges all memory runs into one memory run.
+    void merge_memory_runs();
+
+    /*!\brief Merges the memory runs into one file.
+     * \details The file runs are merged as well if there are too many of them or if `merge_files` is `true`.
+     */
+    void spill(bool const merge_files = false);
+
+    //!\brief Calls `callback` for each minimiser and its total count (saturated) in ascending order.
+    template <typename callback_t>
+    void merge_runs(callback_t && callback) const
+    {
+        minimiser_counter const * const self{this};
+        merge_runs(std::span<minimiser_counter const * const>{&self, 1u}, callback);
+    }
+
+    //!\brief Calls `callback` for each minimiser and its total count (saturated) in all `counters` in ascending order.
+    template <typename callback_t>
+    static void merge_runs(std::span<minimiser_counter const * const> const counters, callback_t && callback)
+    {
+        std::vector<detail::counted_run_reader> readers{};
+        for (minimiser_counter const * const counter : counters)
+        {
+            for (auto const & run : counter->memory_runs)
+                readers.emplace_back(run);
+            for (auto const & path : counter->file_runs)
+                readers.emplace_back(path);
+        }
+
+        // (value, reader)
+        using cursor_t = std::pair<uint64_t, size_t>;
+        std::priority_queue<cursor_t, std::vector<cursor_t>, std::greater<cursor_t>> heap{};
+        std::vector<uint8_t> counts(readers.size());
+        uint64_t value{};
+
+        for (size_t i = 0; i < readers.size(); ++i)
+            if (readers[i].next(value, counts[i]))
+                heap.emplace(value, i);
+
+        while (!heap.empty())
+        {
+            uint64_t const current = heap.top().first;
+            uint16_t total{};
+
+            do
+            {
+                size_t const reader = heap.top().second;
+                heap.pop();
+                total = std::min<uint16_t>(total + counts[reader], max_count);
+                if (readers[reader].next(value, counts[reader]))
+                    heap.emplace(value, reader);
+            }
+            while (!heap.empty() && heap.top().first == current);
+
+            callback(current, static_cast<uint8_t>(total));
+        }
+    }
+};
+
+} // namespace raptor
@@ -0,0 +1,143 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::occurrence_filter.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace raptor
+{
+
+/*!\brief Estimates how often a minimiser occurs, up to raptor::occurrence_filter::max_count.
+ * \details
+ * A blocked count-min sketch with 2-bit counters. Each minimiser maps to three counters in one 64-byte block, i.e.,
+ * one cache line. The estimate is the minimum of the three counters and is never smaller than the true count (up to
+ * `max_count`). Counters are updated conservatively: only the counters that equal the minimum are incremented.
+ *
+ * raptor::compute_minimiser uses the filter to only count minimisers that may reach the cutoff. Most minimisers of
+ * raw reads are sequencing errors and occur once.
+ *
+ * raptor::occurrence_filter::concurrent_insert may be called by several threads. The conservative update reads and
+ * writes three counters that may lie in different words. Hence, each shard of raptor::occurrence_filter::shard_size
+ * blocks has a one-byte spin lock.
+ */
+class occurrence_filter
+{
+public:
+    static constexpr uint8_t max_count{3u};
+    //!\brief The number of blocks that share a lock in raptor::occurrence_filter::concurrent_insert.
+    static constexpr size_t shard_size{64u};
+
+    occurrence_filter() = default;
+    occurrence_filter(occurrence_filter const &) = default;
+    occurrence_filter & operator=(occurrence_filter const &) = default;
+    occurrence_filter(occurrence_filter &&) = default;
+    occurrence_filter & operator=(occurrence_filter &&) = default;
+    ~occurrence_filter() = default;
+
+    //!\brief Constructs a filter that uses about `bytes` bytes, but at least one block.
+    explicit occurrence_filter(size_t const bytes) :
+        blocks(std::max<size_t>(bytes / sizeof(block_t), 1u)),
+        locks((blocks.size() + shard_size - 1u) / shard_size)
+    {}
+
+    void insert(uint64_t const value) noexcept
+    {
+        uint64_t const hash = mix(value);
+        update(blocks[block_index(hash)], counters_of(hash));
+    }
+
+    //!\brief Same as raptor::occurrence_filter::insert, but may be called concurrently.
+    void concurrent_insert(uint64_t const value) noexcept
+    {
+        uint64_t const hash = mix(value);
+        size_t const index = block_index(hash);
+        std::atomic_ref<uint8_t> const lock{locks[index / shard_size]};
+
+        while (lock.exchange(1u, std::memory_order_acquire) != 0u)
+            while (lock.load(std::memory_order_relaxed) != 0u)
+                ;
+
+        update(blocks[index], counters_of(hash));
+        lock.store(0u, std::memory_order_release);
+    }
+
+    //!\brief Returns the estimated number of occurrences.
+    uint8_t count(uint64_t const value) const noexcept
+    {
+        uint64_t const hash = mix(value);
+        return estimate(blocks[block_index(hash)], counters_of(hash));
+    }
+
+    size_t size_in_bytes() const noexcept
+    {
+        return blocks.size() * sizeof(block_t);
+    }
+
+private:
+    // 256 2-bit counters.
+    struct alignas(64) block_t : std::array<uint64_t, 8>
+    {};
+
+    using counters_t = std::array<uint8_t, 3>;
+
+    std::vector<block_t> blocks{};
+    std::vector<uint8_t> locks{};
+
+    // Minimisers are k-mers XORed with a seed. The finaliser of splitmix64 spreads them over the blocks.
+    static constexpr uint64_t mix(uint64_t value) noexcept
+    {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    static constexpr uint8_t get(block_t const & block, uint8_t const counter) noexcept
+    {
+        return (block[counter / 32u] >> (counter % 32u * 2u)) & 0b11u;
+    }
+
+    static constexpr uint8_t estimate(block_t const & block, counters_t const & counters) noexcept
+    {
+        return std::min({get(block, counters[0]), get(block, counters[1]), get(block, counters[2])});
+    }
+
+    //!\brief Increments the counters that equal the minimum.
+    static constexpr void update(block_t & block, counters_t const & counters) noexcept
+    {
+        uint8_t const minimum = estimate(block, counters);
+
+        if (minimum == max_count)
+            return;
+
+        for (uint8_t const counter : counters)
+            if (get(block, counter) == minimum)
+                block[counter / 32u] += 1ULL << (counter % 32u * 2u);
+    }
+
+    //!\brief Maps the upper 32 bits of the hash to [0, blocks.size()).
+    size_t block_index(uint64_t const hash) const noexcept
+    {
+        return ((hash >> 32) * blocks.size()) >> 32;
+    }
+
+    static constexpr counters_t counters_of(uint64_t const hash) noexcept
+    {
+        return {static_cast<uint8_t>(hash), static_cast<uint8_t>(hash >> 8), static_cast<uint8_t>(hash >> 16)};
+    }
+};
+
+} // namespace raptor
@@ -0,0 +1,111 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Provides raptor::detail::radix_sort.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <raptor/search/do_parallel.hpp>
+
+namespace raptor::detail
+{
+
+// Below this size, std::sort is faster than a radix sort.
+inline constexpr size_t radix_sort_threshold{1ULL << 16};
+// Each thread processes at least this many values.
+inline constexpr size_t radix_sort_min_block_size{1ULL << 20};
+
+//!\brief Sorts the values via a (parallel) LSD radix sort. Small inputs are sorted with std::sort.
+inline void radix_sort(std::vector<uint64_t> & values, size_t const threads)
+{
+    using histogram_t = std::array<size_t, 256>;
+
+    size_t const size = values.size();
+
+    if (size < radix_sort_threshold)
+    {
+        std::ranges::sort(values);
+        return;
+    }
+
+    size_t const blocks = std::clamp<size_t>(size / radix_sort_min_block_size, 1u, threads);
+    size_t const block_size = (size + blocks - 1u) / blocks;
+
+    std::vector<uint64_t> buffer(size);
+    std::vector<histogram_t> histograms(blocks);
+    uint64_t * source = values.data();
+    uint64_t * target = buffer.data();
+
+    // do_parallel calls the worker with a range of blocks.
+    auto for_each_block = [&](auto && worker)
+    {
+        do_parallel(
+            [&](size_t const start, size_t const end)
+            {
+                for (size_t block = start; block < end; ++block)
+                    worker(block, block * block_size, std::min(size, (block + 1u) * block_size));
+            },
+            blocks,
+            blocks);
+    };
+
+    for (size_t shift = 0; shift < 64u; shift += 8u)
+    {
+        for_each_block(
+            [&](size_t const block, size_t const begin, size_t const end)
+            {
+                histogram_t & histogram = histograms[block];
+                histogram.fill(0u);
+                for (size_t i = begin; i < end; ++i)
+                    ++histogram[(source[i] >> shift) & 0xFF];
+            });
+
+        // Skip the pass if all values have the same digit.
+        size_t const first_digit = (source[0] >> shift) & 0xFF;
+        size_t digit_total{};
+        for (histogram_t const & histogram : histograms)
+            digit_total += histogram[first_digit];
+        if (digit_total == size)
+            continue;
+
+        // Turn the counts into the target offset of each (block, digit).
+        size_t offset{};
+        for (size_t digit = 0; digit < 256u; ++digit)
+        {
+            for (histogram_t & histogram : histograms)
+            {
+                size_t const count = histogram[digit];
+                histogram[digit] = offset;
+                offset += count;
+            }
+        }
+
+        for_each_block(
+            [&](size_t const block, size_t const begin, size_t const end)
+            {
+                histogram_t & offsets = histograms[block];
+                for (size_t i = begin; i < end; ++i)
+                    target[offsets[(source[i] >> shift) & 0xFF]++] = source[i];
+            });
+
+        std::swap(source, target);
+    }
+
+    if (source != values.data())
+        values.swap(buffer);
+}
+
+} // namespace raptor::detail
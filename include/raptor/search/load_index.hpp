@@ -13,9 +13,14 @@
 #pragma once
 
 #include <chrono>
+#include <istream>
+#include <memory>
 
 #include <raptor/argument_parsing/search_arguments.hpp>
+#include <raptor/huge_pages.hpp>
 #include <raptor/index.hpp>
+#include <raptor/io/chunked_index_buffer.hpp>
+#include <raptor/io/hibf_offsets.hpp>
 
 namespace raptor
 {
@@ -24,12 +29,54 @@ namespace detail
 {
 
 template <typename index_t>
-void load_index(index_t & index, std::filesystem::path const & path)
+void load_index(index_t & index, std::filesystem::path const & path, size_t const threads = 1u)
 {
-    std::ifstream is{path, std::ios::binary};
+    chunked_index_input_buffer buffer{path, threads};
+    std::istream is{std::addressof(buffer)};
     cereal::BinaryInputArchive iarchive{is};
 
     iarchive(index);
+    advise_huge_pages(index.ibf());
+}
+
+/*!\brief Loads the parameters, the bookkeeping, and the root IBF of an HIBF. The other IBFs are loaded on first access.
+ * \details
+ * Indices without raptor::hibf_offsets are loaded completely. So are indices without checksums, since the IBFs are
+ * only read lazily if their checksums can be verified, see raptor::chunked_index_input_buffer.
+ * If `memory_limit` (in bytes) is not 0, the least recently used IBFs are evicted when the limit is exceeded.
+ */
+template <typename index_t>
+void load_index_lazily(index_t & index,
+                       std::filesystem::path const & path,
+                       size_t const threads = 1u,
+                       uint64_t const memory_limit = 0u)
+{
+    hibf_offsets offsets{};
+    chunked_index_input_buffer buffer{path, threads};
+    if (!buffer.has_checksums() || !offsets.read(path))
+        return load_index(index, path, threads);
+
+    std::istream is{std::addressof(buffer)};
+    // Rethrows checksum mismatches instead of only setting the badbit.
+    is.exceptions(std::ios::badbit);
+    auto & hibf = index.ibf();
+    using ibf_t = typename std::remove_cvref_t<decltype(hibf)>::ibf_t;
+    {
+        cereal::BinaryInputArchive iarchive{is};
+        index.load_parameters(iarchive);
+        is.seekg(offsets.bookkeeping_offset);
+        hibf.serialize_bookkeeping(iarchive, index.parsed_version() >= 3u);
+    }
+    buffer.finish();
+    hibf.ibf_vector.clear();
+    advise_huge_pages(hibf);
+    hibf.lazy_ibfs = std::make_shared<lazy_ibf_loader<ibf_t>>(path,
+                                                               std::move(offsets.ibf_offsets),
+                                                               offsets.bookkeeping_offset,
+                                                               memory_limit);
+
+    // Every query visits the root.
+    [[maybe_unused]] auto const root = hibf.ibf(0);
 }
 
 } // namespace detail
@@ -40,7 +87,7 @@ void load_index(index_t & index, search_arguments const & arguments, size_t cons
     std::filesystem::path index_file{arguments.index_file};
     index_file += "_" + std::to_string(part);
     arguments.load_index_timer.start();
-    detail::load_index(index, index_file);
+    detail::load_index(index, index_file, arguments.threads);
     arguments.load_index_timer.stop();
 }
 
@@ -48,7 +95,17 @@ template <typename index_t>
 void load_index(index_t & index, search_arguments const & arguments)
 {
     arguments.load_index_timer.start();
-    detail::load_index(index, arguments.index_file);
+    if constexpr (index_structure::is_hibf<std::remove_cvref_t<decltype(index.ibf())>>)
+    {
+        if (arguments.lazy_load)
+            detail::load_index_lazily(index, arguments.index_file, arguments.threads, arguments.cache_limit << 20);
+        else
+            detail::load_index(index, arguments.index_file, arguments.threads);
+    }
+    else
+    {
+        detail::load_index(index, arguments.index_file, arguments.threads);
+    }
     arguments.load_index_timer.stop();
 }
 
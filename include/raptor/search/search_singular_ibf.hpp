@@ -15,6 +15,7 @@
 #include <seqan3/search/views/minimiser_hash.hpp>
 
 #include <raptor/adjust_seed.hpp>
+#include <raptor/counting_kernel.hpp>
 #include <raptor/dna4_traits.hpp>
 #include <raptor/search/do_parallel.hpp>
 #include <raptor/search/load_index.hpp>
@@ -45,19 +46,14 @@ void search_singular_ibf(search_arguments const & arguments, index_t && index)
 
     raptor::threshold::threshold const thresholder{arguments.make_threshold_parameters()};
 
-    auto worker = [&](size_t const start, size_t const end)
+    // `make_counter` returns a counting agent for the IBF, or a membership agent for the HIBF.
+    auto worker = [&](size_t const start, size_t const end, auto && make_counter)
     {
         timer<concurrent::no> local_compute_minimiser_timer{};
         timer<concurrent::no> local_query_ibf_timer{};
         timer<concurrent::no> local_generate_results_timer{};
 
-        auto counter = [&index]()
-        {
-            if constexpr (is_ibf)
-                return index.ibf().template counting_agent<uint16_t>();
-            else
-                return index.ibf().membership_agent();
-        }();
+        auto counter = make_counter();
         std::string result_string{};
         std::vector<uint64_t> minimiser;
 
@@ -86,9 +82,10 @@ void search_singular_ibf(search_arguments const & arguments, index_t && index)
                 local_query_ibf_timer.stop();
                 size_t current_bin{0};
                 local_generate_results_timer.start();
-                for (auto && count : result)
+                // Bins reserved or emptied by `raptor update` do not belong to any user bin.
+                for (auto && count : result | std::views::take(arguments.bin_path.size()))
                 {
-                    if (count >= threshold)
+                    if (count >= threshold && !arguments.bin_path[current_bin].empty())
                     {
                         result_string += std::to_string(current_bin);
                         result_string += ',';
@@ -126,9 +123,17 @@ void search_singular_ibf(search_arguments const & arguments, index_t && index)
     auto write_header = [&]()
     {
         if constexpr (is_ibf)
+        {
             return synced_out.write_header(arguments, index.ibf().hash_function_count());
+        }
         else
-            return synced_out.write_header(arguments, index.ibf().ibf_vector[0].hash_function_count());
+        {
+            auto get_hash_function_count = [](auto const & root)
+            {
+                return root.hash_function_count();
+            };
+            return synced_out.write_header(arguments, index.ibf().with_ibf(0, get_hash_function_count));
+        }
     };
 
     for (auto && chunked_records : fin | seqan3::views::chunk((1ULL << 20) * 10))
@@ -141,7 +146,41 @@ void search_singular_ibf(search_arguments const & arguments, index_t && index)
         cereal_handle.wait();
         [[maybe_unused]] static bool header_written = write_header(); // called exactly once
 
-        do_parallel(worker, records.size(), arguments.threads);
+        auto search_records = [&](auto && make_counter)
+        {
+            do_parallel(
+                [&](size_t const start, size_t const end)
+                {
+                    worker(start, end, make_counter);
+                },
+                records.size(),
+                arguments.threads);
+        };
+
+        if constexpr (is_ibf)
+        {
+            with_counting_kernel(index.ibf(), search_records);
+        }
+        else
+        {
+            search_records(
+                [&index]()
+                {
+                    return index.ibf().membership_agent();
+                });
+        }
+    }
+
+    if constexpr (!is_ibf)
+    {
+        cereal_handle.wait();
+        if (index.ibf().lazy_ibfs)
+        {
+            lazy_ibf_statistics const statistics = index.ibf().lazy_ibfs->statistics();
+            arguments.ibf_cache_hits = statistics.hits;
+            arguments.ibf_cache_misses = statistics.misses;
+            arguments.ibf_cache_evictions = statistics.evictions;
+        }
     }
 }
 
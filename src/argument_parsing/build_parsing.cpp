@@ -21,7 +21,9 @@
 #include <raptor/argument_parsing/parse_bin_path.hpp>
 #include <raptor/argument_parsing/shared.hpp>
 #include <raptor/argument_parsing/validators.hpp>
+#include <raptor/build/dry_run.hpp>
 #include <raptor/build/raptor_build.hpp>
+#include <raptor/io/minimiser_file.hpp>
 
 namespace raptor
 {
@@ -127,16 +129,9 @@ inline void parse_shape_from_minimiser(sharg::parser & parser, build_arguments &
     if (parser.is_option_set("window"))
         throw sharg::parser_error{"You cannot set --window when using minimiser files as input."};
 
-    std::filesystem::path header_file_path = arguments.bin_path[0][0];
-    header_file_path.replace_extension("header");
-    std::ifstream file_stream{header_file_path};
-    std::string shape_string{};
-    file_stream >> shape_string >> arguments.window_size;
-
-    uint64_t tmp{};
-    std::from_chars(shape_string.data(), shape_string.data() + shape_string.size(), tmp, 2);
-
-    arguments.shape = seqan3::shape{seqan3::bin_literal{tmp}};
+    minimiser_file_header const header = minimiser_file_header::read(arguments.bin_path[0][0]);
+    arguments.window_size = header.window_size;
+    arguments.shape = header.to_shape();
 }
 
 void init_build_parser(sharg::parser & parser, build_arguments & arguments)
@@ -181,6 +176,20 @@ void init_build_parser(sharg::parser & parser, build_arguments & arguments)
     parser.add_flag(
         arguments.quiet,
         sharg::config{.short_id = '\0', .long_id = "quiet", .description = "Do not print time and memory usage."});
+    parser.add_flag(arguments.dry_run,
+                    sharg::config{.short_id = '\0',
+                                  .long_id = "dry-run",
+                                  .description = "Only print the estimated size of the index, the peak memory usage, "
+                                                 "and the amount of data read and written. No index is built. The "
+                                                 "sequence files are not read."});
+    parser.add_option(arguments.minimiser_cache_dir,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "minimiser-cache",
+                                    .description = "A directory to store the distinct minimisers of each input file "
+                                                   "in. Unchanged files are not processed again by later builds and "
+                                                   "upgrades with the same k-mer parameters. Not used for minimiser "
+                                                   "files.",
+                                    .default_message = "Minimisers are not stored"});
 
     parser.add_subsection("k-mer options");
     parser.add_option(
@@ -226,6 +235,56 @@ void init_build_parser(sharg::parser & parser, build_arguments & arguments)
     parser.add_flag(
         arguments.compressed,
         sharg::config{.short_id = '\0', .long_id = "compressed", .description = "Build a compressed index."});
+    parser.add_option(arguments.reserved_bins,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "reserve-bins",
+                                    .description = "Reserves this many empty bins for inserting user bins later via "
+                                                   "\\fBraptor update\\fP. Not available for the HIBF.",
+                                    .validator = positive_integer_validator{true}});
+    parser.add_option(arguments.memory_limit,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "memory-limit",
+                                    .description = "Limits the memory used for the k-mers of merged bins to this many "
+                                                   "MiB. K-mers exceeding the limit are written to temporary files "
+                                                   "next to the output. Only available for the HIBF.",
+                                    .default_message = "No limit",
+                                    .validator = positive_integer_validator{true}});
+    parser.add_option(arguments.checkpoint_dir,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "checkpoint-dir",
+                                    .description = "A directory to store finished lower-level IBFs in. A restarted "
+                                                   "build with the same layout and parameters loads them instead of "
+                                                   "building them again. Only available for the HIBF.",
+                                    .default_message = "No checkpoints"});
+    parser.add_option(arguments.uncompressed_levels,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "uncompressed-levels",
+                                    .description = "Keeps the IBFs of this many levels of a compressed HIBF "
+                                                   "uncompressed, starting with the top level. These IBFs are queried "
+                                                   "faster but use more memory. Requires --compressed.",
+                                    .validator = positive_integer_validator{true}});
+
+    parser.add_subsection("Bin size options");
+    parser.add_flag(arguments.estimate_bin_size,
+                    sharg::config{.short_id = '\0',
+                                  .long_id = "estimate-bin-size",
+                                  .description = "Estimate the number of distinct minimisers of each user bin with a "
+                                                 "HyperLogLog sketch instead of counting all minimisers. Only "
+                                                 "available for sequence input and an unpartitioned IBF."});
+    parser.add_option(arguments.sketch_cache,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "sketch-cache",
+                                    .description = "A directory to store the sketches in. Sketches of unchanged "
+                                                   "files are reused by later builds. Requires --estimate-bin-size.",
+                                    .default_message = "Sketches are not stored"});
+    parser.add_option(arguments.retain_hashes,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "retain-hashes",
+                                    .description = "Keep the minimisers of the largest user bins in memory while "
+                                                   "estimating the bin size, such that they are not read again when "
+                                                   "filling the index. The value is the memory limit in MiB. "
+                                                   "Requires --estimate-bin-size.",
+                                    .validator = positive_integer_validator{true}});
 }
 
 bool input_is_pack_file(std::filesystem::path const & path)
@@ -253,8 +312,33 @@ void build_parsing(sharg::parser & parser)
     if (arguments.is_hibf && arguments.parts != 1u)
         throw sharg::parser_error{"The HIBF cannot yet be partitioned."};
 
+    if (arguments.is_hibf && arguments.reserved_bins != 0u)
+        throw sharg::parser_error{"The HIBF does not support reserving bins."};
+
+    if (!arguments.is_hibf && arguments.memory_limit != 0u)
+        throw sharg::parser_error{"--memory-limit is only available for the HIBF."};
+
+    if (!arguments.is_hibf && parser.is_option_set("checkpoint-dir"))
+        throw sharg::parser_error{"--checkpoint-dir is only available for the HIBF."};
+
+    if (arguments.uncompressed_levels != 0u && (!arguments.is_hibf || !arguments.compressed))
+        throw sharg::parser_error{"--uncompressed-levels is only available for the compressed HIBF."};
+
+    if (arguments.compressed && arguments.reserved_bins != 0u)
+        throw sharg::parser_error{"A compressed index cannot be updated. Reserving bins is not supported."};
+
+    if (!arguments.estimate_bin_size && (parser.is_option_set("sketch-cache") || arguments.retain_hashes != 0u))
+        throw sharg::parser_error{"--sketch-cache and --retain-hashes require --estimate-bin-size."};
+
+    if (arguments.estimate_bin_size && (arguments.is_hibf || arguments.parts != 1u))
+        throw sharg::parser_error{"--estimate-bin-size is only available for an unpartitioned IBF."};
+
     parse_bin_path(arguments);
 
+    if (arguments.estimate_bin_size && arguments.input_is_minimiser)
+        throw sharg::parser_error{"--estimate-bin-size is not available for minimiser files. The number of minimisers "
+                                  "is read from the header files."};
+
     if (arguments.is_hibf)
         parse_chopper_config(parser, arguments);
 
@@ -263,6 +347,12 @@ void build_parsing(sharg::parser & parser)
     else
         parse_shape_from_minimiser(parser, arguments);
 
+    if (arguments.dry_run)
+    {
+        dry_run(arguments);
+        return;
+    }
+
     if (!arguments.is_hibf && arguments.parts == 1u)
         arguments.bits = compute_bin_size(arguments);
 
@@ -10,6 +10,9 @@
  * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
  */
 
+#include <set>
+#include <utility>
+
 #include <seqan3/search/views/minimiser_hash.hpp>
 
 #include <raptor/adjust_seed.hpp>
@@ -18,6 +21,9 @@
 #include <raptor/call_parallel_on_bins.hpp>
 #include <raptor/dna4_traits.hpp>
 #include <raptor/file_reader.hpp>
+#include <raptor/hyperloglog.hpp>
+#include <raptor/io/minimiser_file.hpp>
+#include <raptor/minimiser_cache.hpp>
 
 namespace raptor
 {
@@ -28,64 +34,40 @@ namespace detail
 size_t kmer_count_from_minimiser_files(std::vector<std::vector<std::string>> const & bin_path, uint8_t const threads)
 {
     std::mutex callback_mutex{};
-    size_t max_filesize{};
-    std::filesystem::path biggest_file{};
+    size_t max_count{};
 
-    auto callback = [&callback_mutex, &biggest_file, &max_filesize](std::filesystem::path const path, size_t const size)
+    auto callback = [&callback_mutex, &max_count](size_t const count)
     {
         std::lock_guard<std::mutex> guard{callback_mutex};
-        if (size > max_filesize)
-        {
-            max_filesize = size;
-            biggest_file = path;
-        }
+        max_count = std::max(max_count, count);
     };
 
+    // The minimiser count is stored in the header of each minimiser file.
     auto worker = [&callback](auto && zipped_view, auto &&)
     {
-        std::filesystem::path minimiser_file{};
-        std::filesystem::path biggest_file{};
-        size_t max_filesize{};
+        size_t max_count{};
 
         for (auto && [file_names, bin_number] : zipped_view)
-        {
             for (auto && file_name : file_names)
-            {
-                minimiser_file = file_name;
-                size_t const size = std::filesystem::file_size(minimiser_file);
-                if (size > max_filesize)
-                {
-                    max_filesize = size;
-                    biggest_file = minimiser_file;
-                }
-            }
-        }
+                max_count = std::max<size_t>(max_count, minimiser_file_header::read(file_name).count);
 
-        callback(biggest_file, max_filesize);
+        callback(max_count);
     };
 
     call_parallel_on_bins(worker, bin_path, threads);
 
-    std::string shape_string{};
-    uint64_t window_size{};
-    uint16_t cutoff{};
-    size_t max_count{};
-
-    biggest_file.replace_extension("header");
-    std::ifstream file_stream{biggest_file};
-    file_stream >> shape_string >> window_size >> cutoff >> max_count;
-
     return max_count;
 }
 
 size_t kmer_count_from_sequence_files(std::vector<std::vector<std::string>> const & bin_path,
                                       uint8_t const threads,
                                       seqan3::shape const & shape,
-                                      uint32_t const window_size)
+                                      uint32_t const window_size,
+                                      std::filesystem::path const & minimiser_cache_dir)
 {
     size_t max_count{};
     std::mutex callback_mutex{};
-    file_reader<file_types::sequence> const reader{shape, window_size};
+    file_reader<file_types::sequence> const reader{shape, window_size, minimiser_cache_dir};
 
     auto callback = [&callback_mutex, &max_count](auto && view)
     {
@@ -107,6 +89,225 @@ size_t kmer_count_from_sequence_files(std::vector<std::vector<std::string>> cons
     return max_count;
 }
 
+bool load_sketch(std::filesystem::path const & path, std::string const & key, hyperloglog & sketch)
+{
+    std::ifstream file{path, std::ios::binary};
+    std::string stored_key{};
+    // The stored key guards against hash collisions of the file name.
+    return std::getline(file, stored_key) && stored_key == key && sketch.load(file);
+}
+
+void store_sketch(std::filesystem::path const & path, std::string const & key, hyperloglog const & sketch)
+{
+    // Several threads may compute the sketch of the same file.
+    std::filesystem::path const tmp_path = file_cache_tmp_path(path);
+    {
+        std::ofstream file{tmp_path, std::ios::binary};
+        file << key << '\n';
+        sketch.store(file);
+    }
+    std::filesystem::rename(tmp_path, path);
+}
+
+/*!\brief Keeps the hashes of the largest user bins in memory, up to a given number of bytes.
+ * \details If a new user bin does not fit, smaller user bins are evicted.
+ * The budget also covers the hashes that are still being collected: Before a buffer for hashes is allocated, its
+ * bytes are reserved via raptor::detail::hash_retainer::reserve.
+ */
+class hash_retainer
+{
+public:
+    hash_retainer(size_t const budget, std::vector<std::vector<uint64_t>> & storage) :
+        budget{budget},
+        storage{storage}
+    {}
+
+    bool enabled() const noexcept
+    {
+        return budget > 0u;
+    }
+
+    //!\brief Reserves `bytes`. Returns `false` if they do not fit, even after evicting smaller user bins.
+    bool reserve(size_t const bytes)
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        if (!make_room(bytes))
+            return false;
+
+        used += bytes;
+        return true;
+    }
+
+    void release(size_t const bytes)
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        used -= bytes;
+    }
+
+    /*!\brief Retains the distinct `hashes` of `bin_number`.
+     * \details `reserved` are the bytes reserved for `hashes`. They become the bytes of the retained user bin.
+     */
+    void offer(size_t const bin_number, std::vector<uint64_t> && hashes, size_t const reserved)
+    {
+        std::ranges::sort(hashes);
+        auto const duplicates = std::ranges::unique(hashes);
+        hashes.erase(duplicates.begin(), duplicates.end());
+
+        size_t const bytes = hashes.size() * sizeof(uint64_t);
+
+        std::lock_guard<std::mutex> guard{mutex};
+
+        if (bytes == 0u)
+        {
+            used -= reserved;
+            return;
+        }
+
+        // Shrinking allocates `bytes` while the reserved buffer still exists. Without enough room, the reserved buffer
+        // is retained as it is.
+        size_t retained_bytes{reserved};
+        if (make_room(bytes))
+        {
+            hashes.shrink_to_fit();
+            used += bytes;
+            used -= reserved;
+            retained_bytes = bytes;
+        }
+
+        storage[bin_number] = std::move(hashes);
+        retained.emplace(retained_bytes, bin_number);
+    }
+
+private:
+    size_t const budget;
+    size_t used{};
+    std::vector<std::vector<uint64_t>> & storage;
+    std::set<std::pair<size_t, size_t>> retained{}; // (bytes, bin_number)
+    std::mutex mutex{};
+
+    //!\brief Evicts smaller user bins until `bytes` fit. Only evicts if this makes enough room. Needs the mutex.
+    bool make_room(size_t const bytes)
+    {
+        size_t freed{};
+        auto it = retained.begin();
+        for (; it != retained.end() && used - freed + bytes > budget && it->first < bytes; ++it)
+            freed += it->first;
+
+        if (used - freed + bytes > budget)
+            return false;
+
+        for (auto evict = retained.begin(); evict != it; ++evict)
+            storage[evict->second] = std::vector<uint64_t>{};
+        retained.erase(retained.begin(), it);
+        used -= freed;
+        return true;
+    }
+};
+
+/*!\brief Estimates the number of distinct minimisers of the largest user bin via HyperLogLog sketches.
+ * \details
+ * Sketches are computed per file. If a cache directory is given, sketches are reused across builds.
+ * If requested, the hashes of the largest user bins are kept in memory such that the index_factory does not need to
+ * read these user bins again.
+ */
+size_t kmer_count_from_sketches(build_arguments const & arguments)
+{
+    bool const use_cache = !arguments.sketch_cache.empty();
+    if (use_cache)
+        std::filesystem::create_directories(arguments.sketch_cache);
+
+    if (arguments.retain_hashes > 0u)
+        arguments.retained_hashes.resize(arguments.bin_path.size());
+
+    hash_retainer retainer{arguments.retain_hashes << 20, arguments.retained_hashes};
+    file_reader<file_types::sequence> const reader{arguments.shape,
+                                                   arguments.window_size,
+                                                   arguments.minimiser_cache_dir};
+    std::vector<double> estimates(arguments.bin_path.size());
+
+    auto worker = [&](auto && zipped_view, auto &&)
+    {
+        std::vector<uint64_t> hashes{};
+        // The bytes reserved in the retainer for the capacity of `hashes`.
+        size_t reserved{};
+
+        auto discard_hashes = [&]()
+        {
+            hashes = std::vector<uint64_t>{};
+            retainer.release(std::exchange(reserved, 0u));
+        };
+
+        // Do not exceed the memory budget, even temporarily. While the hashes are moved to a bigger buffer, both
+        // buffers exist.
+        auto grow_hashes = [&]() -> bool
+        {
+            size_t const capacity = std::max<size_t>(hashes.capacity() * 2u, 1024u);
+            if (!retainer.reserve(capacity * sizeof(uint64_t)))
+                return false;
+
+            hashes.reserve(capacity);
+            retainer.release(std::exchange(reserved, capacity * sizeof(uint64_t)));
+            return true;
+        };
+
+        for (auto && [file_names, bin_number] : zipped_view)
+        {
+            hyperloglog bin_sketch{};
+            bool retain = retainer.enabled();
+
+            for (auto && file_name : file_names)
+            {
+                hyperloglog file_sketch{};
+                std::string const key =
+                    use_cache ? file_cache_key(file_name, arguments.shape, arguments.window_size) : "";
+                std::filesystem::path const cache_file =
+                    use_cache ? file_cache_path(arguments.sketch_cache, key, ".hll") : std::filesystem::path{};
+
+                if (use_cache && load_sketch(cache_file, key, file_sketch))
+                {
+                    // The hashes of this file are not known.
+                    retain = false;
+                }
+                else
+                {
+                    reader.for_each_hash(file_name,
+                                         [&](uint64_t const hash)
+                                         {
+                                             file_sketch.add(hash);
+                                             if (retain && hashes.size() == hashes.capacity() && !grow_hashes())
+                                             {
+                                                 retain = false;
+                                                 discard_hashes();
+                                             }
+                                             if (retain)
+                                                 hashes.push_back(hash);
+                                         });
+
+                    if (use_cache)
+                        store_sketch(cache_file, key, file_sketch);
+                }
+
+                if (!retain)
+                    discard_hashes();
+
+                bin_sketch.merge(file_sketch);
+            }
+
+            estimates[bin_number] = bin_sketch.estimate();
+
+            if (retain)
+                retainer.offer(bin_number, std::move(hashes), std::exchange(reserved, 0u));
+            discard_hashes();
+        }
+    };
+
+    call_parallel_on_bins(worker, arguments.bin_path, arguments.threads);
+
+    double const max_estimate = std::ranges::max(estimates);
+    // Account for the estimation error.
+    return static_cast<size_t>(std::ceil(max_estimate * (1.0 + 2.0 * hyperloglog::relative_error)));
+}
+
 } // namespace detail
 
 size_t compute_bin_size(build_arguments const & arguments)
@@ -114,10 +315,13 @@ size_t compute_bin_size(build_arguments const & arguments)
     arguments.bin_size_timer.start();
     size_t const max_count = arguments.input_is_minimiser
                                ? detail::kmer_count_from_minimiser_files(arguments.bin_path, arguments.threads)
+                           : arguments.estimate_bin_size
+                               ? detail::kmer_count_from_sketches(arguments)
                                : detail::kmer_count_from_sequence_files(arguments.bin_path,
                                                                         arguments.threads,
                                                                         arguments.shape,
-                                                                        arguments.window_size);
+                                                                        arguments.window_size,
+                                                                        arguments.minimiser_cache_dir);
     arguments.bin_size_timer.stop();
 
     assert(max_count > 0u);
@@ -131,7 +335,8 @@ size_t max_bin_count(upgrade_arguments const & arguments)
                                         : detail::kmer_count_from_sequence_files(arguments.bin_path,
                                                                                  arguments.threads,
                                                                                  arguments.shape,
-                                                                                 arguments.window_size);
+                                                                                 arguments.window_size,
+                                                                                 arguments.minimiser_cache_dir);
 }
 
 } // namespace raptor
@@ -20,14 +20,25 @@ namespace raptor
 namespace detail
 {
 
+std::vector<std::string> split_file_names(std::string const & line)
+{
+    std::vector<std::string> result{};
+    std::string file_name{};
+    std::stringstream sstream{line};
+
+    while (std::getline(sstream, file_name, ' '))
+        if (!file_name.empty())
+            result.emplace_back(std::move(file_name));
+
+    return result;
+}
+
 void parse_bin_path(std::filesystem::path const & bin_file,
                     std::vector<std::vector<std::string>> & bin_path,
                     bool const is_hibf)
 {
     std::ifstream istrm{bin_file};
     std::string line{};
-    std::string file_name{};
-    std::vector<std::string> tmp{};
 
     if (is_hibf)
     {
@@ -41,16 +52,7 @@ void parse_bin_path(std::filesystem::path const & bin_file,
         while (std::getline(istrm, line))
         {
             if (!line.empty())
-            {
-                tmp.clear();
-                std::stringstream sstream{line};
-
-                while (std::getline(sstream, file_name, ' '))
-                    if (!file_name.empty())
-                        tmp.emplace_back(std::move(file_name));
-
-                bin_path.emplace_back(std::move(tmp));
-            }
+                bin_path.emplace_back(split_file_names(line));
         }
     }
 
@@ -79,4 +81,45 @@ void parse_bin_path(upgrade_arguments & arguments)
     arguments.input_is_minimiser = first_bin_path.extension() == ".minimiser";
 }
 
+void parse_bin_path(update_arguments & arguments)
+{
+    if (!arguments.insert_file.empty())
+        raptor::detail::parse_bin_path(arguments.insert_file, arguments.insert_bin_path, false);
+
+    std::string line{};
+
+    // The files of removed user bins do not need to exist anymore.
+    if (!arguments.remove_file.empty())
+    {
+        std::ifstream istrm{arguments.remove_file};
+        while (std::getline(istrm, line))
+            if (!line.empty())
+                arguments.remove_bin_path.emplace_back(raptor::detail::split_file_names(line));
+
+        if (arguments.remove_bin_path.empty())
+            throw sharg::validation_error{"The list of user bins to remove cannot be empty."};
+    }
+
+    if (!arguments.replace_file.empty())
+    {
+        std::ifstream istrm{arguments.replace_file};
+        while (std::getline(istrm, line))
+        {
+            if (line.empty())
+                continue;
+
+            size_t const tab_position = line.find('\t');
+            if (tab_position == std::string::npos)
+                throw sharg::validation_error{"Each line of the replacement file must contain the old and the new "
+                                              "files of a user bin, separated by a tab."};
+
+            arguments.replace_bin_path.emplace_back(raptor::detail::split_file_names(line.substr(0, tab_position)));
+            arguments.replacement_bin_path.emplace_back(
+                raptor::detail::split_file_names(line.substr(tab_position + 1u)));
+        }
+
+        bin_validator{}(arguments.replacement_bin_path);
+    }
+}
+
 } // namespace raptor
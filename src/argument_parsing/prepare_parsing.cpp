@@ -53,11 +53,12 @@ void init_prepare_parser(sharg::parser & parser, prepare_arguments & arguments)
                          "Will create a \\fBminimiser.list\\fP inside the output directory. This file contains a "
                          "list of generated minimiser files, in the same order as the input.");
     parser.add_list_item("",
-                         "\\fBWhen you manually delete a .in_progress file, also delete the corresponding .header and "
-                         ".minimiser file!\\fP");
+                         "\\fBWhen you manually delete a .in_progress file, also delete the corresponding .minimiser "
+                         "file!\\fP");
     parser.add_list_item("", "Created output files for each file:");
-    parser.add_list_item("", "\\fB*.header\\fP: Contains the shape, window size, cutoff and minimiser count.");
-    parser.add_list_item("", "\\fB*.minimiser\\fP: Contains binary minimiser values, one minimiser per line.");
+    parser.add_list_item("",
+                         "\\fB*.minimiser\\fP: Contains the shape, window size, cutoff, minimiser count, and the "
+                         "sorted, compressed minimiser values.");
     parser.add_list_item(
         "",
         "\\fB*.in_progress\\fP: Temporary file to track process. Deleted after finishing computation.");
@@ -103,6 +104,14 @@ void init_prepare_parser(sharg::parser & parser, prepare_arguments & arguments)
                                   .long_id = "use-filesize-dependent-cutoff",
                                   .description = "Apply cutoffs from Mantis(Pandey et al., 2018). "
                                                  "Mutually exclusive with --kmer-count-cutoff."});
+    parser.add_option(arguments.memory_limit,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "memory-limit",
+                                    .description = "Limits the memory used for counting minimisers to this many MiB, "
+                                                   "shared by all threads. Counts exceeding the limit are written to "
+                                                   "temporary files next to the output.",
+                                    .default_message = "No limit",
+                                    .validator = positive_integer_validator{true}});
 }
 
 void prepare_parsing(sharg::parser & parser)
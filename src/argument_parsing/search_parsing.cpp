@@ -63,6 +63,20 @@ void init_search_parser(sharg::parser & parser, search_arguments & arguments)
     parser.add_flag(
         arguments.quiet,
         sharg::config{.short_id = '\0', .long_id = "quiet", .description = "Do not print time and memory usage."});
+    parser.add_flag(arguments.lazy_load,
+                    sharg::config{.short_id = '\0',
+                                  .long_id = "lazy-load",
+                                  .description = "Only load the top-level IBF of an HIBF before searching. The other "
+                                                 "IBFs are loaded when a query first reaches them. Only available for "
+                                                 "the HIBF."});
+    parser.add_option(arguments.cache_limit,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "cache-limit",
+                                    .description = "Limits the memory used for the IBFs of an HIBF to this many MiB. "
+                                                   "The least recently used IBFs are removed from memory and loaded "
+                                                   "again when needed. Implies --lazy-load.",
+                                    .default_message = "No limit",
+                                    .validator = positive_integer_validator{true}});
 
     parser.add_subsection("Threshold method options");
     parser.add_line("\\fBIf no option is set, --error " + std::to_string(arguments.errors)
@@ -215,6 +229,12 @@ void search_parsing(sharg::parser & parser)
         arguments.is_hibf = tmp.is_hibf();
     }
 
+    if (arguments.cache_limit != 0u)
+        arguments.lazy_load = true;
+
+    if (arguments.lazy_load && !arguments.is_hibf)
+        throw sharg::parser_error{"--lazy-load and --cache-limit are only available for the HIBF."};
+
     if (min_query_length < arguments.window_size)
         throw sharg::parser_error{sharg::detail::to_string("The (minimal) query length (",
                                                            min_query_length,
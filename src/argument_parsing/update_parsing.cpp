@@ -0,0 +1,196 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Implements raptor::update_parsing.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#include <raptor/argument_parsing/init_shared_meta.hpp>
+#include <raptor/argument_parsing/parse_bin_path.hpp>
+#include <raptor/argument_parsing/update_parsing.hpp>
+#include <raptor/argument_parsing/validators.hpp>
+#include <raptor/index.hpp>
+#include <raptor/io/minimiser_file.hpp>
+#include <raptor/update/update.hpp>
+
+namespace raptor
+{
+
+void init_update_parser(sharg::parser & parser, update_arguments & arguments)
+{
+    init_shared_meta(parser);
+    parser.info.description.emplace_back("Inserts, removes, or replaces user bins of an existing Raptor index.");
+    parser.info.description.emplace_back("New user bins are placed into empty bins, i.e., bins of removed user bins "
+                                         "or bins reserved via \\fBraptor build --reserve-bins\\fP. If there are "
+                                         "not enough empty bins, the index is widened. Only the new files are "
+                                         "processed. A warning is printed if the new user bins exceed the false "
+                                         "positive rate of the index.");
+    parser.info.description.emplace_back("Removals are processed first, then replacements, then insertions.");
+    parser.info.description.emplace_back("Only uncompressed IBFs can be updated.");
+    parser.info.examples.emplace_back("raptor update --index raptor.index --insert new_bins.list --output "
+                                      "raptor.index");
+    parser.info.examples.emplace_back("raptor update --index raptor.index --remove old_bins.list --replace "
+                                      "revised_bins.tsv --output raptor.index");
+    parser.info.synopsis.emplace_back("raptor update --index <file> --output <file> [--insert <file>] [--remove "
+                                      "<file>] [--replace <file>] [--threads <number>] [--quiet]");
+
+    parser.add_subsection("General options");
+    parser.add_option(arguments.index_file,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "index",
+                                    .description = "The index to update. Parts: Without suffix _0",
+                                    .required = true});
+    parser.add_option(
+        arguments.insert_file,
+        sharg::config{.short_id = '\0',
+                      .long_id = "insert",
+                      .description = "A file containing file names of user bins to insert. "
+                                   + bin_validator{}.get_help_page_message(),
+                      .validator = sharg::input_file_validator{}});
+    parser.add_option(arguments.remove_file,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "remove",
+                                    .description = "A file containing the user bins to remove, in the same format as "
+                                                   "used for building the index. The files do not need to exist.",
+                                    .validator = sharg::input_file_validator{}});
+    parser.add_option(arguments.replace_file,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "replace",
+                                    .description = "A file containing one user bin to replace per line. Each line "
+                                                   "consists of the files of the user bin as used for building the "
+                                                   "index, a tab, and the new files of the user bin.",
+                                    .validator = sharg::input_file_validator{}});
+    parser.add_option(arguments.output_file,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "output",
+                                    .description = "Path to the updated index. May be the same as --index.",
+                                    .required = true,
+                                    .validator = output_file_validator{}});
+    parser.add_option(arguments.threads,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "threads",
+                                    .description = "The number of threads to use.",
+                                    .validator = positive_integer_validator{}});
+    parser.add_flag(
+        arguments.quiet,
+        sharg::config{.short_id = '\0', .long_id = "quiet", .description = "Do not print time and memory usage."});
+}
+
+void update_parsing(sharg::parser & parser)
+{
+    update_arguments arguments{};
+    arguments.wall_clock_timer.start();
+
+    init_update_parser(parser, arguments);
+    parser.parse();
+
+    // ==========================================
+    // Various checks.
+    // ==========================================
+    std::filesystem::path const partitioned_index_file = arguments.index_file.string() + "_0";
+    bool const index_is_monolithic = std::filesystem::exists(arguments.index_file);
+    bool const index_is_partitioned = std::filesystem::exists(partitioned_index_file);
+    sharg::input_file_validator const index_validator{};
+
+    if (index_is_monolithic && index_is_partitioned)
+    {
+        throw sharg::validation_error{sharg::detail::to_string("Ambiguous index. Both monolithic (",
+                                                               arguments.index_file.c_str(),
+                                                               ") and partitioned index (",
+                                                               partitioned_index_file.c_str(),
+                                                               ") exist. Please rename the monolithic index.")};
+    }
+    else if (index_is_partitioned)
+    {
+        index_validator(partitioned_index_file);
+    }
+    else
+    {
+        index_validator(arguments.index_file);
+    }
+
+    if (!parser.is_option_set("insert") && !parser.is_option_set("remove") && !parser.is_option_set("replace"))
+        throw sharg::parser_error{"Nothing to do. Please set at least one of --insert, --remove, and --replace."};
+
+    for (auto const & file : {arguments.insert_file, arguments.remove_file, arguments.replace_file})
+        if (!file.empty() && std::filesystem::is_empty(file))
+            throw sharg::parser_error{sharg::detail::to_string("The input file ", file.c_str(), " is empty.")};
+
+    parse_bin_path(arguments);
+
+    // ==========================================
+    // Read window and kmer size.
+    // ==========================================
+    {
+        std::ifstream is{index_is_partitioned ? partitioned_index_file : arguments.index_file, std::ios::binary};
+        cereal::BinaryInputArchive iarchive{is};
+        raptor_index<> tmp{};
+        tmp.load_parameters(iarchive);
+        arguments.shape = tmp.shape();
+        arguments.window_size = tmp.window_size();
+        arguments.parts = tmp.parts();
+        arguments.compressed = tmp.compressed();
+        arguments.is_hibf = tmp.is_hibf();
+    }
+
+    if (arguments.is_hibf)
+        throw sharg::parser_error{"Updating an HIBF is not supported."};
+    if (arguments.compressed)
+        throw sharg::parser_error{"Updating a compressed index is not supported. Please update the uncompressed "
+                                  "index and compress it afterwards."};
+
+    // ==========================================
+    // Minimiser files must match the index.
+    // ==========================================
+    auto check_minimiser_files = [&arguments](std::vector<std::vector<std::string>> const & bin_path)
+    {
+        for (auto const & file_list : bin_path)
+        {
+            for (std::filesystem::path const file_path : file_list)
+            {
+                if (file_path.extension() != ".minimiser")
+                    continue;
+
+                minimiser_file_header const header = minimiser_file_header::read(file_path);
+
+                if (header.to_shape() != arguments.shape || header.window_size != arguments.window_size)
+                    throw sharg::validation_error{sharg::detail::to_string("The minimiser file ",
+                                                                           file_path.c_str(),
+                                                                           " was computed with different parameters "
+                                                                           "than the index.")};
+            }
+        }
+    };
+    check_minimiser_files(arguments.insert_bin_path);
+    check_minimiser_files(arguments.replacement_bin_path);
+
+    // ==========================================
+    // Partitioned index: Check that all parts are available.
+    // ==========================================
+    if (index_is_partitioned)
+    {
+        // GCOVR_EXCL_START
+        std::string const index_path_base{[&partitioned_index_file]()
+                                          {
+                                              std::string_view sv = partitioned_index_file.c_str();
+                                              assert(sv.size() > 0u);
+                                              sv.remove_suffix(1u);
+                                              return sv;
+                                          }()};
+        // GCOVR_EXCL_STOP
+        for (size_t part{1u}; part < arguments.parts; ++part)
+            index_validator(index_path_base + std::to_string(part));
+    }
+
+    raptor_update(arguments);
+
+    arguments.wall_clock_timer.stop();
+    arguments.print_timings();
+}
+
+} // namespace raptor
@@ -35,6 +35,8 @@ void init_upgrade_parser(sharg::parser & parser, upgrade_arguments & arguments)
                                          " per file. The false positive rate can then be automatically determined. The"
                                          " order of the files does not matter. The file with the most k-mers will"
                                          " determine the false positive rate.");
+    parser.info.description.emplace_back("Indices created with an earlier Raptor 3 version (index version 2) are"
+                                         " rewritten with the current index version. --fpr and --bins are ignored.");
     parser.info.examples.emplace_back("raptor upgrade --input old.index --output new.index");
     parser.info.examples.emplace_back("raptor upgrade --input old.index --output new.index --fpr 0.05");
     parser.info.examples.emplace_back("raptor upgrade --input old.index --output new.index --bins bins.list");
@@ -62,6 +64,13 @@ void init_upgrade_parser(sharg::parser & parser, upgrade_arguments & arguments)
     parser.add_option(
         arguments.output_file,
         sharg::config{.short_id = '\0', .long_id = "output", .description = "Path to new index.", .required = true});
+    parser.add_option(arguments.minimiser_cache_dir,
+                      sharg::config{.short_id = '\0',
+                                    .long_id = "minimiser-cache",
+                                    .description = "A directory containing the minimisers of the input files, as "
+                                                   "created by \\fBraptor build --minimiser-cache\\fP. Missing "
+                                                   "entries are added.",
+                                    .default_message = "Minimisers are not stored"});
 }
 
 void upgrade_parsing(sharg::parser & parser)
@@ -107,7 +116,10 @@ void upgrade_parsing(sharg::parser & parser)
         arguments.window_size = tmp.window_size();
         arguments.parts = tmp.parts();
         arguments.compressed = tmp.compressed();
-        if (arguments.bin_path.empty() && !parser.is_option_set("fpr"))
+        arguments.is_hibf = tmp.is_hibf();
+        arguments.index_version = tmp.parsed_version();
+        // Indices of version 2 are only rewritten and keep their bins and FPR.
+        if (arguments.index_version == 1u && arguments.bin_path.empty() && !parser.is_option_set("fpr"))
         {
             arguments.bin_path = tmp.bin_path();
             bin_validator{}(arguments.bin_path);
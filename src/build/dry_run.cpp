@@ -0,0 +1,335 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Implements raptor::dry_run.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#include <lemon/list_graph.h> /// Must be first include.
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <raptor/argument_parsing/compute_bin_size.hpp>
+#include <raptor/build/dry_run.hpp>
+#include <raptor/build/hibf/bin_size_in_bits.hpp>
+#include <raptor/build/hibf/read_chopper_pack_file.hpp>
+#include <raptor/io/minimiser_file.hpp>
+#include <raptor/minimiser_cache.hpp>
+#include <raptor/search/do_parallel.hpp>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+// Compressed sequence files are assumed to contain this many times as many bases as bytes.
+static constexpr size_t compression_ratio{4u};
+
+struct size_estimate
+{
+    size_t bytes{};
+    size_t kmers{};
+
+    size_estimate & operator+=(size_estimate const & other)
+    {
+        bytes += other.bytes;
+        kmers += other.kmers;
+        return *this;
+    }
+};
+
+//!\brief Estimates the number of minimisers of a file without reading its sequences.
+class kmer_estimator
+{
+public:
+    explicit kmer_estimator(build_arguments const & arguments) : arguments{arguments}
+    {
+        // Constructing a raptor::minimiser_cache creates the directory.
+        if (!arguments.minimiser_cache_dir.empty() && std::filesystem::exists(arguments.minimiser_cache_dir))
+            cache = minimiser_cache{arguments.minimiser_cache_dir, arguments.shape, arguments.window_size};
+
+        // Two consecutive windows share their minimiser with probability (w - k) / (w - k + 2).
+        double const windows_per_kmer = arguments.window_size - arguments.shape.size() + 2.0;
+        density = std::min(1.0, 2.0 / windows_per_kmer);
+    }
+
+    size_estimate operator()(std::string const & filename) const
+    {
+        size_t const bytes = std::filesystem::file_size(filename);
+
+        // Minimiser files are bit-packed. Their header stores the number of minimisers.
+        if (arguments.input_is_minimiser)
+            return {bytes, minimiser_file_header::read(filename).count};
+
+        size_t count{};
+        if (cache && cache->count(filename, count))
+            return {bytes, count};
+
+        if (!arguments.sketch_cache.empty())
+        {
+            std::string const key = file_cache_key(filename, arguments.shape, arguments.window_size);
+            hyperloglog sketch{};
+            // Account for the estimation error, as in compute_bin_size.
+            if (load_sketch(file_cache_path(arguments.sketch_cache, key, ".hll"), key, sketch))
+                return {bytes,
+                        static_cast<size_t>(std::ceil(sketch.estimate() * (1.0 + 2.0 * hyperloglog::relative_error)))};
+        }
+
+        // Headers and line breaks are counted as bases, hence this is an upper bound for uncompressed files.
+        std::string const extension = std::filesystem::path{filename}.extension().string();
+        bool const is_compressed = extension == ".gz" || extension == ".bgzf" || extension == ".bz2";
+        size_t const bases = is_compressed ? bytes * compression_ratio : bytes;
+        return {bytes, static_cast<size_t>(std::ceil(bases * density))};
+    }
+
+    size_estimate operator()(std::vector<std::string> const & filenames) const
+    {
+        size_estimate result{};
+        for (auto const & filename : filenames)
+            result += (*this)(filename);
+        return result;
+    }
+
+private:
+    build_arguments const & arguments;
+    std::optional<minimiser_cache> cache{};
+    double density{1.0};
+};
+
+//!\brief The size of an IBF with the given number of technical bins.
+size_t ibf_bytes(size_t const bin_size_in_bits, size_t const number_of_technical_bins)
+{
+    // seqan3::interleaved_bloom_filter rounds the number of bins up to a multiple of 64.
+    size_t const bin_words = (number_of_technical_bins + 63u) / 64u;
+    return bin_size_in_bits * bin_words * sizeof(uint64_t);
+}
+
+struct dry_run_result
+{
+    std::vector<std::pair<std::string, size_t>> ibf_sizes{};
+    size_t index_bytes{};
+    size_t peak_memory_bytes{};
+    size_t read_bytes{};
+    size_t written_bytes{};
+
+    void print() const
+    {
+        auto formatted = [](size_t const bytes)
+        {
+            return formatted_peak_ram(std::max<size_t>(1u, bytes));
+        };
+
+        std::cout << "============= Dry run =============\n";
+        for (auto const & [label, bytes] : ibf_sizes)
+            std::cout << label << ' ' << formatted(bytes) << '\n';
+        std::cout << "Index size " << formatted(index_bytes) << '\n';
+        std::cout << "Peak memory usage " << formatted(peak_memory_bytes) << '\n';
+        std::cout << "Read " << formatted(read_bytes) << '\n';
+        std::cout << "Written " << formatted(written_bytes) << '\n';
+    }
+};
+
+dry_run_result dry_run_ibf(build_arguments const & arguments)
+{
+    kmer_estimator const estimator{arguments};
+    std::vector<size_estimate> bin_estimates(arguments.bin_path.size());
+
+    auto worker = [&](size_t const start, size_t const end)
+    {
+        for (size_t i = start; i < end; ++i)
+            bin_estimates[i] = estimator(arguments.bin_path[i]);
+    };
+    do_parallel(worker, bin_estimates.size(), arguments.threads);
+
+    size_t max_count{1u};
+    dry_run_result result{};
+    for (size_estimate const & estimate : bin_estimates)
+    {
+        max_count = std::max(max_count, estimate.kmers);
+        result.read_bytes += estimate.bytes;
+    }
+
+    // Each part stores the k-mers of one hash range. The largest user bin is assumed to be evenly distributed.
+    size_t const kmers_per_part = (max_count + arguments.parts - 1u) / arguments.parts;
+    size_t const bits = hibf::bin_size_in_bits(arguments, kmers_per_part);
+    size_t const part_bytes = ibf_bytes(bits, arguments.bin_path.size() + arguments.reserved_bins);
+
+    if (arguments.parts == 1u)
+        result.ibf_sizes.emplace_back("IBF", part_bytes);
+    else
+        result.ibf_sizes.emplace_back("IBF (" + std::to_string(arguments.parts) + " parts, each)", part_bytes);
+
+    // Only one part is in memory at a time. Compressing an IBF needs the uncompressed and the compressed IBF.
+    result.index_bytes = part_bytes * arguments.parts;
+    result.peak_memory_bytes = part_bytes * (arguments.compressed ? 2u : 1u) + (arguments.retain_hashes << 20);
+    result.written_bytes = result.index_bytes;
+
+    return result;
+}
+
+/*!\brief Estimates the IBF of the node and of all nodes below.
+ * \returns The estimated number of k-mers in the subtree, which is also stored in `subtree_kmers_of_node`. Since
+ *          k-mers shared by user bins are counted multiple times, this is an upper bound.
+ */
+size_t estimate_subtree(lemon::ListDigraph::Node const node,
+                        size_t const level,
+                        hibf::build_data<seqan3::data_layout::uncompressed> const & data,
+                        std::vector<std::vector<size_t>> const & record_kmers,
+                        std::vector<size_t> & subtree_kmers_of_node,
+                        std::vector<std::pair<size_t, size_t>> & levels, // (number of IBFs, bytes)
+                        build_arguments const & arguments)
+{
+    auto const & node_data = data.node_map[node];
+    auto const & kmers_of_records = record_kmers[data.ibf_graph.id(node)];
+
+    size_t subtree_kmers{};
+    for (size_t const kmers : kmers_of_records)
+        subtree_kmers += kmers;
+
+    size_t max_bin_kmers{};
+    size_t max_bin_tbs{1u};
+
+    for (lemon::ListDigraph::OutArcIt arc_it(data.ibf_graph, node); arc_it != lemon::INVALID; ++arc_it)
+    {
+        lemon::ListDigraph::Node const child = data.ibf_graph.target(arc_it);
+        size_t const child_kmers =
+            estimate_subtree(child, level + 1u, data, record_kmers, subtree_kmers_of_node, levels, arguments);
+        subtree_kmers += child_kmers;
+
+        if (child == node_data.favourite_child)
+            max_bin_kmers = child_kmers;
+    }
+
+    // The max bin is not a merged bin. read_chopper_pack_file moves the max record to the front.
+    if (node_data.favourite_child == lemon::INVALID && !node_data.remaining_records.empty())
+    {
+        max_bin_kmers = kmers_of_records[0];
+        max_bin_tbs = node_data.remaining_records[0].number_of_bins.back();
+    }
+
+    // Same as construct_ibf.
+    size_t const kmers_per_bin = std::max<size_t>(1u, (max_bin_kmers + max_bin_tbs - 1u) / max_bin_tbs);
+    double const bin_bits{static_cast<double>(hibf::bin_size_in_bits(arguments, kmers_per_bin))};
+    size_t const bin_size = std::ceil(bin_bits * data.fp_correction[max_bin_tbs]);
+
+    if (levels.size() <= level)
+        levels.resize(level + 1u);
+    ++levels[level].first;
+    levels[level].second += ibf_bytes(bin_size, node_data.number_of_technical_bins);
+
+    subtree_kmers_of_node[data.ibf_graph.id(node)] = subtree_kmers;
+    return subtree_kmers;
+}
+
+dry_run_result dry_run_hibf(build_arguments const & arguments)
+{
+    hibf::build_data<seqan3::data_layout::uncompressed> data{};
+    hibf::read_chopper_pack_file(data, arguments.bin_file, arguments.threads);
+    lemon::ListDigraph::Node const root = data.ibf_graph.nodeFromId(0);
+    data.compute_fp_correction(data.node_map[root].number_of_technical_bins, arguments.hash, arguments.fpr);
+
+    // The estimated number of k-mers of each record, in the order of the remaining records of each node.
+    std::vector<std::vector<size_t>> record_kmers(data.ibf_graph.maxNodeId() + 1);
+    std::vector<std::pair<hibf::chopper_pack_record const *, size_t *>> records{};
+    for (lemon::ListDigraph::NodeIt node_it(data.ibf_graph); node_it != lemon::INVALID; ++node_it)
+    {
+        auto const & remaining_records = data.node_map[node_it].remaining_records;
+        auto & kmers = record_kmers[data.ibf_graph.id(node_it)];
+        kmers.resize(remaining_records.size());
+        for (size_t i = 0; i < remaining_records.size(); ++i)
+            records.emplace_back(&remaining_records[i], &kmers[i]);
+    }
+
+    kmer_estimator const estimator{arguments};
+    std::vector<size_t> read_bytes(records.size());
+    auto worker = [&](size_t const start, size_t const end)
+    {
+        for (size_t i = start; i < end; ++i)
+        {
+            auto const & [record, kmers] = records[i];
+            size_estimate const estimate = estimator(record->filenames);
+            read_bytes[i] = estimate.bytes;
+            *kmers = record->estimated_sizes.empty() ? estimate.kmers
+                                                     : record->estimated_sizes.back() * record->number_of_bins.back();
+        }
+    };
+    do_parallel(worker, records.size(), std::max<size_t>(1u, std::min<size_t>(arguments.threads, records.size())));
+
+    std::vector<size_t> subtree_kmers_of_node(record_kmers.size());
+    std::vector<std::pair<size_t, size_t>> levels{};
+    estimate_subtree(root, 0u, data, record_kmers, subtree_kmers_of_node, levels, arguments);
+
+    dry_run_result result{};
+    for (size_t level = 0; level < levels.size(); ++level)
+    {
+        auto const [ibfs, bytes] = levels[level];
+        result.ibf_sizes.emplace_back("Level " + std::to_string(level) + " (" + std::to_string(ibfs)
+                                          + (ibfs == 1u ? " IBF)" : " IBFs)"),
+                                      bytes);
+        result.index_bytes += bytes;
+    }
+
+    for (size_t const bytes : read_bytes)
+        result.read_bytes += bytes;
+
+    // The k-mers of the subtrees below the root are kept until the root is filled. Each thread additionally reads one
+    // user bin at a time.
+    size_t merged_kmers{};
+    for (lemon::ListDigraph::OutArcIt arc_it(data.ibf_graph, root); arc_it != lemon::INVALID; ++arc_it)
+        merged_kmers += subtree_kmers_of_node[data.ibf_graph.id(data.ibf_graph.target(arc_it))];
+
+    size_t max_record_kmers{};
+    for (auto const & kmers : record_kmers)
+        for (size_t const count : kmers)
+            max_record_kmers = std::max(max_record_kmers, count);
+
+    size_t merged_bytes = merged_kmers * sizeof(uint64_t);
+    size_t spilled_bytes{};
+    if (arguments.memory_limit > 0u && merged_bytes > (arguments.memory_limit << 20))
+    {
+        spilled_bytes = merged_bytes - (arguments.memory_limit << 20);
+        merged_bytes = arguments.memory_limit << 20;
+    }
+
+    size_t const user_bin_bytes = arguments.threads * max_record_kmers * sizeof(uint64_t);
+    result.peak_memory_bytes = result.index_bytes + merged_bytes + user_bin_bytes;
+
+    // Spilled k-mers are written and read once.
+    result.read_bytes += spilled_bytes;
+    result.written_bytes = result.index_bytes + spilled_bytes;
+
+    // Each lower-level IBF and the k-mers it contributes to its parent are stored as checkpoint.
+    if (!arguments.checkpoint_dir.empty())
+    {
+        size_t checkpoint_kmers{};
+        for (lemon::ListDigraph::NodeIt node_it(data.ibf_graph); node_it != lemon::INVALID; ++node_it)
+            if (node_it != root)
+                checkpoint_kmers += subtree_kmers_of_node[data.ibf_graph.id(node_it)];
+        result.written_bytes += result.index_bytes - levels[0].second + checkpoint_kmers * sizeof(uint64_t);
+    }
+
+    return result;
+}
+
+} // namespace detail
+
+void dry_run(build_arguments const & arguments)
+{
+    detail::dry_run_result const result = arguments.is_hibf ? detail::dry_run_hibf(arguments) //
+                                                            : detail::dry_run_ibf(arguments);
+    result.print();
+}
+
+} // namespace raptor
@@ -0,0 +1,281 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Implements raptor::hibf::store_checkpoint and raptor::hibf::load_checkpoint.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#include <lemon/list_graph.h> /// Must be first include.
+
+#include <filesystem>
+#include <fstream>
+#include <ranges>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <raptor/build/hibf/checkpoint.hpp>
+#include <raptor/minimiser_cache.hpp>
+
+namespace raptor::hibf
+{
+
+namespace
+{
+
+// Identifies the layout and parameters of the build.
+std::string checkpoint_key(build_arguments const & arguments)
+{
+    return detail::file_cache_key(arguments.bin_file, arguments.shape, arguments.window_size) + '\t'
+         + std::to_string(arguments.hash) + '\t' + std::to_string(arguments.fpr) + '\t'
+         + std::to_string(arguments.compressed) + '\t' + std::to_string(arguments.uncompressed_levels);
+}
+
+// For example, `node_3_5` for the node in bin 5 of the IBF in bin 3 of the root.
+template <seqan3::data_layout data_layout_mode>
+std::filesystem::path checkpoint_path(lemon::ListDigraph::Node node,
+                                      build_data<data_layout_mode> & data,
+                                      build_arguments const & arguments,
+                                      std::string const & extension)
+{
+    lemon::ListDigraph::Node const root = data.ibf_graph.nodeFromId(0);
+    std::vector<size_t> bins{};
+
+    while (node != root)
+    {
+        bins.push_back(data.node_map[node].parent_bin_index);
+        node = data.ibf_graph.source(lemon::ListDigraph::InArcIt(data.ibf_graph, node));
+    }
+
+    std::string file_name{"node"};
+    for (size_t const bin : bins | std::views::reverse)
+        file_name += '_' + std::to_string(bin);
+
+    return arguments.checkpoint_dir / (file_name + extension);
+}
+
+template <seqan3::data_layout data_layout_mode>
+size_t load_subtree(lemon::ListDigraph::Node const & node,
+                    build_data<data_layout_mode> & data,
+                    build_arguments const & arguments)
+{
+    if (!has_checkpoint(node, data, arguments))
+        throw std::runtime_error{"The checkpoints in " + arguments.checkpoint_dir.string() + " are incomplete."};
+
+    bool const keep_uncompressed{data.keep_uncompressed(node)};
+    std::string key{};
+    seqan3::interleaved_bloom_filter<data_layout_mode> ibf{};
+    seqan3::interleaved_bloom_filter<> uncompressed_ibf{};
+    std::vector<int64_t> local_filename_indices{};
+    std::vector<std::string> filenames{};
+    {
+        std::ifstream is{checkpoint_path(node, data, arguments, ".ibf"), std::ios::binary};
+        cereal::BinaryInputArchive iarchive{is};
+        iarchive(key);
+        if (keep_uncompressed)
+            iarchive(uncompressed_ibf);
+        else
+            iarchive(ibf);
+        iarchive(local_filename_indices, filenames);
+    }
+
+    auto const & node_data = data.node_map[node];
+    size_t const ibf_pos{node_data.ibf_position};
+    std::vector<int64_t> ibf_positions(node_data.number_of_technical_bins, ibf_pos);
+
+    for (lemon::ListDigraph::OutArcIt arc_it(data.ibf_graph, node); arc_it != lemon::INVALID; ++arc_it)
+    {
+        lemon::ListDigraph::Node const child = data.ibf_graph.target(arc_it);
+        ibf_positions[data.node_map[child].parent_bin_index] = load_subtree(child, data, arguments);
+    }
+
+    // The user bins of the checkpoint are numbered relative to the node. Each record starts at its own technical bin.
+    auto const & records = node_data.remaining_records;
+    bool matches_layout{records.size() == filenames.size()};
+    std::vector<int64_t> user_bin_indices(filenames.size(), -1);
+    for (size_t i = 0; matches_layout && i < records.size(); ++i)
+    {
+        size_t const bin = records[i].bin_indices.back();
+        int64_t const local_index = (bin < local_filename_indices.size()) ? local_filename_indices[bin] : -1;
+        matches_layout = local_index >= 0 && static_cast<size_t>(local_index) < filenames.size()
+                      && user_bin_indices[local_index] == -1;
+        if (matches_layout)
+            user_bin_indices[local_index] = node_data.user_bin_positions[i];
+    }
+
+    if (!matches_layout)
+        throw std::runtime_error{"The checkpoint " + checkpoint_path(node, data, arguments, ".ibf").string()
+                                 + " does not match the layout."};
+
+    for (size_t i = 0; i < filenames.size(); ++i)
+        data.hibf.user_bins.filename_of_user_bin(user_bin_indices[i]) = std::move(filenames[i]);
+
+    for (int64_t & index : local_filename_indices)
+        if (index != -1)
+            index = user_bin_indices[index];
+
+    if (keep_uncompressed)
+        data.hibf.store_ibf(ibf_pos, std::move(uncompressed_ibf), true);
+    else
+        data.hibf.ibf_vector[ibf_pos] = std::move(ibf);
+    data.hibf.next_ibf_id[ibf_pos] = std::move(ibf_positions);
+    data.hibf.user_bins.bin_indices_of_ibf(ibf_pos) = std::move(local_filename_indices);
+
+    return ibf_pos;
+}
+
+} // namespace
+
+template <seqan3::data_layout data_layout_mode>
+void store_checkpoint(kmer_runs & kmers,
+                      size_t const ibf_pos,
+                      lemon::ListDigraph::Node const & node,
+                      build_data<data_layout_mode> & data,
+                      build_arguments const & arguments)
+{
+    std::filesystem::path const kmer_file = checkpoint_path(node, data, arguments, ".kmers");
+    std::filesystem::path const ibf_file = checkpoint_path(node, data, arguments, ".ibf");
+    std::filesystem::create_directories(arguments.checkpoint_dir);
+
+    // The k-mers are written first. The IBF file marks a complete checkpoint.
+    {
+        std::filesystem::path const tmp_file = detail::file_cache_tmp_path(kmer_file);
+        {
+            std::ofstream os{tmp_file, std::ios::binary};
+            std::vector<uint64_t> buffer{};
+            buffer.reserve(1ULL << 15);
+
+            auto flush = [&]()
+            {
+                os.write(reinterpret_cast<char const *>(buffer.data()), buffer.size() * sizeof(uint64_t));
+                buffer.clear();
+            };
+
+            kmers.merge();
+            kmers.for_each(
+                [&](uint64_t const value)
+                {
+                    buffer.push_back(value);
+                    if (buffer.size() == buffer.capacity())
+                        flush();
+                });
+            flush();
+        }
+        std::filesystem::rename(tmp_file, kmer_file);
+    }
+
+    // Stores user bins relative to this node. Their indices differ when the checkpoint is loaded.
+    std::vector<int64_t> local_filename_indices{data.hibf.user_bins.bin_indices_of_ibf(ibf_pos)};
+    std::vector<std::string> filenames{};
+    std::unordered_map<int64_t, int64_t> local_index{};
+
+    for (int64_t & index : local_filename_indices)
+    {
+        if (index == -1)
+            continue;
+
+        auto [it, inserted] = local_index.try_emplace(index, filenames.size());
+        if (inserted)
+            filenames.push_back(data.hibf.user_bins.filename_of_user_bin(index));
+        index = it->second;
+    }
+
+    std::filesystem::path const tmp_file = detail::file_cache_tmp_path(ibf_file);
+    {
+        std::ofstream os{tmp_file, std::ios::binary};
+        cereal::BinaryOutputArchive oarchive{os};
+        oarchive(checkpoint_key(arguments));
+        if (data.hibf.is_uncompressed(ibf_pos))
+            oarchive(data.hibf.uncompressed_ibfs[ibf_pos]);
+        else
+            oarchive(data.hibf.ibf_vector[ibf_pos]);
+        oarchive(local_filename_indices, filenames);
+    }
+    std::filesystem::rename(tmp_file, ibf_file);
+}
+
+template <seqan3::data_layout data_layout_mode>
+bool has_checkpoint(lemon::ListDigraph::Node const & node,
+                    build_data<data_layout_mode> & data,
+                    build_arguments const & arguments)
+{
+    std::ifstream is{checkpoint_path(node, data, arguments, ".ibf"), std::ios::binary};
+    if (!is.good() || !std::filesystem::exists(checkpoint_path(node, data, arguments, ".kmers")))
+        return false;
+
+    std::string key{};
+    try
+    {
+        cereal::BinaryInputArchive iarchive{is};
+        iarchive(key);
+    }
+    catch (cereal::Exception const &)
+    {
+        return false;
+    }
+
+    return key == checkpoint_key(arguments);
+}
+
+template <seqan3::data_layout data_layout_mode>
+size_t load_checkpoint(kmer_runs & parent_kmers,
+                       lemon::ListDigraph::Node const & node,
+                       build_data<data_layout_mode> & data,
+                       build_arguments const & arguments)
+{
+    // The k-mers are read first, such that nothing is loaded from a corrupted checkpoint.
+    std::filesystem::path const kmer_file = checkpoint_path(node, data, arguments, ".kmers");
+    uint64_t const file_size = std::filesystem::file_size(kmer_file);
+    if (file_size % sizeof(uint64_t) != 0u)
+        throw std::runtime_error{"The checkpoint " + kmer_file.string() + " is corrupted."};
+
+    std::vector<uint64_t> kmers(file_size / sizeof(uint64_t));
+    std::ifstream is{kmer_file, std::ios::binary};
+    if (!is.read(reinterpret_cast<char *>(kmers.data()), file_size))
+        throw std::runtime_error{"The checkpoint " + kmer_file.string() + " could not be read."};
+
+    size_t const ibf_pos = load_subtree(node, data, arguments);
+    parent_kmers.push_back(std::move(kmers));
+
+    return ibf_pos;
+}
+
+template void store_checkpoint<seqan3::data_layout::uncompressed>(kmer_runs &,
+                                                                  size_t const,
+                                                                  lemon::ListDigraph::Node const &,
+                                                                  build_data<seqan3::data_layout::uncompressed> &,
+                                                                  build_arguments const &);
+
+template void store_checkpoint<seqan3::data_layout::compressed>(kmer_runs &,
+                                                                size_t const,
+                                                                lemon::ListDigraph::Node const &,
+                                                                build_data<seqan3::data_layout::compressed> &,
+                                                                build_arguments const &);
+
+template bool has_checkpoint<seqan3::data_layout::uncompressed>(lemon::ListDigraph::Node const &,
+                                                                build_data<seqan3::data_layout::uncompressed> &,
+                                                                build_arguments const &);
+
+template bool has_checkpoint<seqan3::data_layout::compressed>(lemon::ListDigraph::Node const &,
+                                                              build_data<seqan3::data_layout::compressed> &,
+                                                              build_arguments const &);
+
+template size_t load_checkpoint<seqan3::data_layout::uncompressed>(kmer_runs &,
+                                                                   lemon::ListDigraph::Node const &,
+                                                                   build_data<seqan3::data_layout::uncompressed> &,
+                                                                   build_arguments const &);
+
+template size_t load_checkpoint<seqan3::data_layout::compressed>(kmer_runs &,
+                                                                 lemon::ListDigraph::Node const &,
+                                                                 build_data<seqan3::data_layout::compressed> &,
+                                                                 build_arguments const &);
+
+} // namespace raptor::hibf
@@ -26,6 +26,7 @@ void chopper_build(build_arguments const & arguments)
     build_data<data_layout_mode> data{};
 
     create_ibfs_from_chopper_pack(data, arguments);
+    data.hibf.update_bin_runs();
 
     std::vector<std::vector<std::string>> bin_path{};
     for (size_t i{0}; i < data.hibf.user_bins.num_user_bins(); ++i)
@@ -14,29 +14,43 @@
 
 #include <raptor/adjust_seed.hpp>
 #include <raptor/build/hibf/compute_kmers.hpp>
+#include <raptor/build/hibf/sorted_kmers.hpp>
 #include <raptor/file_reader.hpp>
 
 namespace raptor::hibf
 {
 
-void compute_kmers(robin_hood::unordered_flat_set<size_t> & kmers,
+void compute_kmers(std::vector<uint64_t> & kmers,
                    build_arguments const & arguments,
-                   chopper_pack_record const & record)
+                   chopper_pack_record const & record,
+                   size_t const threads)
 {
     timer<concurrent::no> local_user_bin_io_timer{};
     local_user_bin_io_timer.start();
     if (arguments.input_is_minimiser)
     {
         file_reader<file_types::minimiser> const reader{};
-        reader.hash_into(record.filenames, std::inserter(kmers, kmers.begin()));
+        reader.for_each_span(record.filenames,
+                             [&kmers](std::span<uint64_t const> const values)
+                             {
+                                 kmers.insert(kmers.end(), values.begin(), values.end());
+                             });
     }
     else
     {
-        file_reader<file_types::sequence> const reader{arguments.shape, arguments.window_size};
-        reader.hash_into(record.filenames, std::inserter(kmers, kmers.begin()));
+        file_reader<file_types::sequence> const reader{arguments.shape,
+                                                       arguments.window_size,
+                                                       arguments.minimiser_cache_dir};
+        reader.hash_into(record.filenames, std::back_inserter(kmers));
     }
     local_user_bin_io_timer.stop();
     arguments.user_bin_io_timer += local_user_bin_io_timer;
+
+    timer<concurrent::no> local_merge_kmers_timer{};
+    local_merge_kmers_timer.start();
+    sort_and_deduplicate(kmers, threads);
+    local_merge_kmers_timer.stop();
+    arguments.merge_kmers_timer += local_merge_kmers_timer;
 }
 
 } // namespace raptor::hibf
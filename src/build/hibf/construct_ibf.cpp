@@ -16,13 +16,14 @@
 #include <raptor/build/hibf/construct_ibf.hpp>
 #include <raptor/build/hibf/insert_into_ibf.hpp>
 #include <raptor/build/hibf/update_parent_kmers.hpp>
+#include <raptor/huge_pages.hpp>
 
 namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-seqan3::interleaved_bloom_filter<> construct_ibf(robin_hood::unordered_flat_set<size_t> & parent_kmers,
-                                                 robin_hood::unordered_flat_set<size_t> & kmers,
+seqan3::interleaved_bloom_filter<> construct_ibf(kmer_runs & parent_kmers,
+                                                 kmer_runs & kmers,
                                                  size_t const number_of_bins,
                                                  lemon::ListDigraph::Node const & node,
                                                  build_data<data_layout_mode> & data,
@@ -31,7 +32,13 @@ seqan3::interleaved_bloom_filter<> construct_ibf(robin_hood::unordered_flat_set<
 {
     auto & node_data = data.node_map[node];
 
-    size_t const kmers_per_bin{static_cast<size_t>(std::ceil(static_cast<double>(kmers.size()) / number_of_bins))};
+    timer<concurrent::no> local_merge_kmers_timer{};
+    local_merge_kmers_timer.start();
+    size_t const kmer_count{kmers.count()};
+    local_merge_kmers_timer.stop();
+    arguments.merge_kmers_timer += local_merge_kmers_timer;
+
+    size_t const kmers_per_bin{static_cast<size_t>(std::ceil(static_cast<double>(kmer_count) / number_of_bins))};
     double const bin_bits{static_cast<double>(bin_size_in_bits(arguments, kmers_per_bin))};
     seqan3::bin_size const bin_size{static_cast<size_t>(std::ceil(bin_bits * data.fp_correction[number_of_bins]))};
     seqan3::bin_count const bin_count{node_data.number_of_technical_bins};
@@ -39,19 +46,23 @@ seqan3::interleaved_bloom_filter<> construct_ibf(robin_hood::unordered_flat_set<
     timer<concurrent::no> local_index_allocation_timer{};
     local_index_allocation_timer.start();
     seqan3::interleaved_bloom_filter<> ibf{bin_count, bin_size, seqan3::hash_function_count{arguments.hash}};
+    advise_huge_pages(ibf);
     local_index_allocation_timer.stop();
     arguments.index_allocation_timer += local_index_allocation_timer;
 
-    insert_into_ibf(kmers, number_of_bins, node_data.max_bin_index, ibf, arguments.fill_ibf_timer);
+    {
+        atomic_inserter inserter{ibf};
+        insert_into_ibf(kmers, number_of_bins, node_data.max_bin_index, inserter, arguments.fill_ibf_timer);
+    }
     if (!is_root)
-        update_parent_kmers(parent_kmers, kmers, arguments.merge_kmers_timer);
+        update_parent_kmers(parent_kmers, std::move(kmers), arguments.merge_kmers_timer);
 
     return ibf;
 }
 
 template seqan3::interleaved_bloom_filter<>
-construct_ibf<seqan3::data_layout::uncompressed>(robin_hood::unordered_flat_set<size_t> &,
-                                                 robin_hood::unordered_flat_set<size_t> &,
+construct_ibf<seqan3::data_layout::uncompressed>(kmer_runs &,
+                                                 kmer_runs &,
                                                  size_t const,
                                                  lemon::ListDigraph::Node const &,
                                                  build_data<seqan3::data_layout::uncompressed> &,
@@ -59,8 +70,8 @@ construct_ibf<seqan3::data_layout::uncompressed>(robin_hood::unordered_flat_set<
                                                  bool);
 
 template seqan3::interleaved_bloom_filter<>
-construct_ibf<seqan3::data_layout::compressed>(robin_hood::unordered_flat_set<size_t> &,
-                                               robin_hood::unordered_flat_set<size_t> &,
+construct_ibf<seqan3::data_layout::compressed>(kmer_runs &,
+                                               kmer_runs &,
                                                size_t const,
                                                lemon::ListDigraph::Node const &,
                                                build_data<seqan3::data_layout::compressed> &,
@@ -22,13 +22,22 @@ namespace raptor::hibf
 template <seqan3::data_layout data_layout_mode>
 void create_ibfs_from_chopper_pack(build_data<data_layout_mode> & data, build_arguments const & arguments)
 {
-    read_chopper_pack_file(data, arguments.bin_file);
+    data.uncompressed_levels = arguments.uncompressed_levels;
+    read_chopper_pack_file(data, arguments.bin_file, arguments.threads);
     lemon::ListDigraph::Node root = data.ibf_graph.nodeFromId(0); // root node = high level IBF node
-    robin_hood::unordered_flat_set<size_t> root_kmers{};
+    kmer_runs root_kmers{};
+
+    if (arguments.memory_limit > 0u)
+    {
+        std::filesystem::path tmp_prefix{arguments.out_path};
+        tmp_prefix += ".tmp";
+        data.spill.configure(arguments.memory_limit << 20, std::move(tmp_prefix));
+    }
 
     size_t const t_max{data.node_map[root].number_of_technical_bins};
     data.compute_fp_correction(t_max, arguments.hash, arguments.fpr);
 
+    data.pool.start(arguments.threads);
     hierarchical_build(root_kmers, root, data, arguments, true);
 }
 
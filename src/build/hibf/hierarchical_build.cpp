@@ -12,6 +12,13 @@
 
 #include <lemon/list_graph.h> /// Must be first include.
 
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <utility>
+
+#include <raptor/build/hibf/checkpoint.hpp>
 #include <raptor/build/hibf/compute_kmers.hpp>
 #include <raptor/build/hibf/construct_ibf.hpp>
 #include <raptor/build/hibf/hierarchical_build.hpp>
@@ -24,21 +31,93 @@ namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-size_t hierarchical_build(robin_hood::unordered_flat_set<size_t> & parent_kmers,
+size_t hierarchical_build(kmer_runs & parent_kmers,
                           lemon::ListDigraph::Node const & current_node,
                           build_data<data_layout_mode> & data,
                           build_arguments const & arguments,
                           bool is_root)
 {
+    bool const use_checkpoints{!is_root && !arguments.checkpoint_dir.empty()};
+    if (use_checkpoints && has_checkpoint(current_node, data, arguments))
+        return load_checkpoint(parent_kmers, current_node, data, arguments);
+
     auto & current_node_data = data.node_map[current_node];
 
-    size_t const ibf_pos{data.request_ibf_idx()};
+    size_t const ibf_pos{current_node_data.ibf_position};
 
     std::vector<int64_t> ibf_positions(current_node_data.number_of_technical_bins, ibf_pos);
     std::vector<int64_t> filename_indices(current_node_data.number_of_technical_bins, -1);
-    robin_hood::unordered_flat_set<size_t> kmers{};
+    kmer_runs max_bin_kmers{data.spill};
+
+    seqan3::interleaved_bloom_filter<> ibf{};
+    // Set once the IBF is constructed. Records and merged bins are inserted concurrently via atomic fetch-or.
+    std::optional<atomic_inserter> inserter{};
+
+    // The k-mers of merged bins stay in their merged_bin and are added to the parent once all children are inserted.
+    auto insert_merged_bin = [&](merged_bin & bin)
+    {
+        ibf_positions[bin.parent_bin_index] = bin.ibf_pos;
+        insert_into_ibf(bin.kmers, 1, bin.parent_bin_index, *inserter, arguments.fill_ibf_timer);
+
+        if (is_root)
+            bin.kmers = kmer_runs{};
+    };
+
+    // The subtrees of all other merged bins are built while the favourite child and the IBF are built. A finished
+    // subtree is inserted into the IBF as soon as the IBF exists. Until then, its k-mers are kept. To bound the memory,
+    // at most `arguments.threads` subtrees of this node are built or kept at the same time.
+    std::vector<merged_bin> merged_bins = loop_over_children(current_node, data);
+    std::mutex merged_bins_mutex{};
+    size_t next_merged_bin{};
+    size_t merged_bins_in_flight{};
+    bool ibf_constructed{false};
+    std::vector<size_t> finished_merged_bins{};
+    // Declared before `children_tasks`, whose destructor waits for the tasks that call it.
+    std::function<void()> start_merged_bins{};
+    task_group children_tasks{data.pool};
+
+    // Must be called while holding `merged_bins_mutex`.
+    start_merged_bins = [&]()
+    {
+        for (; next_merged_bin < merged_bins.size() && merged_bins_in_flight < arguments.threads; ++next_merged_bin)
+        {
+            ++merged_bins_in_flight;
+            children_tasks.run(
+                [&, i = next_merged_bin]()
+                {
+                    merged_bin & bin = merged_bins[i];
+                    bin.ibf_pos = hierarchical_build(bin.kmers, bin.child, data, arguments, false);
 
-    auto initialise_max_bin_kmers = [](robin_hood::unordered_flat_set<size_t> & kmers,
+                    timer<concurrent::no> local_merge_kmers_timer{};
+                    local_merge_kmers_timer.start();
+                    bin.kmers.merge();
+                    local_merge_kmers_timer.stop();
+                    arguments.merge_kmers_timer += local_merge_kmers_timer;
+
+                    {
+                        std::lock_guard<std::mutex> guard{merged_bins_mutex};
+                        if (!ibf_constructed)
+                        {
+                            finished_merged_bins.push_back(i);
+                            return;
+                        }
+                    }
+
+                    insert_merged_bin(bin);
+
+                    std::lock_guard<std::mutex> guard{merged_bins_mutex};
+                    --merged_bins_in_flight;
+                    start_merged_bins();
+                });
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> guard{merged_bins_mutex};
+        start_merged_bins();
+    }
+
+    auto initialise_max_bin_kmers = [](kmer_runs & max_bin_kmers,
                                        std::vector<int64_t> & ibf_positions,
                                        std::vector<int64_t> & filename_indices,
                                        lemon::ListDigraph::Node const & node,
@@ -51,15 +130,17 @@ size_t hierarchical_build(robin_hood::unordered_flat_set<size_t> & parent_kmers,
         {
             // recursively initialize favourite child first
             ibf_positions[node_data.max_bin_index] =
-                hierarchical_build(kmers, node_data.favourite_child, data, arguments, false);
+                hierarchical_build(max_bin_kmers, node_data.favourite_child, data, arguments, false);
             return 1;
         }
         else // max bin is not a merged bin
         {
             // we assume that the max record is at the beginning of the list of remaining records.
             auto const & record = node_data.remaining_records[0];
+            std::vector<uint64_t> kmers{};
             compute_kmers(kmers, arguments, record);
-            update_user_bins(data, filename_indices, record);
+            max_bin_kmers.push_back(std::move(kmers));
+            update_user_bins(data, filename_indices, record, node_data.user_bin_positions[0]);
 
             return record.number_of_bins.back();
         }
@@ -67,53 +148,107 @@ size_t hierarchical_build(robin_hood::unordered_flat_set<size_t> & parent_kmers,
 
     // initialize lower level IBF
     size_t const max_bin_tbs =
-        initialise_max_bin_kmers(kmers, ibf_positions, filename_indices, current_node, data, arguments);
-    auto && ibf = construct_ibf(parent_kmers, kmers, max_bin_tbs, current_node, data, arguments, is_root);
-    kmers.clear(); // reduce memory peak
+        initialise_max_bin_kmers(max_bin_kmers, ibf_positions, filename_indices, current_node, data, arguments);
+    ibf = construct_ibf(parent_kmers, max_bin_kmers, max_bin_tbs, current_node, data, arguments, is_root);
+    max_bin_kmers = kmer_runs{}; // reduce memory peak
+    inserter.emplace(ibf);
 
-    // parse all other children (merged bins) of the current ibf
-    loop_over_children(parent_kmers, ibf, ibf_positions, current_node, data, arguments, is_root);
+    // Insert the subtrees that finished before the IBF existed.
+    {
+        std::unique_lock<std::mutex> lock{merged_bins_mutex};
+        ibf_constructed = true;
+        std::vector<size_t> const finished = std::exchange(finished_merged_bins, {});
+        lock.unlock();
+
+        for (size_t const i : finished)
+            insert_merged_bin(merged_bins[i]);
+
+        lock.lock();
+        merged_bins_in_flight -= finished.size();
+        start_merged_bins();
+    }
+
+    task_group tasks{data.pool};
 
     // If max bin was a merged bin, process all remaining records, otherwise the first one has already been processed
     size_t const start{(current_node_data.favourite_child != lemon::INVALID) ? 0u : 1u};
-    for (size_t i = start; i < current_node_data.remaining_records.size(); ++i)
+    std::vector<size_t> record_order(current_node_data.remaining_records.size() - start);
+    std::iota(record_order.begin(), record_order.end(), start);
+    // Largest records first. The layout splits user bins according to their size.
+    std::ranges::stable_sort(record_order,
+                             std::ranges::greater{},
+                             [&current_node_data](size_t const i)
+                             {
+                                 return current_node_data.remaining_records[i].number_of_bins.back();
+                             });
+
+    // The k-mers of each record are kept in their own slot. Hence, the tasks do not need to synchronise.
+    std::vector<kmer_runs> record_kmers{};
+    if (!is_root)
     {
-        auto const & record = current_node_data.remaining_records[i];
+        record_kmers.reserve(current_node_data.remaining_records.size());
+        for (size_t i = 0; i < current_node_data.remaining_records.size(); ++i)
+            record_kmers.emplace_back(data.spill);
+    }
 
-        if (is_root && record.number_of_bins.back() == 1) // no splitting needed
-        {
-            insert_into_ibf(arguments, record, ibf);
-        }
-        else
-        {
-            compute_kmers(kmers, arguments, record);
-            insert_into_ibf(kmers,
-                            record.number_of_bins.back(),
-                            record.bin_indices.back(),
-                            ibf,
-                            arguments.fill_ibf_timer);
-            if (!is_root)
-                update_parent_kmers(parent_kmers, kmers, arguments.merge_kmers_timer);
-        }
+    for (size_t const i : record_order)
+    {
+        tasks.run(
+            [&, i]()
+            {
+                auto const & record = current_node_data.remaining_records[i];
+                size_t const number_of_bins = record.number_of_bins.back();
+                size_t const bin_index = record.bin_indices.back();
+
+                if (is_root && number_of_bins == 1) // no splitting needed
+                {
+                    insert_into_ibf(arguments, record, *inserter);
+                }
+                else
+                {
+                    std::vector<uint64_t> kmers{};
+                    compute_kmers(kmers, arguments, record);
+                    insert_into_ibf(kmers, number_of_bins, bin_index, *inserter, arguments.fill_ibf_timer);
+                    if (!is_root)
+                        record_kmers[i].push_back(std::move(kmers));
+                }
+
+                update_user_bins(data, filename_indices, record, current_node_data.user_bin_positions[i]);
+            });
+    }
+
+    // parse all other children (merged bins) of the current ibf
+    children_tasks.wait();
+    tasks.wait();
+    inserter.reset();
 
-        update_user_bins(data, filename_indices, record);
-        kmers.clear();
+    if (!is_root)
+    {
+        for (kmer_runs & kmers : record_kmers)
+            if (!kmers.empty())
+                update_parent_kmers(parent_kmers, std::move(kmers), arguments.merge_kmers_timer);
+        for (merged_bin & bin : merged_bins)
+            update_parent_kmers(parent_kmers, std::move(bin.kmers), arguments.merge_kmers_timer);
     }
 
-    data.hibf.ibf_vector[ibf_pos] = std::move(ibf);
+    data.hibf.store_ibf(ibf_pos, std::move(ibf), data.keep_uncompressed(current_node));
     data.hibf.next_ibf_id[ibf_pos] = std::move(ibf_positions);
     data.hibf.user_bins.bin_indices_of_ibf(ibf_pos) = std::move(filename_indices);
 
+    // parent_kmers only contains the k-mers of this subtree.
+    if (use_checkpoints)
+        store_checkpoint(parent_kmers, ibf_pos, current_node, data, arguments);
+
     return ibf_pos;
 }
 
-template size_t hierarchical_build<seqan3::data_layout::uncompressed>(robin_hood::unordered_flat_set<size_t> &,
+template size_t hierarchical_build<seqan3::data_layout::uncompressed>(kmer_runs &,
                                                                       lemon::ListDigraph::Node const &,
                                                                       build_data<seqan3::data_layout::uncompressed> &,
                                                                       build_arguments const &,
                                                                       bool);
 
-template size_t hierarchical_build<seqan3::data_layout::compressed>(robin_hood::unordered_flat_set<size_t> &,
+template size_t hierarchical_build<seqan3::data_layout::compressed>(kmer_runs &,
                                                                     lemon::ListDigraph::Node const &,
                                                                     build_data<seqan3::data_layout::compressed> &,
                                                                     build_arguments const &,
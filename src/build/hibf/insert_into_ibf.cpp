@@ -13,6 +13,7 @@
 #include <seqan3/search/views/minimiser_hash.hpp>
 
 #include <raptor/adjust_seed.hpp>
+#include <raptor/build/emplace_iterator.hpp>
 #include <raptor/build/hibf/insert_into_ibf.hpp>
 #include <raptor/file_reader.hpp>
 
@@ -20,10 +21,10 @@ namespace raptor::hibf
 {
 
 // automatically does naive splitting if number_of_bins > 1
-void insert_into_ibf(robin_hood::unordered_flat_set<size_t> const & kmers,
+void insert_into_ibf(std::vector<uint64_t> const & kmers,
                      size_t const number_of_bins,
                      size_t const bin_index,
-                     seqan3::interleaved_bloom_filter<> & ibf,
+                     atomic_inserter & ibf,
                      timer<concurrent::yes> & fill_ibf_timer)
 {
     size_t const chunk_size = kmers.size() / number_of_bins + 1;
@@ -43,34 +44,51 @@ void insert_into_ibf(robin_hood::unordered_flat_set<size_t> const & kmers,
     fill_ibf_timer += local_fill_ibf_timer;
 }
 
-void insert_into_ibf(build_arguments const & arguments,
-                     chopper_pack_record const & record,
-                     seqan3::interleaved_bloom_filter<> & ibf)
+void insert_into_ibf(kmer_runs & kmers,
+                     size_t const number_of_bins,
+                     size_t const bin_index,
+                     atomic_inserter & ibf,
+                     timer<concurrent::yes> & fill_ibf_timer)
+{
+    // Splitting needs the number of k-mers, which requires merging the runs.
+    size_t const chunk_size = (number_of_bins == 1u) ? 1u : kmers.count() / number_of_bins + 1;
+    size_t position{};
+
+    timer<concurrent::no> local_fill_ibf_timer{};
+    local_fill_ibf_timer.start();
+    kmers.for_each(
+        [&](uint64_t const value)
+        {
+            size_t const chunk_number = (number_of_bins == 1u) ? 0u : position++ / chunk_size;
+            assert(chunk_number < number_of_bins);
+            ibf.emplace(value, seqan3::bin_index{bin_index + chunk_number});
+        });
+    local_fill_ibf_timer.stop();
+    fill_ibf_timer += local_fill_ibf_timer;
+}
+
+void insert_into_ibf(build_arguments const & arguments, chopper_pack_record const & record, atomic_inserter & ibf)
 {
     auto const bin_index = seqan3::bin_index{static_cast<size_t>(record.bin_indices.back())};
-    std::vector<uint64_t> values;
 
-    timer<concurrent::no> local_user_bin_io_timer{};
-    local_user_bin_io_timer.start();
+    // Reading and inserting are not separated anymore, hence the time is counted for both.
+    timer<concurrent::no> local_timer{};
+    local_timer.start();
     if (arguments.input_is_minimiser)
     {
         file_reader<file_types::minimiser> const reader{};
-        reader.hash_into(record.filenames, std::back_inserter(values));
+        reader.hash_into(record.filenames, emplacer(ibf, bin_index));
     }
     else
     {
-        file_reader<file_types::sequence> const reader{arguments.shape, arguments.window_size};
-        reader.hash_into(record.filenames, std::back_inserter(values));
+        file_reader<file_types::sequence> const reader{arguments.shape,
+                                                       arguments.window_size,
+                                                       arguments.minimiser_cache_dir};
+        reader.hash_into(record.filenames, emplacer(ibf, bin_index));
     }
-    local_user_bin_io_timer.stop();
-    arguments.user_bin_io_timer += local_user_bin_io_timer;
-
-    timer<concurrent::no> local_fill_ibf_timer{};
-    local_fill_ibf_timer.start();
-    for (auto && value : values)
-        ibf.emplace(value, bin_index);
-    local_fill_ibf_timer.stop();
-    arguments.fill_ibf_timer += local_fill_ibf_timer;
+    local_timer.stop();
+    arguments.user_bin_io_timer += local_timer;
+    arguments.fill_ibf_timer += local_timer;
 }
 
 } // namespace raptor::hibf
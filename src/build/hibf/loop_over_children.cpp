@@ -12,90 +12,43 @@
 
 #include <lemon/list_graph.h> /// Must be first include.
 
-#include <seqan3/core/algorithm/detail/execution_handler_parallel.hpp>
+#include <algorithm>
 
-#include <raptor/build/hibf/hierarchical_build.hpp>
-#include <raptor/build/hibf/insert_into_ibf.hpp>
 #include <raptor/build/hibf/loop_over_children.hpp>
-#include <raptor/build/hibf/update_parent_kmers.hpp>
 
 namespace raptor::hibf
 {
 
 template <seqan3::data_layout data_layout_mode>
-void loop_over_children(robin_hood::unordered_flat_set<size_t> & parent_kmers,
-                        seqan3::interleaved_bloom_filter<> & ibf,
-                        std::vector<int64_t> & ibf_positions,
-                        lemon::ListDigraph::Node const & current_node,
-                        build_data<data_layout_mode> & data,
-                        build_arguments const & arguments,
-                        bool is_root)
+std::vector<merged_bin> loop_over_children(lemon::ListDigraph::Node const & current_node,
+                                           build_data<data_layout_mode> & data)
 {
     auto & current_node_data = data.node_map[current_node];
-    std::vector<lemon::ListDigraph::Node> children{};
+    std::vector<merged_bin> merged_bins{};
 
     for (lemon::ListDigraph::OutArcIt arc_it(data.ibf_graph, current_node); arc_it != lemon::INVALID; ++arc_it)
-        children.emplace_back(data.ibf_graph.target(arc_it));
-
-    if (children.empty())
-        return;
-
-    size_t const number_of_mutex = (data.node_map[current_node].number_of_technical_bins + 63) / 64;
-    std::vector<std::mutex> local_ibf_mutex(number_of_mutex);
-
-    auto worker = [&](auto && index, auto &&)
     {
-        auto & child = children[index];
-
+        lemon::ListDigraph::Node const child = data.ibf_graph.target(arc_it);
         if (child != current_node_data.favourite_child)
-        {
-            robin_hood::unordered_flat_set<size_t> kmers{};
-            size_t const ibf_pos = hierarchical_build(kmers, child, data, arguments, false);
-            auto parent_bin_index = data.node_map[child].parent_bin_index;
-            {
-                size_t const mutex_id{parent_bin_index / 64};
-                std::lock_guard<std::mutex> guard{local_ibf_mutex[mutex_id]};
-                ibf_positions[parent_bin_index] = ibf_pos;
-                insert_into_ibf(kmers, 1, parent_bin_index, ibf, arguments.fill_ibf_timer);
-                if (!is_root)
-                    update_parent_kmers(parent_kmers, kmers, arguments.merge_kmers_timer);
-            }
-        }
-    };
-
-    size_t number_of_threads{};
-    std::vector<size_t> indices(children.size());
-    std::iota(indices.begin(), indices.end(), size_t{});
-
-    if (is_root)
-    {
-        // Shuffle indices: More likely to not block each other. Optimal: Interleave
-        std::shuffle(indices.begin(), indices.end(), std::mt19937_64{std::random_device{}()});
-        number_of_threads = arguments.threads;
-    }
-    else
-    {
-        number_of_threads = 1u;
+            merged_bins.push_back(merged_bin{child, data.node_map[child].parent_bin_index, 0u, kmer_runs{data.spill}});
     }
 
-    seqan3::detail::execution_handler_parallel executioner{number_of_threads};
-    executioner.bulk_execute(std::move(worker), std::move(indices), []() {});
+    std::ranges::stable_sort(merged_bins,
+                             std::ranges::greater{},
+                             [&data](merged_bin const & bin)
+                             {
+                                 return data.node_map[bin.child].estimated_size;
+                             });
+
+    return merged_bins;
 }
 
-template void loop_over_children<seqan3::data_layout::uncompressed>(robin_hood::unordered_flat_set<size_t> &,
-                                                                    seqan3::interleaved_bloom_filter<> &,
-                                                                    std::vector<int64_t> &,
-                                                                    lemon::ListDigraph::Node const &,
-                                                                    build_data<seqan3::data_layout::uncompressed> &,
-                                                                    build_arguments const &,
-                                                                    bool);
+template std::vector<merged_bin>
+loop_over_children<seqan3::data_layout::uncompressed>(lemon::ListDigraph::Node const &,
+                                                      build_data<seqan3::data_layout::uncompressed> &);
 
-template void loop_over_children<seqan3::data_layout::compressed>(robin_hood::unordered_flat_set<size_t> &,
-                                                                  seqan3::interleaved_bloom_filter<> &,
-                                                                  std::vector<int64_t> &,
-                                                                  lemon::ListDigraph::Node const &,
-                                                                  build_data<seqan3::data_layout::compressed> &,
-                                                                  build_arguments const &,
-                                                                  bool);
+template std::vector<merged_bin>
+loop_over_children<seqan3::data_layout::compressed>(lemon::ListDigraph::Node const &,
+                                                    build_data<seqan3::data_layout::compressed> &);
 
 } // namespace raptor::hibf
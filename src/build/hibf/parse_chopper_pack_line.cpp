@@ -55,6 +55,17 @@ chopper_pack_record parse_chopper_pack_line(std::string const & current_line)
     }
     while (field_end != buffer_end && *field_end != '\t');
 
+    if (field_end == buffer_end) // no estimated sizes
+        return result;
+
+    do // read estimated maximum technical bin sizes
+    {
+        ++field_end; // skip tab or ;
+        field_end = std::from_chars(field_end, buffer_end, tmp).ptr;
+        result.estimated_sizes.push_back(tmp);
+    }
+    while (field_end != buffer_end && *field_end != '\t');
+
     return result;
 }
 
@@ -12,15 +12,69 @@
 
 #include <lemon/list_graph.h> /// Must be first include.
 
+#include <algorithm>
+#include <filesystem>
+#include <limits>
+
+#include <raptor/build/hibf/loop_over_children.hpp>
 #include <raptor/build/hibf/parse_chopper_pack_header.hpp>
 #include <raptor/build/hibf/parse_chopper_pack_line.hpp>
 #include <raptor/build/hibf/read_chopper_pack_file.hpp>
+#include <raptor/search/do_parallel.hpp>
 
 namespace raptor::hibf
 {
 
+/*!\brief The estimated number of k-mers of the record, or the size of its files if the layout contains no estimates.
+ * \details Only used to compare records and subtrees of the same layout.
+ */
+static size_t estimate_record_size(chopper_pack_record const & record)
+{
+    if (!record.estimated_sizes.empty())
+        return record.estimated_sizes.back() * record.number_of_bins.back();
+
+    size_t size{};
+    std::error_code ec{};
+    for (auto const & filename : record.filenames)
+    {
+        size_t const file_size = std::filesystem::file_size(filename, ec);
+        size += ec ? 0u : file_size;
+    }
+    return size;
+}
+
+/*!\brief Assigns the IBF and user bin positions of the subtree of `node`.
+ * \details The positions are those of a build with one thread: Depth-first, the max bin first, then the other merged
+ *          bins largest first, then the remaining records. Hence, the numbering does not depend on the number of
+ *          threads or on the order in which the tasks of the build finish.
+ */
 template <seqan3::data_layout data_layout_mode>
-void read_chopper_pack_file(build_data<data_layout_mode> & data, std::string const & chopper_pack_filename)
+static void assign_positions(lemon::ListDigraph::Node const & node,
+                             build_data<data_layout_mode> & data,
+                             size_t & ibf_number,
+                             size_t & user_bin_number)
+{
+    auto & node_data = data.node_map[node];
+    node_data.ibf_position = ibf_number++;
+    node_data.user_bin_positions.resize(node_data.remaining_records.size());
+
+    size_t next_record{};
+    if (node_data.favourite_child != lemon::INVALID) // max bin is a merged bin
+        assign_positions(node_data.favourite_child, data, ibf_number, user_bin_number);
+    else // the max record is at the beginning of the remaining records
+        node_data.user_bin_positions[next_record++] = user_bin_number++;
+
+    for (merged_bin const & bin : loop_over_children(node, data))
+        assign_positions(bin.child, data, ibf_number, user_bin_number);
+
+    for (; next_record < node_data.remaining_records.size(); ++next_record)
+        node_data.user_bin_positions[next_record] = user_bin_number++;
+}
+
+template <seqan3::data_layout data_layout_mode>
+void read_chopper_pack_file(build_data<data_layout_mode> & data,
+                            std::string const & chopper_pack_filename,
+                            size_t const threads)
 {
     std::ifstream chopper_pack_file{chopper_pack_filename};
 
@@ -31,14 +85,48 @@ void read_chopper_pack_file(build_data<data_layout_mode> & data, std::string con
     // -------------------------------------------------------------------------
     data.number_of_ibfs = parse_chopper_pack_header(data.ibf_graph, data.node_map, chopper_pack_file) + 1;
 
+    // child of each (node id, parent bin index)
+    // -------------------------------------------------------------------------
+    std::vector<std::vector<lemon::ListDigraph::Node>> children(data.ibf_graph.maxNodeId() + 1);
+    for (lemon::ListDigraph::ArcIt arc_it(data.ibf_graph); arc_it != lemon::INVALID; ++arc_it)
+    {
+        lemon::ListDigraph::Node const target = data.ibf_graph.target(arc_it);
+        size_t const bin = data.node_map[target].parent_bin_index;
+        auto & children_of_node = children[data.ibf_graph.id(data.ibf_graph.source(arc_it))];
+
+        if (children_of_node.size() <= bin)
+            children_of_node.resize(bin + 1, lemon::INVALID);
+        children_of_node[bin] = target;
+    }
+
     // parse lines
     // -------------------------------------------------------------------------
-    std::string current_line;
-    size_t user_bins{};
-    while (std::getline(chopper_pack_file, current_line))
+    std::vector<std::string> lines{};
+    for (std::string line; std::getline(chopper_pack_file, line);)
+        lines.push_back(std::move(line));
+
+    size_t const user_bins{lines.size()};
+    std::vector<chopper_pack_record> records(user_bins);
+    std::vector<size_t> record_sizes(user_bins);
+
+    auto worker = [&](size_t const start, size_t const end)
+    {
+        for (size_t i = start; i < end; ++i)
+        {
+            records[i] = parse_chopper_pack_line(lines[i]);
+            record_sizes[i] = estimate_record_size(records[i]);
+        }
+    };
+    do_parallel(worker, user_bins, std::max<size_t>(1u, std::min<size_t>(threads, user_bins)));
+    lines = std::vector<std::string>{};
+
+    // position of the max record in remaining_records of each node
+    std::vector<size_t> max_record_position(children.size(), std::numeric_limits<size_t>::max());
+
+    for (size_t r = 0; r < user_bins; ++r)
     {
-        ++user_bins;
-        chopper_pack_record const && record = parse_chopper_pack_line(current_line);
+        chopper_pack_record & record = records[r];
+        size_t const record_size = record_sizes[r];
 
         // go down the tree until you find the matching parent
         lemon::ListDigraph::Node current_node = data.ibf_graph.nodeFromId(0); // start at root
@@ -51,23 +139,11 @@ void read_chopper_pack_file(build_data<data_layout_mode> & data, std::string con
 
             // update number of technical bins in current_node-IBF
             current_data.number_of_technical_bins = std::max(current_data.number_of_technical_bins, bin + num_tbs);
+            current_data.estimated_size += record_size;
 
-#ifndef NDEBUG
-            bool found_next_node{false}; // sanity check
-#endif
-            for (lemon::ListDigraph::OutArcIt arc_it(data.ibf_graph, current_node); arc_it != lemon::INVALID; ++arc_it)
-            {
-                auto target = data.ibf_graph.target(arc_it);
-                if (data.node_map[target].parent_bin_index == bin)
-                {
-                    current_node = target;
-#ifndef NDEBUG
-                    found_next_node = true;
-#endif
-                    break;
-                }
-            }
-            assert(found_next_node);
+            auto const & children_of_node = children[data.ibf_graph.id(current_node)];
+            assert(bin < children_of_node.size() && children_of_node[bin] != lemon::INVALID); // sanity check
+            current_node = children_of_node[bin];
         }
 
         size_t const bin = record.bin_indices.back();
@@ -76,21 +152,39 @@ void read_chopper_pack_file(build_data<data_layout_mode> & data, std::string con
 
         // update number of technical bins in current_node-IBF
         current_data.number_of_technical_bins = std::max(current_data.number_of_technical_bins, bin + num_tbs);
+        current_data.estimated_size += record_size;
 
         if (record.bin_indices.back() == current_data.max_bin_index)
-            current_data.remaining_records.insert(current_data.remaining_records.begin(), record);
-        else
-            current_data.remaining_records.push_back(record);
+            max_record_position[data.ibf_graph.id(current_node)] = current_data.remaining_records.size();
+        current_data.remaining_records.push_back(std::move(record));
+    }
+
+    // The max record is expected at the beginning of the remaining records.
+    for (lemon::ListDigraph::NodeIt node_it(data.ibf_graph); node_it != lemon::INVALID; ++node_it)
+    {
+        size_t const position = max_record_position[data.ibf_graph.id(node_it)];
+        if (position == std::numeric_limits<size_t>::max())
+            continue;
+
+        auto const records_begin = data.node_map[node_it].remaining_records.begin();
+        std::rotate(records_begin, records_begin + position, records_begin + position + 1);
     }
 
+    size_t ibf_number{};
+    size_t user_bin_number{};
+    assign_positions(data.ibf_graph.nodeFromId(0), data, ibf_number, user_bin_number);
+    assert(ibf_number == data.number_of_ibfs && user_bin_number == user_bins);
+
     data.number_of_user_bins = user_bins;
     data.resize();
 }
 
 template void read_chopper_pack_file<seqan3::data_layout::uncompressed>(build_data<seqan3::data_layout::uncompressed> &,
-                                                                        std::string const &);
+                                                                        std::string const &,
+                                                                        size_t const);
 
 template void read_chopper_pack_file<seqan3::data_layout::compressed>(build_data<seqan3::data_layout::compressed> &,
-                                                                      std::string const &);
+                                                                      std::string const &,
+                                                                      size_t const);
 
 } // namespace raptor::hibf
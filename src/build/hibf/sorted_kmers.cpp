@@ -0,0 +1,234 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Implements raptor::hibf::sort_and_deduplicate, raptor::hibf::kmer_spill, and raptor::hibf::kmer_runs.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include <raptor/build/hibf/sorted_kmers.hpp>
+#include <raptor/io/temporary_directory.hpp>
+#include <raptor/radix_sort.hpp>
+
+namespace raptor::hibf
+{
+
+void sort_and_deduplicate(std::vector<uint64_t> & kmers, size_t const threads)
+{
+    raptor::detail::radix_sort(kmers, threads);
+
+    auto const duplicates = std::ranges::unique(kmers);
+    kmers.erase(duplicates.begin(), duplicates.end());
+}
+
+kmer_spill::~kmer_spill()
+{
+    if (!directory.empty())
+    {
+        std::error_code ec{};
+        std::filesystem::remove_all(directory, ec);
+    }
+}
+
+void kmer_spill::configure(size_t const limit, std::filesystem::path tmp_prefix)
+{
+    memory_limit = limit;
+    prefix = std::move(tmp_prefix);
+}
+
+bool kmer_spill::reserve(size_t const bytes) noexcept
+{
+    size_t current = used_memory.load();
+    do
+    {
+        if (current + bytes > memory_limit)
+            return false;
+    }
+    while (!used_memory.compare_exchange_weak(current, current + bytes));
+
+    return true;
+}
+
+void kmer_spill::release(size_t const bytes) noexcept
+{
+    used_memory -= bytes;
+}
+
+std::filesystem::path kmer_spill::new_file()
+{
+    std::lock_guard<std::mutex> guard{directory_mutex};
+    if (directory.empty())
+        directory = raptor::detail::create_temporary_directory(prefix);
+
+    return directory / ("run_" + std::to_string(file_counter++) + ".kmers");
+}
+
+kmer_runs::kmer_runs(kmer_runs && other) noexcept :
+    spill{other.spill},
+    memory_runs{std::move(other.memory_runs)},
+    file_runs{std::move(other.file_runs)},
+    memory_bytes{std::exchange(other.memory_bytes, 0u)}
+{
+    other.memory_runs.clear();
+    other.file_runs.clear();
+}
+
+kmer_runs & kmer_runs::operator=(kmer_runs && other) noexcept
+{
+    if (this != std::addressof(other))
+    {
+        clear();
+        spill = other.spill;
+        memory_runs = std::move(other.memory_runs);
+        file_runs = std::move(other.file_runs);
+        memory_bytes = std::exchange(other.memory_bytes, 0u);
+        other.memory_runs.clear();
+        other.file_runs.clear();
+    }
+    return *this;
+}
+
+kmer_runs::~kmer_runs()
+{
+    clear();
+}
+
+void kmer_runs::clear()
+{
+    if (spill != nullptr && spill->enabled())
+        spill->release(memory_bytes);
+
+    for (auto const & path : file_runs)
+    {
+        std::error_code ec{};
+        std::filesystem::remove(path, ec);
+    }
+
+    memory_runs.clear();
+    file_runs.clear();
+    memory_bytes = 0u;
+}
+
+void kmer_runs::push_back(std::vector<uint64_t> && run)
+{
+    if (run.empty())
+        return;
+
+    size_t const bytes = run.size() * sizeof(uint64_t);
+
+    if (spill != nullptr && spill->enabled() && !spill->reserve(bytes))
+    {
+        std::filesystem::path const path = spill->new_file();
+        std::ofstream file{path, std::ios::binary};
+        file.write(reinterpret_cast<char const *>(run.data()), bytes);
+        if (!file)
+            throw std::runtime_error{"Could not write temporary k-mer file " + path.string()}; // GCOVR_EXCL_LINE
+        file_runs.push_back(path);
+        run = std::vector<uint64_t>{};
+
+        if (file_runs.size() > max_file_runs)
+            merge();
+        return;
+    }
+
+    memory_runs.push_back(std::move(run));
+    memory_bytes += bytes;
+}
+
+void kmer_runs::push_back(kmer_runs && other)
+{
+    other.merge();
+
+    // The memory of `other` has already been reserved.
+    for (auto & run : other.memory_runs)
+        memory_runs.push_back(std::move(run));
+    memory_bytes += std::exchange(other.memory_bytes, 0u);
+    other.memory_runs.clear();
+
+    for (auto & path : other.file_runs)
+        file_runs.push_back(std::move(path));
+    other.file_runs.clear();
+
+    if (file_runs.size() > max_file_runs)
+        merge();
+}
+
+void kmer_runs::merge()
+{
+    if (memory_runs.size() + file_runs.size() <= 1u)
+        return;
+
+    bool const spill_enabled = spill != nullptr && spill->enabled();
+    size_t const old_bytes = memory_bytes;
+
+    // The merged run needs at most as much memory as all memory runs.
+    if (file_runs.empty() && (!spill_enabled || spill->reserve(old_bytes)))
+    {
+        std::vector<uint64_t> result{};
+        result.reserve(old_bytes / sizeof(uint64_t));
+        for_each(
+            [&result](uint64_t const value)
+            {
+                result.push_back(value);
+            });
+
+        size_t const new_bytes = result.size() * sizeof(uint64_t);
+        clear();
+        if (spill_enabled)
+            spill->release(old_bytes - new_bytes);
+
+        memory_runs.push_back(std::move(result));
+        memory_bytes = new_bytes;
+        return;
+    }
+
+    std::filesystem::path const path = spill->new_file();
+    {
+        std::ofstream file{path, std::ios::binary};
+        std::vector<uint64_t> buffer{};
+        buffer.reserve(1ULL << 15);
+
+        auto flush = [&]()
+        {
+            file.write(reinterpret_cast<char const *>(buffer.data()), buffer.size() * sizeof(uint64_t));
+            buffer.clear();
+        };
+
+        for_each(
+            [&](uint64_t const value)
+            {
+                buffer.push_back(value);
+                if (buffer.size() == buffer.capacity())
+                    flush();
+            });
+        flush();
+
+        if (!file)
+            throw std::runtime_error{"Could not write temporary k-mer file " + path.string()}; // GCOVR_EXCL_LINE
+    }
+
+    clear();
+    file_runs.push_back(path);
+}
+
+size_t kmer_runs::count()
+{
+    merge();
+
+    if (!memory_runs.empty())
+        return memory_runs[0].size();
+    if (!file_runs.empty())
+        return std::filesystem::file_size(file_runs[0]) / sizeof(uint64_t);
+    return 0u;
+}
+
+} // namespace raptor::hibf
@@ -0,0 +1,199 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Implements raptor::hibf::task_pool and raptor::hibf::task_group.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#include <utility>
+
+#include <raptor/build/hibf/task_pool.hpp>
+
+namespace raptor::hibf
+{
+
+namespace
+{
+
+// The pool and queue of a worker thread.
+thread_local task_pool const * this_thread_pool{nullptr};
+thread_local size_t this_thread_queue{};
+
+} // namespace
+
+task_pool::task_pool()
+{
+    queues.push_back(std::make_unique<queue>());
+}
+
+task_pool::~task_pool()
+{
+    {
+        std::lock_guard<std::mutex> guard{sleep_mutex};
+        stop = true;
+    }
+    sleep_condition.notify_all();
+    for (std::thread & worker : workers)
+        worker.join();
+}
+
+void task_pool::start(size_t const threads)
+{
+    for (size_t i = 1u; i < threads; ++i)
+        queues.push_back(std::make_unique<queue>());
+
+    // All queues must exist before the first worker steals.
+    for (size_t i = 1u; i < threads; ++i)
+    {
+        workers.emplace_back(
+            [this, i]()
+            {
+                this_thread_pool = this;
+                this_thread_queue = i;
+
+                while (!stop)
+                {
+                    if (run_one())
+                        continue;
+
+                    std::unique_lock<std::mutex> lock{sleep_mutex};
+                    sleep_condition.wait(lock,
+                                         [this]()
+                                         {
+                                             return stop || queued_tasks > 0u;
+                                         });
+                }
+            });
+    }
+}
+
+size_t task_pool::queue_of_this_thread() const noexcept
+{
+    return (this_thread_pool == this) ? this_thread_queue : 0u;
+}
+
+void task_pool::push(task && new_task)
+{
+    queue & own_queue = *queues[queue_of_this_thread()];
+    {
+        std::lock_guard<std::mutex> guard{own_queue.mutex};
+        own_queue.tasks.push_back(std::move(new_task));
+    }
+    {
+        // Incrementing under the mutex prevents missed notifications.
+        std::lock_guard<std::mutex> guard{sleep_mutex};
+        ++queued_tasks;
+    }
+    sleep_condition.notify_one();
+}
+
+bool task_pool::run_one()
+{
+    if (queued_tasks == 0u)
+        return false;
+
+    size_t const number_of_queues = queues.size();
+    size_t const own_queue = queue_of_this_thread();
+    task current{};
+
+    for (size_t i = 0; i < number_of_queues && current.group == nullptr; ++i)
+    {
+        queue & other_queue = *queues[(own_queue + i) % number_of_queues];
+        std::lock_guard<std::mutex> guard{other_queue.mutex};
+
+        if (other_queue.tasks.empty())
+            continue;
+
+        // The newest task of the own queue, the oldest task of other queues.
+        if (i == 0u)
+        {
+            current = std::move(other_queue.tasks.back());
+            other_queue.tasks.pop_back();
+        }
+        else
+        {
+            current = std::move(other_queue.tasks.front());
+            other_queue.tasks.pop_front();
+        }
+    }
+
+    if (current.group == nullptr)
+        return false;
+
+    --queued_tasks;
+
+    try
+    {
+        current.function();
+        current.group->finish(nullptr);
+    }
+    catch (...)
+    {
+        current.group->finish(std::current_exception());
+    }
+
+    return true;
+}
+
+task_group::~task_group()
+{
+    help_until_done();
+}
+
+void task_group::run(std::function<void()> function)
+{
+    ++pending;
+    pool.push(task_pool::task{std::move(function), this});
+}
+
+void task_group::wait()
+{
+    help_until_done();
+
+    if (exception)
+        std::rethrow_exception(std::exchange(exception, nullptr));
+}
+
+void task_group::help_until_done()
+{
+    while (pending > 0u)
+    {
+        if (pool.run_one())
+            continue;
+
+        // The remaining tasks of this group are running in other threads.
+        std::unique_lock<std::mutex> lock{pool.sleep_mutex};
+        pool.sleep_condition.wait(lock,
+                                  [this]()
+                                  {
+                                      return pending == 0u || pool.queued_tasks > 0u;
+                                  });
+    }
+}
+
+void task_group::finish(std::exception_ptr task_exception) noexcept
+{
+    if (task_exception)
+    {
+        std::lock_guard<std::mutex> guard{exception_mutex};
+        if (!exception)
+            exception = std::move(task_exception);
+    }
+
+    // The group may be destroyed as soon as `pending` reaches zero. The pool outlives the group.
+    task_pool & group_pool = pool;
+    bool done{};
+    {
+        std::lock_guard<std::mutex> guard{group_pool.sleep_mutex};
+        done = --pending == 0u;
+    }
+    if (done)
+        group_pool.sleep_condition.notify_all();
+}
+
+} // namespace raptor::hibf
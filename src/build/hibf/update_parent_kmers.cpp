@@ -15,13 +15,18 @@
 namespace raptor::hibf
 {
 
-void update_parent_kmers(robin_hood::unordered_flat_set<size_t> & parent_kmers,
-                         robin_hood::unordered_flat_set<size_t> const & kmers,
-                         timer<concurrent::yes> & merge_kmers_timer)
+void update_parent_kmers(kmer_runs & parent_kmers, std::vector<uint64_t> && kmers)
+{
+    if (!kmers.empty())
+        parent_kmers.push_back(std::move(kmers));
+}
+
+void update_parent_kmers(kmer_runs & parent_kmers, kmer_runs && kmers, timer<concurrent::yes> & merge_kmers_timer)
 {
     timer<concurrent::no> local_merge_kmers_timer{};
     local_merge_kmers_timer.start();
-    parent_kmers.insert(kmers.begin(), kmers.end());
+    if (!kmers.empty())
+        parent_kmers.push_back(std::move(kmers));
     local_merge_kmers_timer.stop();
     merge_kmers_timer += local_merge_kmers_timer;
 }
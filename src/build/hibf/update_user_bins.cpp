@@ -20,11 +20,10 @@ namespace raptor::hibf
 template <seqan3::data_layout data_layout_mode>
 void update_user_bins(build_data<data_layout_mode> & data,
                       std::vector<int64_t> & filename_indices,
-                      chopper_pack_record const & record)
+                      chopper_pack_record const & record,
+                      size_t const user_bin_idx)
 {
-    size_t const idx = data.request_user_bin_idx();
-
-    std::string & user_bin_filenames = data.hibf.user_bins.filename_of_user_bin(idx);
+    std::string & user_bin_filenames = data.hibf.user_bins.filename_of_user_bin(user_bin_idx);
     for (auto const & filename : record.filenames)
     {
         user_bin_filenames += filename;
@@ -33,15 +32,17 @@ void update_user_bins(build_data<data_layout_mode> & data,
     assert(!user_bin_filenames.empty());
     user_bin_filenames.pop_back();
 
-    std::fill_n(filename_indices.begin() + record.bin_indices.back(), record.number_of_bins.back(), idx);
+    std::fill_n(filename_indices.begin() + record.bin_indices.back(), record.number_of_bins.back(), user_bin_idx);
 }
 
 template void update_user_bins<seqan3::data_layout::uncompressed>(build_data<seqan3::data_layout::uncompressed> &,
                                                                   std::vector<int64_t> &,
-                                                                  chopper_pack_record const &);
+                                                                  chopper_pack_record const &,
+                                                                  size_t const);
 
 template void update_user_bins<seqan3::data_layout::compressed>(build_data<seqan3::data_layout::compressed> &,
                                                                 std::vector<int64_t> &,
-                                                                chopper_pack_record const &);
+                                                                chopper_pack_record const &,
+                                                                size_t const);
 
 } // namespace raptor::hibf
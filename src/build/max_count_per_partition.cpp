@@ -23,16 +23,12 @@ namespace raptor
 namespace detail
 {
 
-template <file_types file_type>
-std::vector<size_t> max_count_per_partition(partition_config const & cfg,
-                                            std::vector<std::vector<std::string>> const & bin_path,
-                                            uint8_t const threads,
-                                            seqan3::shape const & shape,
-                                            uint32_t const window_size)
+template <file_types file_type, typename arguments_t>
+std::vector<size_t> max_count_per_partition(partition_config const & cfg, arguments_t const & arguments)
 {
     std::vector<size_t> kmers_per_partition(cfg.partitions);
     std::mutex callback_mutex{};
-    file_reader<file_type> const reader{shape, window_size};
+    file_reader<file_type> const reader{arguments.shape, arguments.window_size, arguments.minimiser_cache_dir};
 
     auto callback = [&callback_mutex, &kmers_per_partition, &cfg](std::vector<size_t> const & kmer_counts)
     {
@@ -59,7 +55,7 @@ std::vector<size_t> max_count_per_partition(partition_config const & cfg,
         callback(max_kmer_counts);
     };
 
-    call_parallel_on_bins(worker, bin_path, threads);
+    call_parallel_on_bins(worker, arguments.bin_path, arguments.threads);
 
     return kmers_per_partition;
 }
@@ -71,16 +67,8 @@ std::vector<size_t> max_count_per_partition(partition_config const & cfg, build_
     arguments.bin_size_timer.start();
     // GCOVR_EXCL_START
     std::vector<size_t> result = arguments.input_is_minimiser
-                                   ? detail::max_count_per_partition<file_types::minimiser>(cfg,
-                                                                                            arguments.bin_path,
-                                                                                            arguments.threads,
-                                                                                            arguments.shape,
-                                                                                            arguments.window_size)
-                                   : detail::max_count_per_partition<file_types::sequence>(cfg,
-                                                                                           arguments.bin_path,
-                                                                                           arguments.threads,
-                                                                                           arguments.shape,
-                                                                                           arguments.window_size);
+                                   ? detail::max_count_per_partition<file_types::minimiser>(cfg, arguments)
+                                   : detail::max_count_per_partition<file_types::sequence>(cfg, arguments);
     // GCOVR_EXCL_STOP
     arguments.bin_size_timer.stop();
 
@@ -91,16 +79,8 @@ std::vector<size_t> max_count_per_partition(partition_config const & cfg, upgrad
 {
     // GCOVR_EXCL_START
     std::vector<size_t> result = arguments.input_is_minimiser
-                                   ? detail::max_count_per_partition<file_types::minimiser>(cfg,
-                                                                                            arguments.bin_path,
-                                                                                            arguments.threads,
-                                                                                            arguments.shape,
-                                                                                            arguments.window_size)
-                                   : detail::max_count_per_partition<file_types::sequence>(cfg,
-                                                                                           arguments.bin_path,
-                                                                                           arguments.threads,
-                                                                                           arguments.shape,
-                                                                                           arguments.window_size);
+                                   ? detail::max_count_per_partition<file_types::minimiser>(cfg, arguments)
+                                   : detail::max_count_per_partition<file_types::sequence>(cfg, arguments);
     // GCOVR_EXCL_STOP
 
     return result;
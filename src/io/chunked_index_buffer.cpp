@@ -0,0 +1,572 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Implements raptor::chunked_index_output_buffer and raptor::chunked_index_input_buffer.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <xxhash.h>
+
+#include <raptor/io/chunked_index_buffer.hpp>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+class segment_hasher
+{
+public:
+    segment_hasher() : state{XXH3_createState()}
+    {
+        if (state == nullptr)
+            throw std::bad_alloc{}; // GCOVR_EXCL_LINE
+        reset();
+    }
+
+    segment_hasher(segment_hasher const &) = delete;
+    segment_hasher & operator=(segment_hasher const &) = delete;
+
+    ~segment_hasher()
+    {
+        XXH3_freeState(state);
+    }
+
+    void reset()
+    {
+        XXH3_64bits_reset(state);
+    }
+
+    void update(char const * const data, size_t const size)
+    {
+        XXH3_64bits_update(state, data, size);
+    }
+
+    uint64_t digest() const
+    {
+        return XXH3_64bits_digest(state);
+    }
+
+    static uint64_t hash(char const * const data, size_t const size)
+    {
+        return XXH3_64bits(data, size);
+    }
+
+private:
+    XXH3_state_t * state{nullptr};
+};
+
+static constexpr size_t io_buffer_size{1ULL << 20}; // 1 MiB
+
+//!\brief Calls `worker(i)` for all `i` in `[0, count)` using up to `threads` threads.
+template <typename worker_t>
+void parallel_for(size_t const count, size_t const threads, worker_t && worker)
+{
+    size_t const number_of_tasks = std::min(count, threads);
+
+    if (number_of_tasks <= 1u)
+    {
+        for (size_t i = 0; i < count; ++i)
+            worker(i);
+        return;
+    }
+
+    std::vector<std::future<void>> tasks{};
+    tasks.reserve(number_of_tasks);
+
+    for (size_t task = 0; task < number_of_tasks; ++task)
+    {
+        tasks.emplace_back(std::async(std::launch::async,
+                                      [&worker, task, count, number_of_tasks]()
+                                      {
+                                          for (size_t i = task; i < count; i += number_of_tasks)
+                                              worker(i);
+                                      }));
+    }
+
+    // get() rethrows exceptions thrown by the worker.
+    for (auto && task : tasks)
+        task.get();
+}
+
+void write_all(int const fd, char const * data, size_t size, uint64_t offset)
+{
+    while (size > 0u)
+    {
+        ssize_t const written = ::pwrite(fd, data, size, offset);
+        if (written == -1)
+        {
+            if (errno == EINTR)
+                continue; // GCOVR_EXCL_LINE
+            throw std::system_error{errno, std::generic_category(), "Cannot write index"}; // GCOVR_EXCL_LINE
+        }
+        data += written;
+        size -= written;
+        offset += written;
+    }
+}
+
+void read_all(int const fd, char * data, size_t size, uint64_t offset)
+{
+    while (size > 0u)
+    {
+        ssize_t const bytes_read = ::pread(fd, data, size, offset);
+        if (bytes_read == -1)
+        {
+            if (errno == EINTR)
+                continue; // GCOVR_EXCL_LINE
+            throw std::system_error{errno, std::generic_category(), "Cannot read index"}; // GCOVR_EXCL_LINE
+        }
+        if (bytes_read == 0)
+            throw std::runtime_error{"Unexpected end of index file."}; // GCOVR_EXCL_LINE
+        data += bytes_read;
+        size -= bytes_read;
+        offset += bytes_read;
+    }
+}
+
+[[noreturn]] void throw_checksum_mismatch(index_segment const & segment)
+{
+    throw std::runtime_error{"Checksum mismatch for bytes " + std::to_string(segment.offset) + " to "
+                             + std::to_string(segment.offset + segment.length)
+                             + " of the index file. The file is corrupted."};
+}
+
+} // namespace detail
+
+// ------------------------------------------------------------------------------------------------------------------
+// chunked_index_output_buffer
+// ------------------------------------------------------------------------------------------------------------------
+
+chunked_index_output_buffer::chunked_index_output_buffer(std::filesystem::path const & path_,
+                                                         size_t const threads_,
+                                                         size_t const chunk_size_) :
+    path{path_},
+    threads{std::max<size_t>(threads_, 1u)},
+    chunk_size{std::max<size_t>(chunk_size_, 1u)},
+    buffer(std::min(detail::io_buffer_size, chunk_size)),
+    hasher{std::make_unique<detail::segment_hasher>()}
+{
+    // The index is written to a new file next to `path`, which replaces `path` only once it is complete. Hence, an
+    // existing index at `path`, e.g., the input of `raptor update`, is kept if writing fails.
+    std::string tmp_name{path.string() + ".tmp.XXXXXX"};
+    fd = ::mkstemp(tmp_name.data());
+    if (fd == -1)
+        throw std::system_error{errno, std::generic_category(), "Cannot create a temporary file for " + path.string()};
+    tmp_path = std::move(tmp_name);
+
+    // mkstemp creates the file with mode 0600. Use the mode a newly created file would have.
+    mode_t const mask = ::umask(0);
+    ::umask(mask);
+    ::fchmod(fd, 0666 & ~mask);
+
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+chunked_index_output_buffer::~chunked_index_output_buffer()
+{
+    if (fd == -1)
+        return;
+
+    // close() was not called or failed. The index is incomplete; `path` was not touched.
+    ::close(fd);
+    std::error_code ec{};
+    std::filesystem::remove(tmp_path, ec);
+}
+
+void chunked_index_output_buffer::close()
+{
+    if (fd == -1)
+        return;
+
+    flush_buffer();
+    close_segment();
+
+    std::vector<uint64_t> trailer{};
+    trailer.reserve(segments.size() * 3u + 3u);
+    for (detail::index_segment const & segment : segments)
+    {
+        trailer.push_back(segment.offset);
+        trailer.push_back(segment.length);
+        trailer.push_back(segment.checksum);
+    }
+    trailer.push_back(segments.size());
+    trailer.push_back(file_offset);
+    trailer.push_back(detail::index_trailer::magic);
+
+    detail::write_all(fd,
+                      reinterpret_cast<char const *>(trailer.data()),
+                      trailer.size() * sizeof(uint64_t),
+                      file_offset);
+
+    // If writing the trailer threw, the destructor removes the temporary file.
+    // The data must be on disk before the file replaces `path`.
+    if (::fsync(fd) == -1)
+        throw std::system_error{errno, std::generic_category(), "Cannot write " + path.string()}; // GCOVR_EXCL_LINE
+
+    // The file descriptor is released even if ::close fails, so the temporary file is removed here.
+    std::error_code ec{};
+    if (::close(std::exchange(fd, -1)) == -1)
+    {
+        // GCOVR_EXCL_START
+        int const error = errno;
+        std::filesystem::remove(tmp_path, ec);
+        throw std::system_error{error, std::generic_category(), "Cannot close " + path.string()};
+        // GCOVR_EXCL_STOP
+    }
+
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec)
+    {
+        std::error_code remove_ec{};
+        std::filesystem::remove(tmp_path, remove_ec);
+        throw std::filesystem::filesystem_error{"Cannot replace the index", tmp_path, path, ec};
+    }
+}
+
+chunked_index_output_buffer::int_type chunked_index_output_buffer::overflow(int_type ch)
+{
+    flush_buffer();
+
+    if (!traits_type::eq_int_type(ch, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize chunked_index_output_buffer::xsputn(char_type const * s, std::streamsize n)
+{
+    size_t const size = static_cast<size_t>(n);
+
+    if (size >= chunk_size)
+    {
+        flush_buffer();
+        write_large_block(s, size);
+        return n;
+    }
+
+    size_t written{};
+    while (written < size)
+    {
+        if (pptr() == epptr())
+            flush_buffer();
+
+        size_t const count = std::min<size_t>(size - written, epptr() - pptr());
+        std::memcpy(pptr(), s + written, count);
+        pbump(static_cast<int>(count));
+        written += count;
+    }
+
+    return n;
+}
+
+int chunked_index_output_buffer::sync()
+{
+    flush_buffer();
+    return 0;
+}
+
+void chunked_index_output_buffer::flush_buffer()
+{
+    size_t const size = pptr() - pbase();
+
+    if (size == 0u)
+        return;
+
+    detail::write_all(fd, pbase(), size, file_offset);
+    file_offset += size;
+
+    // Buffered data is checksummed in segments of at most chunk_size bytes.
+    size_t hashed{};
+    while (hashed < size)
+    {
+        size_t const count = std::min(size - hashed, chunk_size - open_segment_length);
+        hasher->update(pbase() + hashed, count);
+        open_segment_length += count;
+        hashed += count;
+
+        if (open_segment_length == chunk_size)
+            close_segment();
+    }
+
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+void chunked_index_output_buffer::close_segment()
+{
+    if (open_segment_length == 0u)
+        return;
+
+    segments.push_back({.offset = open_segment_offset, .length = open_segment_length, .checksum = hasher->digest()});
+    hasher->reset();
+    open_segment_offset += open_segment_length;
+    open_segment_length = 0u;
+}
+
+void chunked_index_output_buffer::write_large_block(char_type const * data, size_t const size)
+{
+    close_segment();
+
+    size_t const number_of_chunks = (size + chunk_size - 1u) / chunk_size;
+    size_t const first_segment = segments.size();
+    segments.resize(first_segment + number_of_chunks);
+
+    detail::parallel_for(number_of_chunks,
+                         threads,
+                         [&](size_t const chunk)
+                         {
+                             size_t const chunk_begin = chunk * chunk_size;
+                             size_t const chunk_length = std::min(chunk_size, size - chunk_begin);
+                             uint64_t const offset = file_offset + chunk_begin;
+
+                             detail::write_all(fd, data + chunk_begin, chunk_length, offset);
+                             segments[first_segment + chunk] = {
+                                 .offset = offset,
+                                 .length = chunk_length,
+                                 .checksum = detail::segment_hasher::hash(data + chunk_begin, chunk_length)};
+                         });
+
+    file_offset += size;
+    open_segment_offset = file_offset;
+}
+
+// ------------------------------------------------------------------------------------------------------------------
+// chunked_index_input_buffer
+// ------------------------------------------------------------------------------------------------------------------
+
+chunked_index_input_buffer::chunked_index_input_buffer(std::filesystem::path const & path, size_t const threads_) :
+    threads{std::max<size_t>(threads_, 1u)},
+    buffer(detail::io_buffer_size),
+    hasher{std::make_unique<detail::segment_hasher>()}
+{
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::system_error{errno, std::generic_category(), "Cannot open " + path.string()};
+
+    struct stat file_status;
+    if (::fstat(fd, &file_status) == -1)
+        throw std::system_error{errno, std::generic_category(), "Cannot stat " + path.string()}; // GCOVR_EXCL_LINE
+
+    read_trailer(file_status.st_size);
+    setg(buffer.data(), buffer.data(), buffer.data());
+}
+
+chunked_index_input_buffer::~chunked_index_input_buffer()
+{
+    if (fd != -1)
+        ::close(fd);
+}
+
+void chunked_index_input_buffer::read_trailer(uint64_t const file_size)
+{
+    payload_size = file_size;
+
+    if (file_size < detail::index_trailer::fixed_size)
+        return;
+
+    std::array<uint64_t, 3> fixed{};
+    detail::read_all(fd,
+                     reinterpret_cast<char *>(fixed.data()),
+                     detail::index_trailer::fixed_size,
+                     file_size - detail::index_trailer::fixed_size);
+
+    auto const [segment_count, stored_payload_size, magic] = fixed;
+    size_t const table_size = segment_count * 3u * sizeof(uint64_t);
+
+    // No trailer, e.g., an index written by an older version of Raptor.
+    if (magic != detail::index_trailer::magic
+        || stored_payload_size + table_size + detail::index_trailer::fixed_size != file_size)
+        return;
+
+    std::vector<uint64_t> table(segment_count * 3u);
+    detail::read_all(fd, reinterpret_cast<char *>(table.data()), table_size, stored_payload_size);
+
+    segments.resize(segment_count);
+    for (size_t i = 0; i < segment_count; ++i)
+        segments[i] = {.offset = table[3u * i], .length = table[3u * i + 1u], .checksum = table[3u * i + 2u]};
+
+    payload_size = stored_payload_size;
+}
+
+chunked_index_input_buffer::int_type chunked_index_input_buffer::underflow()
+{
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+
+    if (file_offset >= payload_size)
+        return traits_type::eof();
+
+    size_t const size = std::min<uint64_t>(buffer.size(), payload_size - file_offset);
+    detail::read_all(fd, buffer.data(), size, file_offset);
+    verify(buffer.data(), size);
+    file_offset += size;
+
+    setg(buffer.data(), buffer.data(), buffer.data() + size);
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize chunked_index_input_buffer::xsgetn(char_type * s, std::streamsize n)
+{
+    size_t const size = static_cast<size_t>(n);
+    size_t copied = std::min<size_t>(size, egptr() - gptr());
+    std::memcpy(s, gptr(), copied);
+    gbump(static_cast<int>(copied));
+
+    size_t const remaining = std::min<uint64_t>(size - copied, payload_size - file_offset);
+
+    if (remaining >= buffer.size())
+    {
+        read_large_block(s + copied, remaining);
+        return copied + remaining;
+    }
+
+    while (copied < size && !traits_type::eq_int_type(underflow(), traits_type::eof()))
+    {
+        size_t const count = std::min<size_t>(size - copied, egptr() - gptr());
+        std::memcpy(s + copied, gptr(), count);
+        gbump(static_cast<int>(count));
+        copied += count;
+    }
+
+    return copied;
+}
+
+chunked_index_input_buffer::pos_type chunked_index_input_buffer::seekpos(pos_type const position,
+                                                                         std::ios_base::openmode const which)
+{
+    uint64_t const target = static_cast<uint64_t>(static_cast<off_type>(position));
+    if (!(which & std::ios_base::in) || static_cast<off_type>(position) < 0 || target > payload_size)
+        return pos_type(off_type(-1));
+
+    // The segment that was read partially is not read again.
+    verify_open_segment();
+    setg(buffer.data(), buffer.data(), buffer.data());
+    file_offset = target;
+
+    if (segments.empty())
+        return position;
+
+    // The segment that contains `target`. The segments are contiguous and start at 0.
+    auto const segment =
+        std::ranges::upper_bound(segments, target, std::ranges::less{}, &detail::index_segment::offset);
+    current_segment = std::ranges::distance(segments.begin(), segment) - 1u;
+    file_offset = segments[current_segment].offset;
+    read_and_verify(target);
+    return position;
+}
+
+void chunked_index_input_buffer::finish()
+{
+    verify_open_segment();
+    setg(buffer.data(), buffer.data(), buffer.data());
+    file_offset = payload_size;
+}
+
+void chunked_index_input_buffer::verify_open_segment()
+{
+    if (open_segment_length != 0u)
+        read_and_verify(segments[current_segment].offset + segments[current_segment].length);
+}
+
+//!\brief Reads the bytes up to `end` without returning them. Only their checksums are verified.
+void chunked_index_input_buffer::read_and_verify(uint64_t const end)
+{
+    while (file_offset < end)
+    {
+        size_t const size = std::min<uint64_t>(buffer.size(), end - file_offset);
+        detail::read_all(fd, buffer.data(), size, file_offset);
+        verify(buffer.data(), size);
+        file_offset += size;
+    }
+}
+
+void chunked_index_input_buffer::read_large_block(char_type * data, size_t const size)
+{
+    size_t const chunk_size = chunked_index_output_buffer::default_chunk_size;
+    size_t const number_of_chunks = (size + chunk_size - 1u) / chunk_size;
+
+    detail::parallel_for(number_of_chunks,
+                         threads,
+                         [&](size_t const chunk)
+                         {
+                             size_t const chunk_begin = chunk * chunk_size;
+                             size_t const chunk_length = std::min(chunk_size, size - chunk_begin);
+                             detail::read_all(fd, data + chunk_begin, chunk_length, file_offset + chunk_begin);
+                         });
+
+    verify(data, size);
+    file_offset += size;
+}
+
+void chunked_index_input_buffer::verify(char_type const * data, size_t const size)
+{
+    size_t position{};
+
+    while (position < size && current_segment < segments.size())
+    {
+        detail::index_segment const & segment = segments[current_segment];
+
+        // Segments that are completely contained in data are checked in parallel.
+        if (open_segment_length == 0u && size - position >= segment.length)
+        {
+            size_t const first = current_segment;
+            size_t last = current_segment;
+            size_t end = position;
+            while (last < segments.size() && size - end >= segments[last].length)
+                end += segments[last++].length;
+
+            detail::parallel_for(last - first,
+                                 threads,
+                                 [&](size_t const i)
+                                 {
+                                     detail::index_segment const & current = segments[first + i];
+                                     char_type const * const begin =
+                                         data + position + (current.offset - segment.offset);
+                                     if (detail::segment_hasher::hash(begin, current.length) != current.checksum)
+                                         detail::throw_checksum_mismatch(current);
+                                 });
+
+            position = end;
+            current_segment = last;
+            continue;
+        }
+
+        size_t const count = std::min(size - position, segment.length - open_segment_length);
+        hasher->update(data + position, count);
+        open_segment_length += count;
+        position += count;
+
+        if (open_segment_length == segment.length)
+        {
+            if (hasher->digest() != segment.checksum)
+                detail::throw_checksum_mismatch(segment);
+            hasher->reset();
+            open_segment_length = 0u;
+            ++current_segment;
+        }
+    }
+}
+
+} // namespace raptor
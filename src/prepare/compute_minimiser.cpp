@@ -10,7 +10,9 @@
  * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
  */
 
-#include <robin_hood.h>
+#include <memory>
+#include <mutex>
+#include <span>
 
 #include <seqan3/io/sequence_file/input.hpp>
 #include <seqan3/search/views/minimiser_hash.hpp>
@@ -19,8 +21,11 @@
 #include <raptor/call_parallel_on_bins.hpp>
 #include <raptor/dna4_traits.hpp>
 #include <raptor/file_reader.hpp>
+#include <raptor/io/minimiser_file.hpp>
 #include <raptor/prepare/compute_minimiser.hpp>
 #include <raptor/prepare/cutoff.hpp>
+#include <raptor/prepare/minimiser_counter.hpp>
+#include <raptor/prepare/occurrence_filter.hpp>
 
 namespace raptor
 {
@@ -43,88 +48,171 @@ void write_list_file(prepare_arguments const & arguments)
     }
 }
 
+// About one 2-bit counter per input byte of uncompressed files, i.e., at least two counters per minimiser.
+// With a memory limit, the filter uses at most a quarter of it.
+size_t occurrence_filter_size(std::vector<std::string> const & file_names, size_t const memory_limit)
+{
+    size_t input_size{};
+    for (auto && file_name : file_names)
+        input_size += std::filesystem::file_size(file_name) * (raptor::cutoff::file_is_compressed(file_name) ? 3u : 1u);
+
+    size_t const filter_size = input_size / 4u;
+    return memory_limit == 0u ? filter_size : std::min(filter_size, memory_limit / 4u);
+}
+
 void compute_minimiser(prepare_arguments const & arguments)
 {
     file_reader<file_types::sequence> const reader{arguments.shape, arguments.window_size};
     raptor::cutoff const cutoffs{arguments};
 
-    auto worker = [&](auto && zipped_view, auto &&)
+    // Computes the minimisers of one user bin. With multiple threads, files are read in parallel chunks.
+    auto compute = [&](std::vector<std::string> const & file_names,
+                       size_t const threads,
+                       size_t const memory_limit,
+                       timer<concurrent::no> & compute_timer,
+                       timer<concurrent::no> & write_timer)
     {
-        timer<concurrent::no> local_compute_minimiser_timer{};
-        timer<concurrent::no> local_write_minimiser_timer{};
-        timer<concurrent::no> local_write_header_timer{};
+        std::filesystem::path const file_name{file_names[0]};
+        bool const is_compressed = raptor::cutoff::file_is_compressed(file_name);
 
-        for (auto && [file_names, bin_number] : zipped_view)
+        std::filesystem::path output_path{arguments.out_dir};
+        output_path /= is_compressed ? file_name.stem().stem() : file_name.stem();
+
+        std::filesystem::path const minimiser_file = std::filesystem::path{output_path}.replace_extension("minimiser");
+        std::filesystem::path const progress_file = std::filesystem::path{output_path}.replace_extension("in_progress");
+
+        // If we are already done with this file, we can skip it. Otherwise, we create a ".in_progress" file to keep
+        // track of whether the minimiser computation was successful.
+        bool const already_done = std::filesystem::exists(minimiser_file) && !std::filesystem::exists(progress_file);
+
+        if (already_done)
+            return;
+        else
+            std::ofstream outfile{progress_file, std::ios::binary};
+
+        uint8_t const cutoff = cutoffs.get(file_name);
+
+        // Most minimisers of raw reads occur once and are discarded by the cutoff. If there is a cutoff, a first
+        // pass estimates the counts with an occurrence filter. The estimates are never too small. The second pass
+        // only counts the minimisers that may reach the cutoff.
+        bool const use_filter = cutoff > 1u;
+        uint8_t const threshold = std::min(cutoff, occurrence_filter::max_count);
+        occurrence_filter filter{};
+
+        compute_timer.start();
+        if (use_filter)
         {
-            std::filesystem::path const file_name{file_names[0]};
-            bool const is_compressed = raptor::cutoff::file_is_compressed(file_name);
-
-            std::filesystem::path output_path{arguments.out_dir};
-            output_path /= is_compressed ? file_name.stem().stem() : file_name.stem();
-
-            std::filesystem::path const minimiser_file =
-                std::filesystem::path{output_path}.replace_extension("minimiser");
-            std::filesystem::path const progress_file =
-                std::filesystem::path{output_path}.replace_extension("in_progress");
-            std::filesystem::path const header_file = std::filesystem::path{output_path}.replace_extension("header");
-
-            // If we are already done with this file, we can skip it. Otherwise, we create a ".in_progress" file to keep
-            // track of whether the minimiser computation was successful.
-            bool const already_done = std::filesystem::exists(minimiser_file) && std::filesystem::exists(header_file)
-                                   && !std::filesystem::exists(progress_file);
-
-            if (already_done)
-                continue;
-            else
-                std::ofstream outfile{progress_file, std::ios::binary};
-
-            // The hash table stores how often a minimiser appears. It does not matter whether a minimiser appears
-            // 50 times or 2000 times, it is stored regardless because the biggest cutoff value is 50. Hence,
-            // the hash table stores only values up to 254 to save memory.
-            robin_hood::unordered_map<uint64_t, uint8_t> minimiser_table{};
-            // The map is (re-)constructed for each file. The alternative is to construct it once for each thread
-            // and clear+reuse it for every file that a thread works on. However, this dramatically increases
-            // memory consumption because the map will stay as big as needed for the biggest encountered file.
-
-            local_compute_minimiser_timer.start();
-            reader.for_each_hash(file_names,
-                                 [&](auto && hash)
-                                 {
-                                     minimiser_table[hash] = std::min<uint8_t>(254u, minimiser_table[hash] + 1);
-                                 });
-            local_compute_minimiser_timer.stop();
-
-            uint8_t const cutoff = cutoffs.get(file_name);
-            uint64_t count{};
-
-            local_write_minimiser_timer.start();
-            {
-                std::ofstream outfile{minimiser_file, std::ios::binary};
-                for (auto && [hash, occurrences] : minimiser_table)
+            filter = occurrence_filter{occurrence_filter_size(file_names, memory_limit)};
+            reader.for_each_span(
+                file_names,
+                [&](std::span<uint64_t const> const hashes)
                 {
-                    if (occurrences >= cutoff)
-                    {
-                        outfile.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
-                        ++count;
-                    }
-                }
-            }
-            local_write_minimiser_timer.stop();
-
-            local_write_header_timer.start();
+                    if (threads == 1u)
+                        for (uint64_t const hash : hashes)
+                            filter.insert(hash);
+                    else
+                        for (uint64_t const hash : hashes)
+                            filter.concurrent_insert(hash);
+                },
+                threads);
+        }
+
+        // Minimisers are counted by sorting. Counts are saturated at 254 because the biggest cutoff value is 50.
+        // Each span is counted by a counter that no other thread is using, hence there are at most `threads` counters.
+        // Each counter gets an equal share of the memory limit. The counters are combined when the minimisers are
+        // written. With a memory limit, sorted runs that do not fit into memory are written to a new temporary
+        // directory "<output_path>.tmp.XXXXXX" per counter.
+        std::filesystem::path tmp_prefix{output_path};
+        tmp_prefix += ".tmp";
+        size_t const counter_memory_limit = (memory_limit - std::min(memory_limit, filter.size_in_bytes())) / threads;
+        std::vector<std::unique_ptr<minimiser_counter>> counters{};
+        std::vector<minimiser_counter *> idle_counters{};
+        std::mutex counters_mutex{};
+
+        auto acquire_counter = [&]() -> minimiser_counter &
+        {
+            std::lock_guard<std::mutex> guard{counters_mutex};
+            if (idle_counters.empty())
+                return *counters.emplace_back(std::make_unique<minimiser_counter>(counter_memory_limit, tmp_prefix));
+
+            minimiser_counter & counter = *idle_counters.back();
+            idle_counters.pop_back();
+            return counter;
+        };
+
+        auto release_counter = [&](minimiser_counter & counter)
+        {
+            std::lock_guard<std::mutex> guard{counters_mutex};
+            idle_counters.push_back(&counter);
+        };
+
+        reader.for_each_span(
+            file_names,
+            [&](std::span<uint64_t const> const hashes)
             {
-                std::ofstream headerfile{header_file};
-                headerfile << arguments.shape.to_string() << '\t' << arguments.window_size << '\t'
-                           << static_cast<uint16_t>(cutoff) << '\t' << count << '\n';
-            }
-            local_write_header_timer.stop();
+                minimiser_counter & counter = acquire_counter();
+                for (uint64_t const hash : hashes)
+                    if (!use_filter || filter.count(hash) >= threshold)
+                        counter.insert(hash);
+                release_counter(counter);
+            },
+            threads);
+        filter = occurrence_filter{};
+        compute_timer.stop();
+
+        // The minimisers are written in ascending order, see raptor::minimiser_file_writer.
+        write_timer.start();
+        minimiser_file_writer writer{minimiser_file, arguments.shape, arguments.window_size, cutoff};
+        std::vector<minimiser_counter *> counter_pointers{};
+        for (auto const & counter : counters)
+            counter_pointers.push_back(counter.get());
+        minimiser_counter::for_each(counter_pointers,
+                                    cutoff,
+                                    [&writer](uint64_t const hash)
+                                    {
+                                        writer.push_back(hash);
+                                    });
+        writer.finish();
+        write_timer.stop();
+
+        std::filesystem::remove(progress_file);
+    };
 
-            std::filesystem::remove(progress_file);
-        }
+    // A user bin that is bigger than the share of a thread would keep one thread busy while the others are idle.
+    // Such user bins are processed one after another, each with all threads. The remaining user bins are processed in
+    // parallel, one thread per user bin.
+    std::vector<bool> const is_large = large_user_bins(arguments.bin_path, arguments.threads);
+
+    for (size_t bin_number = 0; bin_number < is_large.size(); ++bin_number)
+    {
+        if (!is_large[bin_number])
+            continue;
+
+        timer<concurrent::no> local_compute_minimiser_timer{};
+        timer<concurrent::no> local_write_minimiser_timer{};
+        compute(arguments.bin_path[bin_number],
+                arguments.threads,
+                arguments.memory_limit << 20,
+                local_compute_minimiser_timer,
+                local_write_minimiser_timer);
+        arguments.compute_minimiser_timer += local_compute_minimiser_timer;
+        arguments.write_minimiser_timer += local_write_minimiser_timer;
+    }
+
+    // Each thread counts the minimisers of one file at a time.
+    size_t const memory_limit = (arguments.memory_limit << 20) / arguments.threads;
+
+    auto worker = [&](auto && zipped_view, auto &&)
+    {
+        timer<concurrent::no> local_compute_minimiser_timer{};
+        timer<concurrent::no> local_write_minimiser_timer{};
+
+        for (auto && [file_names, bin_number] : zipped_view)
+            if (!is_large[bin_number])
+                compute(file_names, 1u, memory_limit, local_compute_minimiser_timer, local_write_minimiser_timer);
 
         arguments.compute_minimiser_timer += local_compute_minimiser_timer;
         arguments.write_minimiser_timer += local_write_minimiser_timer;
-        arguments.write_header_timer += local_write_header_timer;
     };
 
     call_parallel_on_bins(worker, arguments.bin_path, arguments.threads);
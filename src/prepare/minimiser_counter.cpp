@@ -0,0 +1,140 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Implements raptor::minimiser_counter.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#include <stdexcept>
+
+#include <raptor/io/temporary_directory.hpp>
+#include <raptor/prepare/minimiser_counter.hpp>
+#include <raptor/radix_sort.hpp>
+
+namespace raptor
+{
+
+minimiser_counter::minimiser_counter(size_t const memory_limit, std::filesystem::path tmp_prefix) :
+    prefix{std::move(tmp_prefix)}
+{
+    if (memory_limit == 0u)
+        return;
+
+    // The radix sort needs a second buffer of the same size.
+    buffer_capacity = std::max(memory_limit / 4u / sizeof(uint64_t), min_buffer_capacity);
+    run_memory_limit = memory_limit / 2u;
+}
+
+minimiser_counter::~minimiser_counter()
+{
+    if (!directory.empty())
+    {
+        std::error_code ec{};
+        std::filesystem::remove_all(directory, ec);
+    }
+}
+
+void minimiser_counter::flush()
+{
+    if (buffer.empty())
+        return;
+
+    detail::radix_sort(buffer, 1u);
+
+    detail::counted_run run{};
+    for (size_t i = 0; i < buffer.size();)
+    {
+        size_t j = i + 1u;
+        while (j < buffer.size() && buffer[j] == buffer[i])
+            ++j;
+
+        run.values.push_back(buffer[i]);
+        run.counts.push_back(static_cast<uint8_t>(std::min<size_t>(j - i, max_count)));
+        i = j;
+    }
+
+    buffer.clear();
+    memory_bytes += run.bytes();
+    memory_runs.push_back(std::move(run));
+
+    if (run_memory_limit != 0u && memory_bytes > run_memory_limit)
+        spill();
+    else if (memory_runs.size() > max_memory_runs)
+        merge_memory_runs();
+}
+
+void minimiser_counter::merge_memory_runs()
+{
+    detail::counted_run result{};
+    std::vector<std::filesystem::path> files{};
+    std::swap(files, file_runs);
+
+    merge_runs(
+        [&result](uint64_t const value, uint8_t const count)
+        {
+            result.values.push_back(value);
+            result.counts.push_back(count);
+        });
+
+    std::swap(files, file_runs);
+    memory_runs.clear();
+    memory_bytes = result.bytes();
+    memory_runs.push_back(std::move(result));
+}
+
+void minimiser_counter::spill(bool const merge_files)
+{
+    if (directory.empty())
+        directory = detail::create_temporary_directory(prefix);
+
+    std::filesystem::path const path = directory / ("run_" + std::to_string(file_counter++) + ".counts");
+
+    // With too many files, the files are merged as well. Otherwise, only the memory runs are written.
+    std::vector<std::filesystem::path> files{};
+    if (!merge_files && file_runs.size() < max_file_runs)
+        std::swap(files, file_runs);
+
+    {
+        std::ofstream file{path, std::ios::binary};
+        std::vector<char> output{};
+        output.reserve((1ULL << 15) * detail::counted_run::bytes_per_entry);
+
+        auto write = [&]()
+        {
+            file.write(output.data(), output.size());
+            output.clear();
+        };
+
+        merge_runs(
+            [&](uint64_t const value, uint8_t const count)
+            {
+                char const * const bytes = reinterpret_cast<char const *>(&value);
+                output.insert(output.end(), bytes, bytes + sizeof(uint64_t));
+                output.push_back(static_cast<char>(count));
+                if (output.size() == output.capacity())
+                    write();
+            });
+        write();
+
+        if (!file)
+            throw std::runtime_error{"Could not write temporary minimiser file " + path.string()}; // GCOVR_EXCL_LINE
+    }
+
+    for (auto const & merged : file_runs)
+    {
+        std::error_code ec{};
+        std::filesystem::remove(merged, ec);
+    }
+
+    file_runs = std::move(files);
+    file_runs.push_back(path);
+    memory_runs.clear();
+    memory_bytes = 0u;
+}
+
+} // namespace raptor
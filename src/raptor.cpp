@@ -14,6 +14,7 @@
 #include <raptor/argument_parsing/init_shared_meta.hpp>
 #include <raptor/argument_parsing/prepare_parsing.hpp>
 #include <raptor/argument_parsing/search_parsing.hpp>
+#include <raptor/argument_parsing/update_parsing.hpp>
 #include <raptor/argument_parsing/upgrade_parsing.hpp>
 #include <raptor/layout/raptor_layout.hpp>
 #include <raptor/raptor.hpp>
@@ -26,7 +27,7 @@ int main(int argc, char ** argv)
                                        argc,
                                        argv,
                                        sharg::update_notifications::on,
-                                       {"build", "layout", "prepare", "search", "upgrade"}};
+                                       {"build", "layout", "prepare", "search", "update", "upgrade"}};
         raptor::init_shared_meta(top_level_parser);
         top_level_parser.info.description.emplace_back(
             "Raptor is a system for approximately searching many queries such as "
@@ -48,6 +49,8 @@ int main(int argc, char ** argv)
             raptor::prepare_parsing(sub_parser);
         if (sub_parser.info.app_name == std::string_view{"Raptor-search"})
             raptor::search_parsing(sub_parser);
+        if (sub_parser.info.app_name == std::string_view{"Raptor-update"})
+            raptor::update_parsing(sub_parser);
         if (sub_parser.info.app_name == std::string_view{"Raptor-upgrade"})
             raptor::upgrade_parsing(sub_parser);
     }
@@ -163,9 +163,10 @@ void search_partitioned_ibf(search_arguments const & arguments)
 
                 size_t const threshold = thresholder.get(minimiser_count);
                 local_generate_results_timer.start();
-                for (auto && count : counts[counter_id++])
+                // Bins reserved or emptied by `raptor update` do not belong to any user bin.
+                for (auto && count : counts[counter_id++] | std::views::take(arguments.bin_path.size()))
                 {
-                    if (count >= threshold)
+                    if (count >= threshold && !arguments.bin_path[current_bin].empty())
                     {
                         result_string += std::to_string(current_bin);
                         result_string += ',';
@@ -0,0 +1,257 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+/*!\file
+ * \brief Implements raptor::raptor_update.
+ * \author Enrico Seiler <enrico.seiler AT fu-berlin.de>
+ */
+
+#include <algorithm>
+#include <numeric>
+
+#include <raptor/build/partition_config.hpp>
+#include <raptor/build/store_index.hpp>
+#include <raptor/call_parallel_on_bins.hpp>
+#include <raptor/file_reader.hpp>
+#include <raptor/radix_sort.hpp>
+#include <raptor/search/load_index.hpp>
+#include <raptor/update/update.hpp>
+#include <raptor/upgrade/index_upgrader.hpp>
+
+namespace raptor
+{
+
+namespace detail
+{
+
+/*!\brief Returns the technical bins that will hold the new user bins.
+ * \details Empty bins, i.e. bins of removed user bins and bins reserved at build time, are used first. If there are
+ *          not enough, the IBF is widened.
+ */
+std::vector<size_t> assign_free_bins(raptor_index<> & index, size_t const number_of_new_bins)
+{
+    auto & ibf = index.ibf();
+    auto const & bin_path = index.bin_path();
+    std::vector<size_t> free_bins{};
+    free_bins.reserve(number_of_new_bins);
+
+    for (size_t bin = 0; bin < bin_path.size() && free_bins.size() < number_of_new_bins; ++bin)
+        if (bin_path[bin].empty())
+            free_bins.push_back(bin);
+
+    size_t const first_unused_bin = bin_path.size();
+    size_t const required_bin_count = first_unused_bin + number_of_new_bins - free_bins.size();
+
+    if (required_bin_count > ibf.bin_count())
+        ibf.increase_bin_number_to(seqan3::bin_count{required_bin_count});
+
+    for (size_t bin = first_unused_bin; free_bins.size() < number_of_new_bins; ++bin)
+        free_bins.push_back(bin);
+
+    return free_bins;
+}
+
+//!\brief Returns the technical bin of each given user bin. The user bins are matched by their file names.
+std::vector<size_t> find_user_bins(raptor_index<> const & index,
+                                   std::vector<std::vector<std::string>> const & user_bins)
+{
+    auto const & bin_path = index.bin_path();
+    std::vector<size_t> result{};
+    std::vector<bool> already_matched(bin_path.size(), false);
+
+    for (auto const & user_bin : user_bins)
+    {
+        size_t bin{};
+        // The same files may be used for more than one user bin.
+        while (bin < bin_path.size() && (already_matched[bin] || bin_path[bin] != user_bin))
+            ++bin;
+
+        if (bin == bin_path.size())
+            throw sharg::validation_error{sharg::detail::to_string("The user bin ",
+                                                                   user_bin[0],
+                                                                   (user_bin.size() > 1u) ? " (and others)" : "",
+                                                                   " is not part of the index.")};
+
+        already_matched[bin] = true;
+        result.push_back(bin);
+    }
+
+    return result;
+}
+
+//!\brief Clears the columns of the given technical bins. The cost is proportional to the bin size.
+void clear_bins(raptor_index<> & index, std::vector<size_t> const & bins)
+{
+    auto & ibf = index.ibf();
+    for (size_t const bin : bins)
+        ibf.clear(seqan3::bin_index{bin});
+}
+
+/*!\brief Hashes the given user bins into the given technical bins.
+ * \returns The number of distinct inserted hashes for each user bin.
+ */
+std::vector<size_t> insert_user_bins(raptor_index<> & index,
+                                     std::vector<std::vector<std::string>> const & bin_paths,
+                                     std::vector<size_t> const & target_bins,
+                                     update_arguments const & arguments,
+                                     partition_config const * const config,
+                                     size_t const part)
+{
+    assert(bin_paths.size() == target_bins.size());
+
+    file_reader<file_types::sequence> const sequence_reader{arguments.shape, arguments.window_size};
+    file_reader<file_types::minimiser> const minimiser_reader{};
+    std::vector<size_t> counts(bin_paths.size());
+
+    auto worker = [&](auto && zipped_view, auto &&)
+    {
+        timer<concurrent::no> local_timer{};
+        auto & ibf = index.ibf();
+        local_timer.start();
+        std::vector<uint64_t> hashes{};
+        for (auto && [file_names, bin_number] : zipped_view)
+        {
+            seqan3::bin_index const bin{target_bins[bin_number]};
+
+            auto in_part = [&](uint64_t const hash)
+            {
+                return config == nullptr || config->hash_partition(hash) == part;
+            };
+
+            hashes.clear();
+            if (std::filesystem::path{file_names[0]}.extension() == ".minimiser")
+                minimiser_reader.hash_into_if(file_names, std::back_inserter(hashes), in_part);
+            else
+                sequence_reader.hash_into_if(file_names, std::back_inserter(hashes), in_part);
+
+            // The FPR depends on the number of distinct hashes. Inserting each hash once is also faster.
+            detail::radix_sort(hashes, 1u);
+            auto const duplicates = std::ranges::unique(hashes);
+            hashes.erase(duplicates.begin(), duplicates.end());
+
+            for (uint64_t const hash : hashes)
+                ibf.emplace(hash, bin);
+            counts[bin_number] = hashes.size();
+        }
+        local_timer.stop();
+        arguments.user_bin_io_timer += local_timer;
+    };
+
+    call_parallel_on_bins(worker, bin_paths, arguments.threads);
+
+    return counts;
+}
+
+//!\brief Warns about user bins whose false positive rate exceeds the one the index was built for.
+void check_fpr(raptor_index<> const & index,
+               std::vector<std::vector<std::string>> const & bin_paths,
+               std::vector<size_t> const & counts,
+               std::filesystem::path const & index_file)
+{
+    auto const & ibf = index.ibf();
+
+    for (size_t i = 0; i < bin_paths.size(); ++i)
+    {
+        double const fpr = index_upgrader<>::compute_fpr(ibf.hash_function_count(), counts[i], ibf.bin_size());
+
+        if (fpr > index.fpr())
+        {
+            std::cerr << sharg::detail::to_string("[WARNING] The user bin ",
+                                                  bin_paths[i][0],
+                                                  (bin_paths[i].size() > 1u) ? " (and others)" : "",
+                                                  " has a false positive rate of ",
+                                                  fpr,
+                                                  " in ",
+                                                  index_file.c_str(),
+                                                  ", which exceeds the index's false positive rate of ",
+                                                  index.fpr(),
+                                                  ". Consider rebuilding the index.\n");
+        }
+    }
+}
+
+void update_index(update_arguments const & arguments,
+                  std::filesystem::path const & index_file,
+                  std::filesystem::path const & output_file,
+                  partition_config const * const config,
+                  size_t const part)
+{
+    raptor_index<> index{};
+    arguments.load_index_timer.start();
+    load_index(index, index_file, arguments.threads);
+    arguments.load_index_timer.stop();
+
+    auto & bin_path = index.bin_path();
+
+    // Match all user bins before changing anything.
+    std::vector<size_t> const removed_bins = find_user_bins(index, arguments.remove_bin_path);
+    std::vector<size_t> const replaced_bins = find_user_bins(index, arguments.replace_bin_path);
+
+    if (!removed_bins.empty())
+    {
+        clear_bins(index, removed_bins);
+        for (size_t const bin : removed_bins)
+            bin_path[bin].clear();
+    }
+
+    if (!replaced_bins.empty())
+    {
+        clear_bins(index, replaced_bins);
+        std::vector<size_t> const counts =
+            insert_user_bins(index, arguments.replacement_bin_path, replaced_bins, arguments, config, part);
+        check_fpr(index, arguments.replacement_bin_path, counts, index_file);
+
+        for (size_t i = 0; i < replaced_bins.size(); ++i)
+            bin_path[replaced_bins[i]] = arguments.replacement_bin_path[i];
+    }
+
+    if (!arguments.insert_bin_path.empty())
+    {
+        std::vector<size_t> const target_bins = assign_free_bins(index, arguments.insert_bin_path.size());
+        std::vector<size_t> const counts =
+            insert_user_bins(index, arguments.insert_bin_path, target_bins, arguments, config, part);
+        check_fpr(index, arguments.insert_bin_path, counts, index_file);
+
+        bin_path.resize(std::max<size_t>(bin_path.size(), target_bins.back() + 1u));
+        for (size_t i = 0; i < target_bins.size(); ++i)
+            bin_path[target_bins[i]] = arguments.insert_bin_path[i];
+    }
+
+    // Trailing empty bins become reserved bins.
+    while (!bin_path.empty() && bin_path.back().empty())
+        bin_path.pop_back();
+
+    arguments.store_index_timer.start();
+    store_index(output_file, std::move(index), arguments);
+    arguments.store_index_timer.stop();
+}
+
+} // namespace detail
+
+void raptor_update(update_arguments const & arguments)
+{
+    if (arguments.parts == 1u)
+    {
+        detail::update_index(arguments, arguments.index_file, arguments.output_file, nullptr, 0u);
+        return;
+    }
+
+    partition_config const cfg{arguments.parts};
+    std::string const index_path_base = arguments.index_file.string() + '_';
+    std::string const output_path_base = arguments.output_file.string() + '_';
+
+    for (size_t part{0}; part < arguments.parts; ++part)
+    {
+        detail::update_index(arguments,
+                             index_path_base + std::to_string(part),
+                             output_path_base + std::to_string(part),
+                             std::addressof(cfg),
+                             part);
+    }
+}
+
+} // namespace raptor
@@ -13,14 +13,57 @@
 #include <raptor/argument_parsing/compute_bin_size.hpp>
 #include <raptor/argument_parsing/validators.hpp>
 #include <raptor/build/max_count_per_partition.hpp>
+#include <raptor/build/store_index.hpp>
+#include <raptor/search/load_index.hpp>
 #include <raptor/upgrade/index_upgrader.hpp>
 #include <raptor/upgrade/upgrade.hpp>
 
 namespace raptor
 {
 
+template <typename data_t>
+void rewrite_index(std::filesystem::path const & index_file,
+                   std::filesystem::path const & output_file,
+                   size_t const threads)
+{
+    raptor_index<data_t> index{};
+    detail::load_index(index, index_file, threads);
+    detail::write_index(index, output_file, threads);
+}
+
+// Indices of version 2 can be loaded and only need to be stored with the current version.
+void rewrite_index(upgrade_arguments const & arguments)
+{
+    auto rewrite = [&](std::filesystem::path const & index_file, std::filesystem::path const & output_file)
+    {
+        if (arguments.is_hibf && arguments.compressed)
+            rewrite_index<index_structure::hibf_compressed>(index_file, output_file, arguments.threads);
+        else if (arguments.is_hibf)
+            rewrite_index<index_structure::hibf>(index_file, output_file, arguments.threads);
+        else if (arguments.compressed)
+            rewrite_index<index_structure::ibf_compressed>(index_file, output_file, arguments.threads);
+        else
+            rewrite_index<index_structure::ibf>(index_file, output_file, arguments.threads);
+    };
+
+    if (arguments.parts == 1u)
+    {
+        rewrite(arguments.index_file, arguments.output_file);
+        return;
+    }
+
+    for (size_t part{0}; part < arguments.parts; ++part)
+    {
+        std::string const suffix = '_' + std::to_string(part);
+        rewrite(arguments.index_file.string() + suffix, arguments.output_file.string() + suffix);
+    }
+}
+
 void raptor_upgrade(upgrade_arguments & arguments)
 {
+    if (arguments.index_version == 2u)
+        return rewrite_index(arguments);
+
     std::variant<index_upgrader<seqan3::data_layout::uncompressed>, index_upgrader<seqan3::data_layout::compressed>>
         upgrader{};
 
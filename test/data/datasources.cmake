@@ -100,11 +100,11 @@ declare_internal_datasource (FILE 64bins23windowc.index
 
 declare_internal_datasource (FILE 1bins19window.hibf
                              URL ${CMAKE_CURRENT_LIST_DIR}/hibf/1bins19window.hibf
-                             URL_HASH SHA256=2a49572c03edded5bd80f6a21d360344f5f39667c223d8a7652295a72673b973
+                             URL_HASH SHA256=33a99ac90782fcbdf9d7af35ea3ca9caec5eb37f039aaca08519aa960b302786
 )
 declare_internal_datasource (FILE 1bins23window.hibf
                              URL ${CMAKE_CURRENT_LIST_DIR}/hibf/1bins23window.hibf
-                             URL_HASH SHA256=14eb9a5b77ab98deaf0ec2c126107fce4bf558815acb4ab509d471ee129cf902
+                             URL_HASH SHA256=8e6c8a93b5a4983e6d310f2ebbd3960c8157c63e63168a3fef1dc91685297a89
 )
 declare_internal_datasource (FILE 64bins19window.hibf
                              URL ${CMAKE_CURRENT_LIST_DIR}/hibf/64bins19window.hibf
@@ -116,15 +116,15 @@ declare_internal_datasource (FILE 64bins23window.hibf
 )
 declare_internal_datasource (FILE 128bins19window.hibf
                              URL ${CMAKE_CURRENT_LIST_DIR}/hibf/128bins19window.hibf
-                             URL_HASH SHA256=21165f0bef2ac8c3b2a9c243d3afb60febdf18507b5d6154bdb3a074339caa96
+                             URL_HASH SHA256=2294cc10eb6b3da413c0fbe5d7de2a991a749a84171ac6e41c6a4b6059740537
 )
 declare_internal_datasource (FILE 128bins23window.hibf
                              URL ${CMAKE_CURRENT_LIST_DIR}/hibf/128bins23window.hibf
-                             URL_HASH SHA256=da8eecf7a1ed4e5aa09c3de09088dacbb6d8549cbc598c4b047df7894080416e
+                             URL_HASH SHA256=19fbac49f3bc7486174b60bdf512781bd69e7fe989b9e47ed0d0f0f7752ce506
 )
 declare_internal_datasource (FILE three_levels.hibf
                              URL ${CMAKE_CURRENT_LIST_DIR}/hibf/three_levels.hibf
-                             URL_HASH SHA256=d04b045cf1db05a5ebc53b26e1bd2aaec430742310698dd4605990ab962fa439
+                             URL_HASH SHA256=7ebddb59231309acc7c49661125e60bce61f78492102ad96195ee22578b008eb
 )
 
 declare_internal_datasource (FILE 1bins.pack
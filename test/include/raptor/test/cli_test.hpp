@@ -296,6 +296,9 @@ struct raptor_base : public cli_test
         }
         else
         {
+            // The HIBF build numbers IBFs depth-first with the merged bins of each IBF largest first, regardless of the
+            // number of threads. The expected indices may order merged bins differently. Hence, IBFs are matched by
+            // value.
             auto const &expected_ibfs{expected_index.ibf().ibf_vector}, actual_ibfs{actual_index.ibf().ibf_vector};
             for (auto const & expected_ibf : expected_ibfs)
             {
@@ -0,0 +1,97 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include <seqan3/search/dream_index/interleaved_bloom_filter.hpp>
+
+#include <raptor/counting_kernel.hpp>
+
+#define USE_UNIT_TEST_PARAMETERS 1
+
+#if USE_UNIT_TEST_PARAMETERS
+static constexpr size_t const ibf_bits{1ULL << 24}; // 2 MiB
+static constexpr size_t const query_count{128};
+#else
+static constexpr size_t const ibf_bits{1ULL << 35}; // 4 GiB
+static constexpr size_t const query_count{1ULL << 16};
+#endif
+
+static constexpr size_t const bins{1024u};
+static constexpr size_t const hash_num{2u};
+static constexpr size_t const minimiser_per_query{50u};
+
+using ibf_t = seqan3::interleaved_bloom_filter<seqan3::data_layout::uncompressed>;
+
+// The counting does not depend on the content of the IBF. Only a few bits are set.
+static ibf_t const ibf{[]()
+                       {
+                           ibf_t result{seqan3::bin_count{bins},
+                                        seqan3::bin_size{ibf_bits / bins},
+                                        seqan3::hash_function_count{hash_num}};
+                           for (uint64_t value = 0; value < (1u << 16); ++value)
+                               result.emplace(value, seqan3::bin_index{value % bins});
+                           return result;
+                       }()};
+
+static std::vector<std::vector<uint64_t>> const queries{[]()
+                                                        {
+                                                            std::mt19937_64 engine{42u};
+                                                            std::vector<std::vector<uint64_t>> result(query_count);
+                                                            for (auto & query : result)
+                                                            {
+                                                                query.resize(minimiser_per_query);
+                                                                for (uint64_t & value : query)
+                                                                    value = engine();
+                                                            }
+                                                            return result;
+                                                        }()};
+
+template <typename counter_t>
+static void run(benchmark::State & state, counter_t && counter)
+{
+    for (auto _ : state)
+    {
+        for (auto const & query : queries)
+        {
+            auto & result = counter.bulk_count(query);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+
+    state.counters["minimiser/s"] =
+        benchmark::Counter(query_count * minimiser_per_query, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void seqan3_agent(benchmark::State & state)
+{
+    run(state, ibf.counting_agent<uint16_t>());
+}
+
+static void kernel(benchmark::State & state)
+{
+    run(state, raptor::counting_kernel<hash_num, bins / 64u, 0u>{ibf});
+}
+
+static void kernel_prefetch(benchmark::State & state)
+{
+    run(state, raptor::counting_kernel<hash_num, bins / 64u>{ibf});
+}
+
+static void generic_kernel_prefetch(benchmark::State & state)
+{
+    run(state, raptor::counting_kernel<>{ibf});
+}
+
+BENCHMARK(seqan3_agent);
+BENCHMARK(kernel);
+BENCHMARK(kernel_prefetch);
+BENCHMARK(generic_kernel_prefetch);
+
+BENCHMARK_MAIN();
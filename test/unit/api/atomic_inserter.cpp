@@ -0,0 +1,48 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <raptor/build/atomic_inserter.hpp>
+
+TEST(atomic_inserter, is_compatible)
+{
+    EXPECT_TRUE(raptor::detail::atomic_inserter_is_compatible());
+}
+
+TEST(atomic_inserter, concurrent_same_as_seqan3)
+{
+    size_t const bins{200u};
+    size_t const values{20000u};
+    size_t const threads{8u};
+
+    seqan3::interleaved_bloom_filter<> expected{seqan3::bin_count{bins},
+                                                seqan3::bin_size{4099u},
+                                                seqan3::hash_function_count{3u}};
+    seqan3::interleaved_bloom_filter<> actual{expected};
+
+    for (uint64_t value = 0; value < values; ++value)
+        expected.emplace(value * 0xBF58476D1CE4E5B9ULL, seqan3::bin_index{value % bins});
+
+    {
+        raptor::atomic_inserter inserter{actual};
+        std::vector<std::thread> workers{};
+        for (size_t t = 0; t < threads; ++t)
+            workers.emplace_back(
+                [&, t]()
+                {
+                    for (uint64_t value = t; value < values; value += threads)
+                        inserter.emplace(value * 0xBF58476D1CE4E5B9ULL, seqan3::bin_index{value % bins});
+                });
+        for (auto & worker : workers)
+            worker.join();
+    }
+
+    EXPECT_TRUE(expected == actual);
+}
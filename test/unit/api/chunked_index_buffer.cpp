@@ -0,0 +1,263 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <numeric>
+#include <random>
+
+#include <raptor/io/chunked_index_buffer.hpp>
+
+struct chunked_index_buffer : public ::testing::TestWithParam<size_t>
+{
+    std::filesystem::path const file{std::filesystem::temp_directory_path() / "raptor_chunked_index_buffer_test.bin"};
+    std::vector<std::vector<char>> blocks{};
+
+    void SetUp() override
+    {
+        std::mt19937_64 engine{42u};
+        for (size_t const size : {3u, 100u, 5000u, 2'097'152u, 7u, 3'000'000u, 1'048'576u, 12u})
+        {
+            std::vector<char> & block = blocks.emplace_back(size);
+            for (char & c : block)
+                c = static_cast<char>(engine());
+        }
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove(file);
+    }
+
+    void write_blocks()
+    {
+        raptor::chunked_index_output_buffer buffer{file, 4u, GetParam()};
+        for (auto const & block : blocks)
+            ASSERT_EQ(buffer.sputn(block.data(), block.size()), static_cast<std::streamsize>(block.size()));
+        buffer.close();
+    }
+
+    // The number of files whose name starts with the name of `file`, i.e., `file` and temporary files.
+    size_t files_next_to_file() const
+    {
+        std::string const prefix{file.filename().string()};
+        size_t count{};
+        for (auto const & entry : std::filesystem::directory_iterator{file.parent_path()})
+            count += entry.path().filename().string().starts_with(prefix);
+        return count;
+    }
+};
+
+TEST_P(chunked_index_buffer, roundtrip)
+{
+    write_blocks();
+
+    raptor::chunked_index_input_buffer buffer{file, 4u};
+    EXPECT_TRUE(buffer.has_checksums());
+    for (auto const & block : blocks)
+    {
+        std::vector<char> result(block.size());
+        ASSERT_EQ(buffer.sgetn(result.data(), result.size()), static_cast<std::streamsize>(block.size()));
+        EXPECT_TRUE(result == block);
+    }
+}
+
+TEST_P(chunked_index_buffer, readable_by_ifstream)
+{
+    write_blocks();
+
+    std::ifstream is{file, std::ios::binary};
+    for (auto const & block : blocks)
+    {
+        std::vector<char> result(block.size());
+        is.read(result.data(), result.size());
+        EXPECT_TRUE(result == block);
+    }
+}
+
+TEST_P(chunked_index_buffer, corrupted)
+{
+    write_blocks();
+
+    {
+        std::fstream fs{file, std::ios::in | std::ios::out | std::ios::binary};
+        fs.seekp(2'500'000);
+        fs.put('x');
+    }
+
+    auto read_all = [&]()
+    {
+        raptor::chunked_index_input_buffer buffer{file, 4u};
+        for (auto const & block : blocks)
+        {
+            std::vector<char> result(block.size());
+            buffer.sgetn(result.data(), result.size());
+        }
+    };
+
+    EXPECT_THROW(read_all(), std::runtime_error);
+}
+
+TEST_P(chunked_index_buffer, seek)
+{
+    write_blocks();
+
+    size_t offset{};
+    for (auto const & block : blocks)
+    {
+        raptor::chunked_index_input_buffer buffer{file, 4u};
+        ASSERT_EQ(buffer.pubseekpos(offset), static_cast<std::streamoff>(offset));
+        std::vector<char> result(block.size());
+        ASSERT_EQ(buffer.sgetn(result.data(), result.size()), static_cast<std::streamsize>(block.size()));
+        EXPECT_TRUE(result == block);
+        EXPECT_NO_THROW(buffer.finish());
+        offset += block.size();
+    }
+}
+
+TEST_P(chunked_index_buffer, seek_corrupted)
+{
+    write_blocks();
+
+    // The block of 3'000'000 bytes. Its segments start at the block.
+    size_t const offset = std::accumulate(blocks.begin(),
+                                          blocks.begin() + 5,
+                                          size_t{},
+                                          [](size_t const sum, std::vector<char> const & block)
+                                          {
+                                              return sum + block.size();
+                                          });
+
+    auto corrupt = [&](size_t const position)
+    {
+        write_blocks();
+        std::fstream fs{file, std::ios::in | std::ios::out | std::ios::binary};
+        fs.seekp(position);
+        fs.put(static_cast<char>(~blocks[5][position - offset]));
+    };
+
+    auto read_range = [&]()
+    {
+        raptor::chunked_index_input_buffer buffer{file, 4u};
+        buffer.pubseekpos(offset + 20u);
+        std::vector<char> result(100u);
+        buffer.sgetn(result.data(), result.size());
+        buffer.finish();
+    };
+
+    // Before the range, in the same segment.
+    corrupt(offset + 10u);
+    EXPECT_THROW(read_range(), std::runtime_error);
+
+    // After the range, in the same segment.
+    corrupt(offset + std::min<size_t>(GetParam(), blocks[5].size()) - 1u);
+    EXPECT_THROW(read_range(), std::runtime_error);
+}
+
+TEST_P(chunked_index_buffer, seek_verifies_open_segment)
+{
+    write_blocks();
+
+    {
+        std::fstream fs{file, std::ios::in | std::ios::out | std::ios::binary};
+        fs.seekp(blocks[0].size() + blocks[1].size() - 1u);
+        fs.put(static_cast<char>(~blocks[1].back()));
+    }
+
+    // Only the first block is read before seeking. Its segment may contain the corrupted byte, too.
+    auto read_and_seek = [&]()
+    {
+        raptor::chunked_index_input_buffer buffer{file, 4u};
+        std::vector<char> result(blocks[0].size());
+        buffer.sgetn(result.data(), result.size());
+        buffer.pubseekpos(blocks[0].size() + blocks[1].size());
+    };
+
+    EXPECT_THROW(read_and_seek(), std::runtime_error);
+}
+
+TEST_P(chunked_index_buffer, not_closed)
+{
+    {
+        raptor::chunked_index_output_buffer buffer{file, 4u, GetParam()};
+        for (auto const & block : blocks)
+            ASSERT_EQ(buffer.sputn(block.data(), block.size()), static_cast<std::streamsize>(block.size()));
+        EXPECT_FALSE(std::filesystem::exists(file));
+        EXPECT_EQ(files_next_to_file(), 1u);
+    }
+
+    // Without close(), e.g., because serialising the index threw, the incomplete file is removed.
+    EXPECT_FALSE(std::filesystem::exists(file));
+    EXPECT_EQ(files_next_to_file(), 0u);
+}
+
+TEST_P(chunked_index_buffer, not_closed_keeps_existing_file)
+{
+    {
+        std::ofstream os{file};
+        os << "existing index";
+    }
+
+    {
+        raptor::chunked_index_output_buffer buffer{file, 4u, GetParam()};
+        for (auto const & block : blocks)
+            ASSERT_EQ(buffer.sputn(block.data(), block.size()), static_cast<std::streamsize>(block.size()));
+    }
+
+    std::ifstream is{file};
+    std::string content{};
+    std::getline(is, content);
+    EXPECT_EQ(content, "existing index");
+    EXPECT_EQ(files_next_to_file(), 1u);
+}
+
+TEST_P(chunked_index_buffer, replaces_existing_file)
+{
+    {
+        std::ofstream os{file};
+        os << "existing index";
+    }
+
+    write_blocks();
+    EXPECT_EQ(files_next_to_file(), 1u);
+
+    raptor::chunked_index_input_buffer buffer{file, 4u};
+    EXPECT_TRUE(buffer.has_checksums());
+    for (auto const & block : blocks)
+    {
+        std::vector<char> result(block.size());
+        ASSERT_EQ(buffer.sgetn(result.data(), result.size()), static_cast<std::streamsize>(block.size()));
+        EXPECT_TRUE(result == block);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(chunk_size,
+                         chunked_index_buffer,
+                         testing::Values(4096u, raptor::chunked_index_output_buffer::default_chunk_size));
+
+TEST(chunked_index_buffer_without_checksums, read)
+{
+    std::filesystem::path const file{std::filesystem::temp_directory_path() / "raptor_chunked_index_buffer_plain.bin"};
+    std::vector<char> block(1'000'000u);
+    std::iota(block.begin(), block.end(), 0);
+
+    {
+        std::ofstream os{file, std::ios::binary};
+        os.write(block.data(), block.size());
+    }
+
+    {
+        raptor::chunked_index_input_buffer buffer{file, 2u};
+        EXPECT_FALSE(buffer.has_checksums());
+        std::vector<char> result(block.size());
+        EXPECT_EQ(buffer.sgetn(result.data(), result.size()), static_cast<std::streamsize>(block.size()));
+        EXPECT_TRUE(result == block);
+    }
+
+    std::filesystem::remove(file);
+}
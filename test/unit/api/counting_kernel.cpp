@@ -0,0 +1,63 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <raptor/counting_kernel.hpp>
+
+TEST(counting_kernel, is_compatible)
+{
+    EXPECT_TRUE(raptor::detail::counting_kernel_is_compatible());
+}
+
+TEST(counting_kernel, same_as_seqan3)
+{
+    std::vector<uint64_t> values(1000u);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = i * 0xBF58476D1CE4E5B9ULL;
+
+    for (size_t const bins : {64u, 100u, 1024u, 8192u})
+    {
+        for (size_t const hash : {2u, 3u, 4u})
+        {
+            seqan3::interleaved_bloom_filter<> ibf{seqan3::bin_count{bins},
+                                                  seqan3::bin_size{4096u},
+                                                  seqan3::hash_function_count{hash}};
+            for (size_t i = 0; i < values.size(); i += 2u)
+                ibf.emplace(values[i], seqan3::bin_index{i % bins});
+
+            auto agent = ibf.counting_agent<uint16_t>();
+            auto const & expected = agent.bulk_count(values);
+
+            raptor::with_counting_kernel(ibf,
+                                         [&](auto && make_counter)
+                                         {
+                                             auto counter = make_counter();
+                                             EXPECT_EQ(counter.bulk_count(values), expected)
+                                                 << "bins: " << bins << ", hash functions: " << hash;
+                                         });
+        }
+    }
+}
+
+TEST(counting_kernel, compressed)
+{
+    seqan3::interleaved_bloom_filter<> ibf{seqan3::bin_count{64u},
+                                          seqan3::bin_size{1024u},
+                                          seqan3::hash_function_count{2u}};
+    ibf.emplace(7u, seqan3::bin_index{3u});
+    seqan3::interleaved_bloom_filter<seqan3::data_layout::compressed> const compressed_ibf{ibf};
+
+    std::vector<uint64_t> const values{7u};
+    raptor::with_counting_kernel(compressed_ibf,
+                                 [&](auto && make_counter)
+                                 {
+                                     auto counter = make_counter();
+                                     auto & result = counter.bulk_count(values);
+                                     EXPECT_EQ(result[3], 1u);
+                                 });
+}
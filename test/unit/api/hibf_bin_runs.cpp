@@ -0,0 +1,96 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <raptor/hierarchical_interleaved_bloom_filter.hpp>
+
+// IBF 0: user bin 0 is split into bins 0 and 1, bin 2 is merged (IBF 1), bin 3 is user bin 1.
+// IBF 1: bin 0 is user bin 2, bin 1 is user bin 3.
+static raptor::hierarchical_interleaved_bloom_filter<> two_level_hibf()
+{
+    raptor::hierarchical_interleaved_bloom_filter<> hibf{};
+    hibf.ibf_vector.emplace_back(seqan3::bin_count{4u}, seqan3::bin_size{1024u}, seqan3::hash_function_count{2u});
+    hibf.ibf_vector.emplace_back(seqan3::bin_count{2u}, seqan3::bin_size{1024u}, seqan3::hash_function_count{2u});
+    hibf.next_ibf_id = {{0, 0, 1, 0}, {1, 1}};
+    hibf.user_bins.set_ibf_count(2u);
+    hibf.user_bins.set_user_bin_count(4u);
+    hibf.user_bins.bin_indices_of_ibf(0) = {0, 0, -1, 1};
+    hibf.user_bins.bin_indices_of_ibf(1) = {2, 3};
+    hibf.update_bin_runs();
+    return hibf;
+}
+
+TEST(hibf_bin_runs, runs)
+{
+    using bin_run = raptor::hierarchical_interleaved_bloom_filter<>::bin_run;
+    auto const hibf = two_level_hibf();
+
+    EXPECT_EQ(hibf.bin_run_offsets, (std::vector<uint32_t>{0u, 3u, 5u}));
+    ASSERT_EQ(hibf.bin_runs.size(), 5u);
+
+    std::vector<std::pair<uint32_t, uint32_t>> runs{};
+    for (bin_run const & run : hibf.bin_runs)
+        runs.emplace_back(run.end, run.target);
+
+    EXPECT_EQ(runs,
+              (std::vector<std::pair<uint32_t, uint32_t>>{{2u, 0u},
+                                                           {3u, 1u | bin_run::merged_flag},
+                                                           {4u, 1u},
+                                                           {1u, 2u},
+                                                           {2u, 3u}}));
+}
+
+TEST(hibf_bin_runs, membership)
+{
+    auto hibf = two_level_hibf();
+    hibf.ibf_vector[0].emplace(7u, seqan3::bin_index{0u});
+    hibf.ibf_vector[0].emplace(7u, seqan3::bin_index{1u});
+    hibf.ibf_vector[0].emplace(7u, seqan3::bin_index{2u});
+    hibf.ibf_vector[1].emplace(7u, seqan3::bin_index{1u});
+
+    std::vector<uint64_t> const values{7u};
+    auto agent = hibf.membership_agent();
+    auto & result = agent.bulk_contains(values, 1u);
+
+    EXPECT_EQ(result, (std::vector<int64_t>{0, 3}));
+}
+
+TEST(hibf_bin_runs, hybrid_membership)
+{
+    auto const uncompressed = two_level_hibf();
+    seqan3::interleaved_bloom_filter<> root{uncompressed.ibf_vector[0]};
+    seqan3::interleaved_bloom_filter<> child{uncompressed.ibf_vector[1]};
+    root.emplace(7u, seqan3::bin_index{0u});
+    root.emplace(7u, seqan3::bin_index{1u});
+    root.emplace(7u, seqan3::bin_index{2u});
+    child.emplace(7u, seqan3::bin_index{1u});
+
+    // The root stays uncompressed, the child is compressed.
+    raptor::hierarchical_interleaved_bloom_filter<seqan3::data_layout::compressed> hibf{};
+    hibf.ibf_vector.resize(2u);
+    hibf.uncompressed_ibfs.resize(2u);
+    hibf.store_ibf(0u, std::move(root), true);
+    hibf.store_ibf(1u, std::move(child));
+    hibf.next_ibf_id = uncompressed.next_ibf_id;
+    hibf.user_bins.set_ibf_count(2u);
+    hibf.user_bins.set_user_bin_count(4u);
+    hibf.user_bins.bin_indices_of_ibf(0) = {0, 0, -1, 1};
+    hibf.user_bins.bin_indices_of_ibf(1) = {2, 3};
+    hibf.update_bin_runs();
+
+    EXPECT_TRUE(hibf.is_uncompressed(0u));
+    EXPECT_FALSE(hibf.is_uncompressed(1u));
+    EXPECT_EQ(hibf.ibf_vector[0].bin_count(), 0u);
+    EXPECT_EQ(hibf.ibf_vector[1].bin_count(), 2u);
+
+    std::vector<uint64_t> const values{7u};
+    auto agent = hibf.membership_agent();
+    auto & result = agent.bulk_contains(values, 1u);
+
+    EXPECT_EQ(result, (std::vector<int64_t>{0, 3}));
+}
@@ -0,0 +1,132 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <numeric>
+
+#include <raptor/build/store_index.hpp>
+#include <raptor/search/load_index.hpp>
+
+// An HIBF with three IBFs: The root, a merged bin with 2 user bins, and a merged bin with 70 user bins.
+raptor::index_structure::hibf example_hibf()
+{
+    raptor::index_structure::hibf hibf{};
+    for (size_t const bins : {4u, 2u, 70u})
+    {
+        auto & ibf = hibf.ibf_vector.emplace_back(seqan3::bin_count{bins},
+                                                  seqan3::bin_size{1024u * bins},
+                                                  seqan3::hash_function_count{2u});
+        ibf.emplace(bins, seqan3::bin_index{1u});
+    }
+    hibf.next_ibf_id = {{0, 0, 1, 2}, {1, 1}, std::vector<int64_t>(70u, 2)};
+    hibf.user_bins.set_ibf_count(3u);
+    hibf.user_bins.set_user_bin_count(73u);
+    hibf.user_bins.bin_indices_of_ibf(0) = {0, 0, -1, -1};
+    hibf.user_bins.bin_indices_of_ibf(1) = {1, 2};
+    hibf.user_bins.bin_indices_of_ibf(2).resize(70u);
+    std::iota(hibf.user_bins.bin_indices_of_ibf(2).begin(), hibf.user_bins.bin_indices_of_ibf(2).end(), 3);
+    hibf.update_bin_runs();
+    return hibf;
+}
+
+TEST(hibf_offsets, lazy_load)
+{
+    std::filesystem::path const file{std::filesystem::temp_directory_path() / "raptor_hibf_offsets_test.index"};
+    raptor::index_structure::hibf const hibf = example_hibf();
+
+    raptor::raptor_index<raptor::index_structure::hibf> const expected{raptor::window{19u},
+                                                                       seqan3::ungapped{19u},
+                                                                       1u,
+                                                                       false,
+                                                                       {{"bin"}},
+                                                                       0.05,
+                                                                       raptor::index_structure::hibf{hibf}};
+    raptor::detail::write_index(expected, file, 2u);
+
+    raptor::hibf_offsets offsets{};
+    ASSERT_TRUE(offsets.read(file));
+    EXPECT_EQ(offsets.ibf_offsets.size(), 3u);
+
+    // A complete load ignores the offsets.
+    raptor::raptor_index<raptor::index_structure::hibf> complete{};
+    raptor::detail::load_index(complete, file);
+    EXPECT_EQ(complete.ibf().ibf_vector, hibf.ibf_vector);
+
+    raptor::raptor_index<raptor::index_structure::hibf> lazy{};
+    raptor::detail::load_index_lazily(lazy, file);
+    EXPECT_TRUE(lazy.ibf().ibf_vector.empty());
+    EXPECT_EQ(lazy.ibf().next_ibf_id, hibf.next_ibf_id);
+    EXPECT_EQ(lazy.ibf().bin_runs.size(), hibf.bin_runs.size());
+    EXPECT_EQ(lazy.window_size(), 19u);
+
+    for (size_t i = 0; i < 3u; ++i)
+        EXPECT_EQ(*lazy.ibf().ibf(i), hibf.ibf_vector[i]) << "IBF " << i;
+
+    // Without a limit, IBFs stay loaded. The root is loaded by load_index_lazily.
+    EXPECT_EQ(lazy.ibf().ibf(1), lazy.ibf().ibf(1));
+    raptor::lazy_ibf_statistics const unlimited_statistics = lazy.ibf().lazy_ibfs->statistics();
+    EXPECT_EQ(unlimited_statistics.hits, 3u);
+    EXPECT_EQ(unlimited_statistics.misses, 3u);
+    EXPECT_EQ(unlimited_statistics.evictions, 0u);
+
+    // With a limit of 1 byte, only the most recently used IBF stays loaded.
+    raptor::raptor_index<raptor::index_structure::hibf> limited{};
+    raptor::detail::load_index_lazily(limited, file, 1u, 1u);
+    auto const & limited_hibf = limited.ibf();
+
+    auto const first = limited_hibf.ibf(1);  // miss, evicts IBF 0
+    EXPECT_EQ(limited_hibf.ibf(1), first);   // hit
+    auto const second = limited_hibf.ibf(2); // miss, evicts IBF 1
+    EXPECT_EQ(*first, hibf.ibf_vector[1]);   // An evicted IBF stays valid while it is used.
+    EXPECT_EQ(*second, hibf.ibf_vector[2]);
+    EXPECT_NE(limited_hibf.ibf(1), first); // miss, evicts IBF 2
+
+    raptor::lazy_ibf_statistics const statistics = limited_hibf.lazy_ibfs->statistics();
+    EXPECT_EQ(statistics.hits, 1u);
+    EXPECT_EQ(statistics.misses, 4u);
+    EXPECT_EQ(statistics.evictions, 3u);
+
+    std::filesystem::remove(file);
+}
+
+TEST(hibf_offsets, lazy_load_corrupted)
+{
+    std::filesystem::path const file{std::filesystem::temp_directory_path() / "raptor_hibf_offsets_corrupted.index"};
+    raptor::index_structure::hibf const hibf = example_hibf();
+
+    raptor::raptor_index<raptor::index_structure::hibf> const expected{raptor::window{19u},
+                                                                       seqan3::ungapped{19u},
+                                                                       1u,
+                                                                       false,
+                                                                       {{"bin"}},
+                                                                       0.05,
+                                                                       raptor::index_structure::hibf{hibf}};
+    // Small segments, such that IBF 2 does not share its segments with other IBFs.
+    raptor::detail::write_index(expected, file, 2u, 4096u);
+
+    raptor::hibf_offsets offsets{};
+    ASSERT_TRUE(offsets.read(file));
+
+    // A byte of the last word of IBF 2. Loading IBF 1 reads ahead, but not that far.
+    {
+        uint64_t const position = offsets.bookkeeping_offset - sizeof(uint64_t);
+        std::fstream fs{file, std::ios::in | std::ios::out | std::ios::binary};
+        fs.seekg(position);
+        char const byte = static_cast<char>(fs.get());
+        fs.seekp(position);
+        fs.put(static_cast<char>(~byte));
+    }
+
+    raptor::raptor_index<raptor::index_structure::hibf> lazy{};
+    raptor::detail::load_index_lazily(lazy, file);
+    EXPECT_EQ(*lazy.ibf().ibf(1), hibf.ibf_vector[1]);
+    EXPECT_THROW(lazy.ibf().ibf(2), std::runtime_error);
+
+    std::filesystem::remove(file);
+}
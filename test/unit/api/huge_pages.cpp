@@ -0,0 +1,44 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include <raptor/huge_pages.hpp>
+
+TEST(huge_pages, memory)
+{
+    std::vector<uint64_t> data(1ULL << 20, 42u); // 8 MiB
+
+    raptor::detail::advise_huge_pages(data.data(), data.size() * sizeof(uint64_t));
+    raptor::detail::advise_huge_pages(data.data(), 0u);
+    raptor::detail::advise_huge_pages(data.data() + 1, 1000u); // Less than a huge page
+
+    EXPECT_TRUE(std::ranges::all_of(data,
+                                    [](uint64_t const value)
+                                    {
+                                        return value == 42u;
+                                    }));
+}
+
+TEST(huge_pages, ibf)
+{
+    seqan3::interleaved_bloom_filter<> ibf{seqan3::bin_count{64u},
+                                           seqan3::bin_size{1ULL << 20},
+                                           seqan3::hash_function_count{2u}};
+    ibf.emplace(126u, seqan3::bin_index{3u});
+
+    raptor::advise_huge_pages(ibf);
+
+    auto agent = ibf.membership_agent();
+    auto & result = agent.bulk_contains(126u);
+    EXPECT_TRUE(result[3]);
+
+    seqan3::interleaved_bloom_filter<seqan3::data_layout::compressed> const compressed_ibf{ibf};
+    raptor::advise_huge_pages(compressed_ibf);
+}
@@ -0,0 +1,55 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <raptor/hyperloglog.hpp>
+
+TEST(hyperloglog, estimate)
+{
+    for (size_t const count : {10u, 1000u, 100000u})
+    {
+        raptor::hyperloglog sketch{};
+        for (size_t i = 0; i < count; ++i)
+        {
+            sketch.add(i);
+            sketch.add(i); // Duplicates are not counted.
+        }
+
+        EXPECT_NEAR(sketch.estimate(), count, count * 4 * raptor::hyperloglog::relative_error);
+    }
+}
+
+TEST(hyperloglog, merge)
+{
+    raptor::hyperloglog first{}, second{}, both{};
+    for (size_t i = 0; i < 20000u; ++i)
+    {
+        (i % 2 ? first : second).add(i);
+        both.add(i);
+    }
+
+    first.merge(second);
+    EXPECT_EQ(first.estimate(), both.estimate());
+}
+
+TEST(hyperloglog, store_and_load)
+{
+    raptor::hyperloglog sketch{}, loaded{};
+    for (size_t i = 0; i < 5000u; ++i)
+        sketch.add(i);
+
+    std::stringstream stream{};
+    sketch.store(stream);
+    EXPECT_TRUE(loaded.load(stream));
+    EXPECT_EQ(sketch.estimate(), loaded.estimate());
+
+    std::stringstream truncated{"abc"};
+    EXPECT_FALSE(loaded.load(truncated));
+}
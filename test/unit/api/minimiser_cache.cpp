@@ -0,0 +1,128 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <raptor/minimiser_cache.hpp>
+
+namespace
+{
+
+std::vector<uint64_t> read_entry(raptor::minimiser_cache const & cache, std::string const & filename, bool & found)
+{
+    std::vector<uint64_t> result{};
+    found = cache.for_each_span(filename,
+                                [&result](std::span<uint64_t const> const values)
+                                {
+                                    result.insert(result.end(), values.begin(), values.end());
+                                });
+    return result;
+}
+
+} // namespace
+
+TEST(minimiser_cache, write_and_read)
+{
+    std::filesystem::path const directory{std::filesystem::temp_directory_path() / "raptor_minimiser_cache_test"};
+    std::filesystem::path const input{directory / "input.fa"};
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    {
+        std::ofstream file{input};
+        file << ">seq\nACGT\n";
+    }
+
+    raptor::minimiser_cache const cache{directory / "cache", seqan3::ungapped{4u}, 4u};
+    std::vector<uint64_t> const minimisers{5u, 3u, 5u, 1u};
+    bool found{};
+    size_t count{};
+
+    EXPECT_TRUE(read_entry(cache, input, found).empty());
+    EXPECT_FALSE(found);
+    EXPECT_FALSE(cache.count(input, count));
+
+    {
+        raptor::minimiser_cache::writer writer{cache, input};
+        writer.insert(minimisers);
+        writer.commit();
+    }
+
+    EXPECT_EQ(read_entry(cache, input, found), (std::vector<uint64_t>{1u, 3u, 5u}));
+    EXPECT_TRUE(found);
+    EXPECT_TRUE(cache.count(input, count));
+    EXPECT_EQ(count, 3u);
+
+    // Other k-mer parameters do not use the entry.
+    raptor::minimiser_cache const other_cache{directory / "cache", seqan3::ungapped{4u}, 5u};
+    read_entry(other_cache, input, found);
+    EXPECT_FALSE(found);
+
+    // Modified files do not use the entry.
+    {
+        std::ofstream file{input, std::ios::app};
+        file << ">seq2\nTTTT\n";
+    }
+    read_entry(cache, input, found);
+    EXPECT_FALSE(found);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(minimiser_cache, runs)
+{
+    std::filesystem::path const directory{std::filesystem::temp_directory_path() / "raptor_minimiser_cache_runs_test"};
+    std::filesystem::path const input{directory / "input.fa"};
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    {
+        std::ofstream file{input};
+        file << ">seq\nACGT\n";
+    }
+
+    raptor::minimiser_cache const cache{directory / "cache", seqan3::ungapped{4u}, 4u};
+
+    // Enough buffers to merge file runs while inserting.
+    std::vector<uint64_t> values(100'000u);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = (i * 0x9E3779B97F4A7C15ULL) % 30'000u;
+
+    {
+        raptor::minimiser_cache::writer writer{cache, input, 1000u};
+        std::vector<std::thread> workers{};
+        for (size_t t = 0; t < 4u; ++t)
+            workers.emplace_back(
+                [&, t]()
+                {
+                    for (size_t start = t * 100u; start < values.size(); start += 400u)
+                        writer.insert(std::span<uint64_t const>{values}.subspan(start, 100u));
+                });
+        for (auto & worker : workers)
+            worker.join();
+        writer.commit();
+    }
+
+    std::vector<uint64_t> expected{values};
+    std::ranges::sort(expected);
+    auto const duplicates = std::ranges::unique(expected);
+    expected.erase(duplicates.begin(), duplicates.end());
+
+    bool found{};
+    EXPECT_EQ(read_entry(cache, input, found), expected);
+    EXPECT_TRUE(found);
+
+    // Only the entry is left.
+    size_t files{};
+    for ([[maybe_unused]] auto const & entry : std::filesystem::directory_iterator{directory / "cache"})
+        ++files;
+    EXPECT_EQ(files, 1u);
+
+    std::filesystem::remove_all(directory);
+}
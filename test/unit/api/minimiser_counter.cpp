@@ -0,0 +1,146 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+
+#include <raptor/prepare/minimiser_counter.hpp>
+
+std::vector<uint64_t> expected_minimisers(std::map<uint64_t, size_t> const & counts, uint8_t const cutoff)
+{
+    std::vector<uint64_t> result{};
+    for (auto const & [value, count] : counts)
+        if (std::min<size_t>(count, 254u) >= cutoff)
+            result.push_back(value);
+    return result;
+}
+
+std::vector<uint64_t> counted_minimisers(raptor::minimiser_counter & counter, uint8_t const cutoff)
+{
+    std::vector<uint64_t> result{};
+    counter.for_each(cutoff,
+                     [&result](uint64_t const value)
+                     {
+                         result.push_back(value);
+                     });
+    return result;
+}
+
+TEST(minimiser_counter, empty)
+{
+    raptor::minimiser_counter counter{};
+    EXPECT_TRUE(counted_minimisers(counter, 1u).empty());
+}
+
+TEST(minimiser_counter, saturates)
+{
+    raptor::minimiser_counter counter{};
+    for (size_t i = 0; i < 1000u; ++i)
+        counter.insert(7u);
+    counter.insert(3u);
+
+    EXPECT_EQ(counted_minimisers(counter, 1u), (std::vector<uint64_t>{3u, 7u}));
+    EXPECT_EQ(counted_minimisers(counter, 254u), (std::vector<uint64_t>{7u}));
+}
+
+TEST(minimiser_counter, in_memory)
+{
+    std::mt19937_64 engine{42u};
+    std::map<uint64_t, size_t> counts{};
+    raptor::minimiser_counter counter{};
+
+    for (size_t i = 0; i < 300'000u; ++i)
+    {
+        uint64_t const value = engine() % 100'000u;
+        ++counts[value];
+        counter.insert(value);
+    }
+
+    for (uint8_t const cutoff : {1u, 3u, 5u})
+        EXPECT_EQ(counted_minimisers(counter, cutoff), expected_minimisers(counts, cutoff)) << +cutoff;
+}
+
+TEST(minimiser_counter, spill)
+{
+    std::filesystem::path const tmp_prefix{std::filesystem::temp_directory_path() / "raptor_minimiser_counter"};
+    std::mt19937_64 engine{42u};
+    std::map<uint64_t, size_t> counts{};
+
+    // Directories created by the counter start with the prefix, followed by a unique suffix.
+    auto spill_directories = [&tmp_prefix]()
+    {
+        size_t count{};
+        std::string const name{tmp_prefix.filename().string() + '.'};
+        for (auto const & entry : std::filesystem::directory_iterator{tmp_prefix.parent_path()})
+            count += entry.path().filename().string().starts_with(name);
+        return count;
+    };
+
+    // A file that already exists at the prefix must not be removed.
+    std::filesystem::create_directories(tmp_prefix);
+    std::ofstream{tmp_prefix / "foreign"};
+    size_t const existing_directories = spill_directories();
+
+    {
+        // 1024 minimisers per buffer, runs of more than 4 KiB are written to disk.
+        raptor::minimiser_counter counter{8u * 1024u, tmp_prefix};
+
+        for (size_t i = 0; i < 500'000u; ++i)
+        {
+            // Some minimisers occur more often than the maximum count.
+            uint64_t const value = i % 2u ? engine() % 20'000u : engine() % 100u;
+            ++counts[value];
+            counter.insert(value);
+        }
+
+        for (uint8_t const cutoff : {1u, 2u, 254u})
+            EXPECT_EQ(counted_minimisers(counter, cutoff), expected_minimisers(counts, cutoff)) << +cutoff;
+
+        EXPECT_EQ(spill_directories(), existing_directories + 1u);
+    }
+
+    EXPECT_EQ(spill_directories(), existing_directories);
+    EXPECT_TRUE(std::filesystem::exists(tmp_prefix / "foreign"));
+    std::filesystem::remove_all(tmp_prefix);
+}
+
+TEST(minimiser_counter, several_counters)
+{
+    std::filesystem::path const tmp_prefix{std::filesystem::temp_directory_path() / "raptor_minimiser_counters"};
+    std::mt19937_64 engine{42u};
+    std::map<uint64_t, size_t> counts{};
+
+    // Each counter writes more than 64 runs to disk, i.e., the runs are merged before they are read.
+    std::vector<std::unique_ptr<raptor::minimiser_counter>> counters{};
+    std::vector<raptor::minimiser_counter *> pointers{};
+    for (size_t i = 0; i < 3u; ++i)
+        pointers.push_back(
+            counters.emplace_back(std::make_unique<raptor::minimiser_counter>(8u * 1024u, tmp_prefix)).get());
+
+    for (size_t i = 0; i < 300'000u; ++i)
+    {
+        uint64_t const value = i % 2u ? engine() % 20'000u : engine() % 100u;
+        ++counts[value];
+        pointers[i % pointers.size()]->insert(value);
+    }
+
+    for (uint8_t const cutoff : {1u, 2u, 254u})
+    {
+        std::vector<uint64_t> result{};
+        raptor::minimiser_counter::for_each(pointers,
+                                            cutoff,
+                                            [&result](uint64_t const value)
+                                            {
+                                                result.push_back(value);
+                                            });
+        EXPECT_EQ(result, expected_minimisers(counts, cutoff)) << +cutoff;
+    }
+}
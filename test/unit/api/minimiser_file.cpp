@@ -0,0 +1,169 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <set>
+
+#include <raptor/io/minimiser_file.hpp>
+
+static std::filesystem::path const minimiser_path{std::filesystem::temp_directory_path() / "raptor_test.minimiser"};
+static seqan3::shape const shape{seqan3::bin_literal{0b1101}};
+
+std::vector<uint64_t> write_and_read(std::vector<uint64_t> const & values)
+{
+    raptor::minimiser_file_writer writer{minimiser_path, shape, 12u, 3u};
+    for (uint64_t const value : values)
+        writer.push_back(value);
+    EXPECT_EQ(writer.finish(), values.size());
+
+    raptor::minimiser_file_reader reader{minimiser_path};
+    std::vector<uint64_t> result{};
+    reader.for_each(
+        [&result](uint64_t const value)
+        {
+            result.push_back(value);
+        });
+    return result;
+}
+
+TEST(minimiser_file, header)
+{
+    write_and_read({1u, 2u, 3u});
+
+    raptor::minimiser_file_header const header = raptor::minimiser_file_header::read(minimiser_path);
+    EXPECT_EQ(header.version, raptor::minimiser_file_header::current_version);
+    EXPECT_EQ(header.to_shape(), shape);
+    EXPECT_EQ(header.window_size, 12u);
+    EXPECT_EQ(header.cutoff, 3u);
+    EXPECT_EQ(header.count, 3u);
+    EXPECT_EQ(header.block_count, 1u);
+}
+
+TEST(minimiser_file, round_trip)
+{
+    std::mt19937_64 engine{42u};
+
+    for (size_t const size : {0u, 1u, 1023u, 1024u, 1025u, 100'000u})
+    {
+        std::set<uint64_t> values{};
+        while (values.size() < size)
+            values.insert(engine() >> 24); // 40-bit values, like the minimisers of 20-mers.
+
+        std::vector<uint64_t> const expected(values.begin(), values.end());
+        EXPECT_EQ(write_and_read(expected), expected) << "size: " << size;
+    }
+
+    // Gaps of width 0 and 64.
+    std::vector<uint64_t> extreme{0u, 1u, 2u, 3u, 4u, 0xFFFFFFFFFFFFFFFFULL};
+    EXPECT_EQ(write_and_read(extreme), extreme);
+    extreme.pop_back();
+    EXPECT_EQ(write_and_read(extreme), extreme);
+}
+
+TEST(minimiser_file, compression)
+{
+    std::mt19937_64 engine{42u};
+    std::set<uint64_t> values{};
+    while (values.size() < 200'000u)
+        values.insert(engine() >> 24);
+
+    write_and_read(std::vector<uint64_t>(values.begin(), values.end()));
+    // 40-bit values with an average gap of about 2^22 need about 26 bits per value.
+    EXPECT_LT(std::filesystem::file_size(minimiser_path), values.size() * sizeof(uint64_t) / 2u);
+}
+
+TEST(minimiser_file, contains)
+{
+    std::vector<uint64_t> values{};
+    for (uint64_t value = 10u; values.size() < 5'000u; value += 3u)
+        values.push_back(value);
+    write_and_read(values);
+
+    raptor::minimiser_file_reader reader{minimiser_path};
+    EXPECT_EQ(reader.header().block_count, 5u);
+    EXPECT_FALSE(reader.contains(0u));
+    EXPECT_TRUE(reader.contains(10u));
+    EXPECT_FALSE(reader.contains(11u));
+    EXPECT_TRUE(reader.contains(values[1024]));
+    EXPECT_TRUE(reader.contains(values.back()));
+    EXPECT_FALSE(reader.contains(values.back() + 1u));
+}
+
+TEST(minimiser_file, spans)
+{
+    std::vector<uint64_t> values(2'500u);
+    std::iota(values.begin(), values.end(), 100u);
+    write_and_read(values);
+
+    raptor::minimiser_file_reader const reader{minimiser_path};
+    std::vector<size_t> sizes{};
+    std::vector<uint64_t> result{};
+    reader.for_each_span(
+        [&](std::span<uint64_t const> const span)
+        {
+            sizes.push_back(span.size());
+            result.insert(result.end(), span.begin(), span.end());
+        });
+
+    EXPECT_EQ(sizes, (std::vector<size_t>{1024u, 1024u, 452u}));
+    EXPECT_EQ(result, values);
+}
+
+TEST(minimiser_file, empty)
+{
+    { std::ofstream file{minimiser_path}; }
+
+    raptor::minimiser_file_reader const reader{minimiser_path};
+    EXPECT_EQ(reader.header().version, 0u);
+    reader.for_each(
+        [](uint64_t const)
+        {
+            FAIL();
+        });
+
+    std::filesystem::remove(minimiser_path);
+    EXPECT_THROW(raptor::minimiser_file_reader{minimiser_path}, std::runtime_error);
+}
+
+TEST(minimiser_file, version_0)
+{
+    std::filesystem::path header_path{minimiser_path};
+    header_path.replace_extension("header");
+
+    std::vector<uint64_t> const values{7u, 3u, 5u};
+    {
+        std::ofstream file{minimiser_path, std::ios::binary};
+        file.write(reinterpret_cast<char const *>(values.data()), values.size() * sizeof(uint64_t));
+        std::ofstream header_file{header_path};
+        header_file << "1101\t12\t3\t3\n";
+    }
+
+    raptor::minimiser_file_reader reader{minimiser_path};
+    EXPECT_EQ(reader.header().version, 0u);
+    std::vector<uint64_t> result{};
+    reader.for_each(
+        [&result](uint64_t const value)
+        {
+            result.push_back(value);
+        });
+    EXPECT_EQ(result, values);
+    EXPECT_TRUE(reader.contains(5u));
+
+    raptor::minimiser_file_header const header = raptor::minimiser_file_header::read(minimiser_path);
+    EXPECT_EQ(header.version, 0u);
+    EXPECT_EQ(header.to_shape(), shape);
+    EXPECT_EQ(header.window_size, 12u);
+    EXPECT_EQ(header.cutoff, 3u);
+    EXPECT_EQ(header.count, 3u);
+
+    std::filesystem::remove(header_path);
+    EXPECT_THROW(raptor::minimiser_file_header::read(minimiser_path), std::runtime_error);
+}
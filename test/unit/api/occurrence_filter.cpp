@@ -0,0 +1,85 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <thread>
+
+#include <raptor/prepare/occurrence_filter.hpp>
+
+TEST(occurrence_filter, saturates)
+{
+    raptor::occurrence_filter filter{1024u};
+    EXPECT_EQ(filter.size_in_bytes(), 1024u);
+    EXPECT_EQ(filter.count(42u), 0u);
+
+    for (uint8_t expected = 1u; expected <= 5u; ++expected)
+    {
+        filter.insert(42u);
+        EXPECT_EQ(filter.count(42u), std::min(expected, raptor::occurrence_filter::max_count));
+    }
+}
+
+TEST(occurrence_filter, never_underestimates)
+{
+    std::mt19937_64 engine{42u};
+    std::map<uint64_t, size_t> counts{};
+    // Far too small on purpose: 4096 counters for up to 20'000 values.
+    raptor::occurrence_filter filter{1024u};
+
+    for (size_t i = 0; i < 30'000u; ++i)
+    {
+        uint64_t const value = engine() % 20'000u;
+        ++counts[value];
+        filter.insert(value);
+    }
+
+    for (auto const & [value, count] : counts)
+        EXPECT_GE(filter.count(value), std::min<size_t>(count, raptor::occurrence_filter::max_count)) << value;
+}
+
+TEST(occurrence_filter, singletons)
+{
+    raptor::occurrence_filter filter{1ULL << 20};
+    size_t false_positives{};
+
+    // Consecutive values, like k-mers that differ in one base, must not share counters.
+    for (uint64_t value = 0; value < 100'000u; ++value)
+        filter.insert(value);
+    for (uint64_t value = 0; value < 100'000u; ++value)
+        false_positives += filter.count(value) > 1u;
+
+    EXPECT_LT(false_positives, 1'000u);
+}
+
+TEST(occurrence_filter, concurrent_insert)
+{
+    raptor::occurrence_filter filter{1ULL << 12};
+    std::vector<uint64_t> values(40'000u);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = (i * 0x9E3779B97F4A7C15ULL) % 10'000u;
+
+    std::vector<std::thread> workers{};
+    for (size_t t = 0; t < 4u; ++t)
+        workers.emplace_back(
+            [&, t]()
+            {
+                for (size_t i = t; i < values.size(); i += 4u)
+                    filter.concurrent_insert(values[i]);
+            });
+    for (auto & worker : workers)
+        worker.join();
+
+    // The order of insertions may differ, but each insertion is atomic. Hence, no count may be too small.
+    std::map<uint64_t, size_t> counts{};
+    for (uint64_t const value : values)
+        ++counts[value];
+    for (auto const & [value, count] : counts)
+        EXPECT_GE(filter.count(value), std::min<size_t>(count, raptor::occurrence_filter::max_count)) << value;
+}
@@ -0,0 +1,76 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <istream>
+#include <string>
+
+#include <raptor/io/record_chunks.hpp>
+
+static std::string join(std::vector<std::string_view> const & chunks)
+{
+    std::string result{};
+    for (std::string_view const chunk : chunks)
+        result += chunk;
+    return result;
+}
+
+TEST(record_chunks, fasta)
+{
+    std::string fasta{};
+    for (size_t i = 0; i < 100u; ++i)
+        fasta += ">seq" + std::to_string(i) + "\nACGTACGT\nACGT\n";
+
+    for (size_t const count : {1u, 2u, 7u, 100u, 1000u})
+    {
+        std::vector<std::string_view> const chunks = raptor::detail::split_records(fasta, count);
+        EXPECT_EQ(chunks.size(), std::min<size_t>(count, 100u));
+        EXPECT_EQ(join(chunks), fasta);
+        for (std::string_view const chunk : chunks)
+            EXPECT_TRUE(chunk.starts_with(">seq"));
+    }
+}
+
+TEST(record_chunks, fastq)
+{
+    // Quality lines start with '@'.
+    std::string fastq{};
+    for (size_t i = 0; i < 100u; ++i)
+        fastq += "@read" + std::to_string(i) + "\nACGT\n+\n@@@@\n";
+
+    for (size_t const count : {1u, 2u, 7u, 100u, 1000u})
+    {
+        std::vector<std::string_view> const chunks = raptor::detail::split_records(fastq, count);
+        EXPECT_EQ(chunks.size(), std::min<size_t>(count, 100u));
+        EXPECT_EQ(join(chunks), fastq);
+        for (std::string_view const chunk : chunks)
+            EXPECT_TRUE(chunk.starts_with("@read"));
+    }
+}
+
+TEST(record_chunks, unknown_format)
+{
+    std::string const text{"ACGT\nACGT\n"};
+    std::vector<std::string_view> const chunks = raptor::detail::split_records(text, 4u);
+    ASSERT_EQ(chunks.size(), 1u);
+    EXPECT_EQ(chunks[0], text);
+}
+
+TEST(record_chunks, memory_streambuf)
+{
+    std::string const text{">seq\nACGT\n"};
+    raptor::detail::memory_streambuf buffer{text};
+    std::istream stream{&buffer};
+
+    std::string line{};
+    ASSERT_TRUE(std::getline(stream, line));
+    EXPECT_EQ(line, ">seq");
+    ASSERT_TRUE(std::getline(stream, line));
+    EXPECT_EQ(line, "ACGT");
+    EXPECT_FALSE(std::getline(stream, line));
+}
@@ -0,0 +1,118 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+
+#include <raptor/build/hibf/sorted_kmers.hpp>
+
+TEST(sorted_kmers, sort_and_deduplicate)
+{
+    std::mt19937_64 engine{42u};
+
+    // Small inputs use std::sort, large inputs the radix sort.
+    for (size_t const size : {0u, 10u, 100'000u, 3'000'000u})
+    {
+        for (size_t const threads : {1u, 4u})
+        {
+            std::vector<uint64_t> kmers(size);
+            for (uint64_t & kmer : kmers)
+                kmer = engine() % (2u * size + 1u);
+
+            std::set<uint64_t> const expected(kmers.begin(), kmers.end());
+            raptor::hibf::sort_and_deduplicate(kmers, threads);
+
+            EXPECT_TRUE(std::ranges::equal(kmers, expected)) << "size: " << size << ", threads: " << threads;
+        }
+    }
+}
+
+std::vector<uint64_t> to_vector(raptor::hibf::kmer_runs const & runs)
+{
+    std::vector<uint64_t> result{};
+    runs.for_each(
+        [&result](uint64_t const value)
+        {
+            result.push_back(value);
+        });
+    return result;
+}
+
+TEST(sorted_kmers, kmer_runs)
+{
+    raptor::hibf::kmer_runs runs{};
+    runs.push_back(std::vector<uint64_t>{1u, 3u, 5u});
+    runs.push_back(std::vector<uint64_t>{2u, 3u, 4u});
+    runs.push_back(std::vector<uint64_t>{});
+    runs.push_back(std::vector<uint64_t>{5u, 9u});
+
+    std::vector<uint64_t> const expected{1u, 2u, 3u, 4u, 5u, 9u};
+    EXPECT_EQ(to_vector(runs), expected);
+    EXPECT_EQ(runs.count(), expected.size());
+    EXPECT_EQ(to_vector(runs), expected);
+
+    raptor::hibf::kmer_runs parent{};
+    parent.push_back(std::vector<uint64_t>{0u, 7u});
+    parent.push_back(std::move(runs));
+    EXPECT_TRUE(runs.empty());
+    EXPECT_EQ(to_vector(parent), (std::vector<uint64_t>{0u, 1u, 2u, 3u, 4u, 5u, 7u, 9u}));
+}
+
+TEST(sorted_kmers, spill)
+{
+    std::filesystem::path const tmp_prefix{std::filesystem::temp_directory_path() / "raptor_sorted_kmers_spill"};
+    std::mt19937_64 engine{42u};
+    std::set<uint64_t> expected{};
+
+    // Directories created by the spill start with the prefix, followed by a unique suffix.
+    auto spill_directories = [&tmp_prefix]()
+    {
+        size_t count{};
+        std::string const name{tmp_prefix.filename().string() + '.'};
+        for (auto const & entry : std::filesystem::directory_iterator{tmp_prefix.parent_path()})
+            count += entry.path().filename().string().starts_with(name);
+        return count;
+    };
+
+    // A file that already exists at the prefix must not be removed.
+    std::filesystem::create_directories(tmp_prefix);
+    std::ofstream{tmp_prefix / "foreign"};
+    size_t const existing_directories = spill_directories();
+
+    {
+        raptor::hibf::kmer_spill spill{};
+        spill.configure(1024u, tmp_prefix); // 128 k-mers
+        raptor::hibf::kmer_runs parent{spill};
+
+        for (size_t i = 0; i < 100u; ++i)
+        {
+            raptor::hibf::kmer_runs child{spill};
+            for (size_t j = 0; j < 3u; ++j)
+            {
+                std::vector<uint64_t> kmers(50u);
+                for (uint64_t & kmer : kmers)
+                    kmer = engine() % 10'000u;
+                raptor::hibf::sort_and_deduplicate(kmers, 1u);
+                expected.insert(kmers.begin(), kmers.end());
+                child.push_back(std::move(kmers));
+            }
+            parent.push_back(std::move(child));
+        }
+
+        EXPECT_EQ(spill_directories(), existing_directories + 1u);
+        EXPECT_EQ(parent.count(), expected.size());
+        EXPECT_TRUE(std::ranges::equal(to_vector(parent), expected));
+    }
+
+    EXPECT_EQ(spill_directories(), existing_directories);
+    EXPECT_TRUE(std::filesystem::exists(tmp_prefix / "foreign"));
+    std::filesystem::remove_all(tmp_prefix);
+}
@@ -0,0 +1,78 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+
+#include <raptor/build/hibf/task_pool.hpp>
+
+// Every call creates a group and waits for it, like raptor::hibf::hierarchical_build.
+size_t count_nodes(raptor::hibf::task_pool & pool, size_t const depth)
+{
+    if (depth == 0u)
+        return 1u;
+
+    std::atomic<size_t> count{1u};
+    raptor::hibf::task_group tasks{pool};
+    for (size_t i = 0; i < 4u; ++i)
+        tasks.run(
+            [&]()
+            {
+                count += count_nodes(pool, depth - 1u);
+            });
+    tasks.wait();
+
+    return count;
+}
+
+TEST(task_pool, nested)
+{
+    for (size_t const threads : {1u, 2u, 8u})
+    {
+        raptor::hibf::task_pool pool{};
+        pool.start(threads);
+        // 1 + 4 + 16 + 64 + 256 + 1024
+        EXPECT_EQ(count_nodes(pool, 5u), 1365u) << "threads: " << threads;
+    }
+}
+
+TEST(task_pool, without_start)
+{
+    raptor::hibf::task_pool pool{};
+    EXPECT_EQ(count_nodes(pool, 3u), 85u);
+}
+
+TEST(task_pool, exception)
+{
+    raptor::hibf::task_pool pool{};
+    pool.start(4u);
+
+    std::atomic<size_t> finished{};
+    raptor::hibf::task_group tasks{pool};
+    for (size_t i = 0; i < 100u; ++i)
+        tasks.run(
+            [&finished, i]()
+            {
+                if (i == 42u)
+                    throw std::runtime_error{"task failed"};
+                ++finished;
+            });
+
+    EXPECT_THROW(tasks.wait(), std::runtime_error);
+    EXPECT_EQ(finished, 99u);
+
+    // The group can be reused.
+    tasks.run(
+        [&finished]()
+        {
+            ++finished;
+        });
+    EXPECT_NO_THROW(tasks.wait());
+    EXPECT_EQ(finished, 100u);
+}
@@ -84,7 +84,7 @@ TEST_F(argparse_main, no_subparser)
     cli_test_result const result = execute_app("raptor", "foo");
     std::string const expected{
         "[Error] You misspelled the subcommand! Please specify which sub-program you want to use: one "
-        "of [build, layout, prepare, search, upgrade]. Use -h/--help for more information.\n"};
+        "of [build, layout, prepare, search, update, upgrade]. Use -h/--help for more information.\n"};
     EXPECT_EQ(result.out, std::string{});
     EXPECT_EQ(result.err, expected);
     RAPTOR_ASSERT_FAIL_EXIT(result);
@@ -95,7 +95,7 @@ TEST_F(argparse_main, unknown_option)
     cli_test_result const result = execute_app("raptor", "-v");
     std::string const expected{
         "[Error] You misspelled the subcommand! Please specify which sub-program you want to use: one "
-        "of [build, layout, prepare, search, upgrade]. Use -h/--help for more information.\n"};
+        "of [build, layout, prepare, search, update, upgrade]. Use -h/--help for more information.\n"};
     EXPECT_EQ(result.out, std::string{});
     EXPECT_EQ(result.err, expected);
     RAPTOR_ASSERT_FAIL_EXIT(result);
@@ -526,12 +526,16 @@ TEST_F(argparse_upgrade, ambiguous_index)
 
 TEST_F(argparse_upgrade, unsupported_index)
 {
-    cli_test_result const result = execute_app("raptor",
-                                               "upgrade",
-                                               "--input",
-                                               data("1bins23window.index"),
-                                               "--output upgrade.index",
-                                               "--fpr 0.05");
+    // Indices of version 2 are upgraded to the current version, which cannot be upgraded.
+    cli_test_result const upgrade_result = execute_app("raptor",
+                                                       "upgrade",
+                                                       "--input",
+                                                       data("1bins23window.index"),
+                                                       "--output current.index");
+    RAPTOR_ASSERT_ZERO_EXIT(upgrade_result);
+
+    cli_test_result const result =
+        execute_app("raptor", "upgrade", "--input current.index", "--output upgrade.index", "--fpr 0.05");
     EXPECT_EQ(result.out, std::string{});
     EXPECT_EQ(result.err, std::string{"[Error] Unsupported index version. Use Raptor 2.0's upgrade first.\n"});
     RAPTOR_ASSERT_FAIL_EXIT(result);
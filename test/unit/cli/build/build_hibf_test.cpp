@@ -97,6 +97,94 @@ TEST_F(build_hibf, three_levels)
     compare_index<raptor::index_structure::hibf>(data("three_levels.hibf"), "raptor.index");
 }
 
+TEST_F(build_hibf, minimiser_cache)
+{
+    for (size_t run : {1u, 2u}) // The second run reads all minimisers from the cache.
+    {
+        cli_test_result const result = execute_app("raptor",
+                                                   "build",
+                                                   "--kmer 19",
+                                                   "--window 19",
+                                                   "--hash 2",
+                                                   "--fpr 0.05",
+                                                   "--threads 1",
+                                                   "--minimiser-cache cache",
+                                                   "--output raptor.index",
+                                                   "--quiet",
+                                                   "--input",
+                                                   data("three_levels.pack"));
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+        EXPECT_FALSE(std::filesystem::is_empty("cache")) << "Run " << run;
+
+        compare_index<raptor::index_structure::hibf>(data("three_levels.hibf"), "raptor.index");
+    }
+}
+
+TEST_F(build_hibf, memory_limit)
+{
+    cli_test_result const result = execute_app("raptor",
+                                               "build",
+                                               "--kmer 19",
+                                               "--window 19",
+                                               "--hash 2",
+                                               "--fpr 0.05",
+                                               "--threads 2",
+                                               "--memory-limit 1",
+                                               "--output raptor.index",
+                                               "--quiet",
+                                               "--input",
+                                               data("three_levels.pack"));
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    // The k-mer runs are spilled to a directory "raptor.index.tmp.<unique suffix>", which is removed afterwards.
+    for (auto const & entry : std::filesystem::directory_iterator{"."})
+        EXPECT_FALSE(entry.path().filename().string().starts_with("raptor.index.tmp")) << entry.path();
+
+    compare_index<raptor::index_structure::hibf>(data("three_levels.hibf"), "raptor.index");
+}
+
+TEST_F(build_hibf, checkpoints)
+{
+    for (size_t run : {1u, 2u}) // The second run loads all lower-level IBFs from the checkpoints.
+    {
+        cli_test_result const result = execute_app("raptor",
+                                                   "build",
+                                                   "--kmer 19",
+                                                   "--window 19",
+                                                   "--hash 2",
+                                                   "--fpr 0.05",
+                                                   "--threads 2",
+                                                   "--checkpoint-dir checkpoints",
+                                                   "--output raptor.index",
+                                                   "--quiet",
+                                                   "--input",
+                                                   data("three_levels.pack"));
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+        EXPECT_FALSE(std::filesystem::is_empty("checkpoints")) << "Run " << run;
+    }
+
+    // The IBFs are numbered differently when loaded from checkpoints. The search results are the same.
+    cli_test_result const result = execute_app("raptor",
+                                               "search",
+                                               "--output search.out",
+                                               "--error 0",
+                                               "--index raptor.index",
+                                               "--quiet",
+                                               "--query ",
+                                               data("query.fq"));
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_search(32, 0, "search.out");
+}
+
 TEST_F(build_hibf, verbose)
 {
     cli_test_result const result = execute_app("raptor",
@@ -115,3 +203,53 @@ TEST_F(build_hibf, verbose)
 
     compare_index<raptor::index_structure::hibf>(data("three_levels.hibf"), "raptor.index");
 }
+
+TEST_F(build_hibf, dry_run)
+{
+    cli_test_result const result = execute_app("raptor",
+                                               "build",
+                                               "--kmer 19",
+                                               "--window 19",
+                                               "--hash 2",
+                                               "--fpr 0.05",
+                                               "--threads 2",
+                                               "--dry-run",
+                                               "--output raptor.index",
+                                               "--input",
+                                               data("three_levels.pack"));
+    EXPECT_NE(result.out.find("Level 2"), std::string::npos);
+    EXPECT_NE(result.out.find("Index size"), std::string::npos);
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+    EXPECT_FALSE(std::filesystem::exists("raptor.index"));
+}
+
+TEST_F(build_hibf, same_index_for_any_thread_count)
+{
+    for (std::string const threads : {"1", "4"})
+    {
+        cli_test_result const result = execute_app("raptor",
+                                                   "build",
+                                                   "--kmer 19",
+                                                   "--window 19",
+                                                   "--hash 2",
+                                                   "--fpr 0.05",
+                                                   "--threads",
+                                                   threads,
+                                                   "--output",
+                                                   "raptor_" + threads + ".index",
+                                                   "--quiet",
+                                                   "--input",
+                                                   data("three_levels.pack"));
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    }
+
+    std::ifstream serial{"raptor_1.index", std::ios::binary};
+    std::ifstream parallel{"raptor_4.index", std::ios::binary};
+    EXPECT_TRUE(std::ranges::equal(std::istreambuf_iterator<char>{serial},
+                                   std::istreambuf_iterator<char>{},
+                                   std::istreambuf_iterator<char>{parallel},
+                                   std::istreambuf_iterator<char>{}));
+}
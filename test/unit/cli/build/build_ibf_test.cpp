@@ -106,3 +106,76 @@ TEST_F(build_ibf, verbose)
 
     compare_index(ibf_path(16, 19), "raptor.index");
 }
+
+TEST_F(build_ibf, estimate_bin_size)
+{
+    { // generate input file
+        std::ofstream file{"raptor_cli_test.txt"};
+        for (auto && file_path : get_repeated_bins(16u))
+            file << file_path << '\n';
+        file << '\n';
+    }
+
+    { // Computes the sketches and keeps all minimisers in memory.
+        cli_test_result const result = execute_app("raptor",
+                                                   "build",
+                                                   "--kmer 19",
+                                                   "--window 19",
+                                                   "--threads 2",
+                                                   "--estimate-bin-size",
+                                                   "--sketch-cache sketches",
+                                                   "--retain-hashes 16",
+                                                   "--output raptor.index",
+                                                   "--quiet",
+                                                   "--input",
+                                                   "raptor_cli_test.txt");
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    }
+
+    EXPECT_FALSE(std::filesystem::is_empty("sketches"));
+
+    { // Reuses the sketches and reads the user bins again.
+        cli_test_result const result = execute_app("raptor",
+                                                   "build",
+                                                   "--kmer 19",
+                                                   "--window 19",
+                                                   "--threads 1",
+                                                   "--estimate-bin-size",
+                                                   "--sketch-cache sketches",
+                                                   "--output raptor2.index",
+                                                   "--quiet",
+                                                   "--input",
+                                                   "raptor_cli_test.txt");
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    }
+
+    compare_index("raptor.index", "raptor2.index");
+}
+
+TEST_F(build_ibf, dry_run)
+{
+    { // generate input file
+        std::ofstream file{"raptor_cli_test.txt"};
+        for (auto && file_path : get_repeated_bins(16u))
+            file << file_path << '\n';
+        file << '\n';
+    }
+
+    cli_test_result const result = execute_app("raptor",
+                                               "build",
+                                               "--kmer 19",
+                                               "--window 19",
+                                               "--threads 1",
+                                               "--dry-run",
+                                               "--output raptor.index",
+                                               "--input",
+                                               "raptor_cli_test.txt");
+    EXPECT_NE(result.out.find("Index size"), std::string::npos);
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+    EXPECT_FALSE(std::filesystem::exists("raptor.index"));
+}
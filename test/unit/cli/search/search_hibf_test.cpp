@@ -105,3 +105,101 @@ TEST_F(search_hibf, three_levels)
 
     compare_search(32, 0, "search.out");
 }
+
+TEST_F(search_hibf, lazy_load)
+{
+    { // The offsets of the IBFs are written by raptor build.
+        cli_test_result const result = execute_app("raptor",
+                                                   "build",
+                                                   "--kmer 19",
+                                                   "--window 19",
+                                                   "--hash 2",
+                                                   "--fpr 0.05",
+                                                   "--output raptor.index",
+                                                   "--quiet",
+                                                   "--input",
+                                                   data("three_levels.pack"));
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    }
+
+    cli_test_result const result = execute_app("raptor",
+                                               "search",
+                                               "--output search.out",
+                                               "--error 0",
+                                               "--index raptor.index",
+                                               "--lazy-load",
+                                               "--quiet",
+                                               "--query ",
+                                               data("query.fq"));
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_search(32, 0, "search.out");
+}
+
+TEST_F(search_hibf, cache_limit)
+{
+    { // The offsets of the IBFs are written by raptor build.
+        cli_test_result const result = execute_app("raptor",
+                                                   "build",
+                                                   "--kmer 19",
+                                                   "--window 19",
+                                                   "--hash 2",
+                                                   "--fpr 0.05",
+                                                   "--output raptor.index",
+                                                   "--quiet",
+                                                   "--input",
+                                                   data("three_levels.pack"));
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    }
+
+    cli_test_result const result = execute_app("raptor",
+                                               "search",
+                                               "--output search.out",
+                                               "--error 0",
+                                               "--index raptor.index",
+                                               "--cache-limit 1",
+                                               "--threads 2",
+                                               "--quiet",
+                                               "--query ",
+                                               data("query.fq"));
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_search(32, 0, "search.out");
+}
+
+TEST_F(search_hibf, uncompressed_levels)
+{
+    {
+        cli_test_result const result = execute_app("raptor",
+                                                   "build",
+                                                   "--kmer 19",
+                                                   "--window 19",
+                                                   "--hash 2",
+                                                   "--fpr 0.05",
+                                                   "--compressed",
+                                                   "--uncompressed-levels 1",
+                                                   "--output raptor.index",
+                                                   "--quiet",
+                                                   "--input",
+                                                   data("three_levels.pack"));
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    }
+
+    cli_test_result const result = execute_app("raptor",
+                                               "search",
+                                               "--output search.out",
+                                               "--error 0",
+                                               "--index raptor.index",
+                                               "--quiet",
+                                               "--query ",
+                                               data("query.fq"));
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_search(32, 0, "search.out");
+}
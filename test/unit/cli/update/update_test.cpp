@@ -0,0 +1,192 @@
+// --------------------------------------------------------------------------------------------------
+// Copyright (c) 2006-2023, Knut Reinert & Freie Universität Berlin
+// Copyright (c) 2016-2023, Knut Reinert & MPI für molekulare Genetik
+// This file may be used, modified and/or redistributed under the terms of the 3-clause BSD-License
+// shipped with this file and also available at: https://github.com/seqan/raptor/blob/main/LICENSE.md
+// --------------------------------------------------------------------------------------------------
+
+#include <raptor/test/cli_test.hpp>
+
+struct update : public raptor_base, public testing::WithParamInterface<size_t>
+{
+    // Builds an index from the first 48 of the 64 repeated bins, reserving the given number of bins.
+    static inline void build_partial_index(size_t const reserved_bins)
+    {
+        {
+            std::ofstream file{"old_bins.txt"};
+            std::ofstream new_file{"new_bins.txt"};
+            size_t current_bin{};
+            for (auto && file_path : get_repeated_bins(16u))
+                (current_bin++ < 48u ? file : new_file) << file_path << '\n';
+        }
+
+        cli_test_result const result = execute_app("raptor",
+                                                   "build",
+                                                   "--kmer 19",
+                                                   "--window 19",
+                                                   "--reserve-bins ",
+                                                   std::to_string(reserved_bins),
+                                                   "--output raptor.index",
+                                                   "--quiet",
+                                                   "--input old_bins.txt");
+        EXPECT_EQ(result.out, std::string{});
+        EXPECT_EQ(result.err, std::string{});
+        RAPTOR_ASSERT_ZERO_EXIT(result);
+    }
+};
+
+TEST_P(update, insert)
+{
+    size_t const reserved_bins = GetParam();
+    build_partial_index(reserved_bins);
+
+    cli_test_result const result = execute_app("raptor",
+                                               "update",
+                                               "--index raptor.index",
+                                               "--insert new_bins.txt",
+                                               "--output raptor.index",
+                                               "--quiet");
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_index(ibf_path(16, 19), "raptor.index");
+}
+
+INSTANTIATE_TEST_SUITE_P(update_suite,
+                         update,
+                         testing::Values(0, 8, 16),
+                         [](testing::TestParamInfo<update::ParamType> const & info)
+                         {
+                             return std::to_string(info.param) + "_reserved";
+                         });
+
+TEST_F(update, search_reserved)
+{
+    build_partial_index(16u);
+
+    cli_test_result const result = execute_app("raptor",
+                                               "search",
+                                               "--output search.out",
+                                               "--error 1",
+                                               "--index raptor.index",
+                                               "--quiet",
+                                               "--query ",
+                                               data("query.fq"));
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_search(12, 1, "search.out");
+}
+
+TEST_F(update, remove_and_insert)
+{
+    build_partial_index(16u);
+
+    {
+        std::ofstream file{"remove_bins.txt"};
+        file << data("bin2.fa").string() << '\n' << data("bin3.fa").string() << '\n';
+    }
+    {
+        std::ofstream file{"insert_bins.txt"};
+        file << data("bin2.fa").string() << '\n' << data("bin3.fa").string() << '\n';
+    }
+
+    cli_test_result const result1 = execute_app("raptor",
+                                                "update",
+                                                "--index raptor.index",
+                                                "--remove remove_bins.txt",
+                                                "--output removed.index",
+                                                "--quiet");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    // The freed bins are reused.
+    cli_test_result const result2 = execute_app("raptor",
+                                                "update",
+                                                "--index removed.index",
+                                                "--insert insert_bins.txt",
+                                                "--output reinserted.index",
+                                                "--quiet");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    compare_index(std::filesystem::path{"raptor.index"}, "reinserted.index");
+}
+
+TEST_F(update, replace)
+{
+    build_partial_index(16u);
+
+    {
+        std::ofstream file{"replace_bins.txt"};
+        file << data("bin1.fa").string() << '\t' << data("bin4.fa").string() << '\n';
+    }
+    {
+        std::ofstream file{"restore_bins.txt"};
+        file << data("bin4.fa").string() << '\t' << data("bin1.fa").string() << '\n';
+    }
+
+    cli_test_result const result1 = execute_app("raptor",
+                                                "update",
+                                                "--index raptor.index",
+                                                "--replace replace_bins.txt",
+                                                "--output replaced.index",
+                                                "--quiet");
+    EXPECT_EQ(result1.out, std::string{});
+    EXPECT_EQ(result1.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result1);
+
+    // bin4.fa is contained in the index more than once; the first occurrence is the replaced bin 0.
+    cli_test_result const result2 = execute_app("raptor",
+                                                "update",
+                                                "--index replaced.index",
+                                                "--replace restore_bins.txt",
+                                                "--output restored.index",
+                                                "--quiet");
+    EXPECT_EQ(result2.out, std::string{});
+    EXPECT_EQ(result2.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result2);
+
+    compare_index(std::filesystem::path{"raptor.index"}, "restored.index");
+}
+
+TEST_F(update, remove_unknown)
+{
+    build_partial_index(16u);
+
+    {
+        std::ofstream file{"remove_bins.txt"};
+        file << "unknown.fa\n";
+    }
+
+    cli_test_result const result = execute_app("raptor",
+                                               "update",
+                                               "--index raptor.index",
+                                               "--remove remove_bins.txt",
+                                               "--output raptor.index");
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{"[Error] The user bin unknown.fa is not part of the index.\n"});
+    RAPTOR_ASSERT_FAIL_EXIT(result);
+}
+
+TEST_F(update, hibf)
+{
+    {
+        std::ofstream file{"new_bins.txt"};
+        file << data("bin1.fa").string() << '\n';
+    }
+
+    cli_test_result const result = execute_app("raptor",
+                                               "update",
+                                               "--index ",
+                                               ibf_path(16, 23, is_compressed::no, is_hibf::yes),
+                                               "--insert new_bins.txt",
+                                               "--output raptor.index");
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{"[Error] Updating an HIBF is not supported.\n"});
+    RAPTOR_ASSERT_FAIL_EXIT(result);
+}
@@ -134,3 +134,33 @@ TEST_F(upgrade, partitioned_ibf_via_bin_path)
 
     compare_search(16, 1, "search.out");
 }
+
+TEST_F(upgrade, version_2)
+{
+    cli_test_result const result =
+        execute_app("raptor", "upgrade", "--input ", ibf_path(16, 19), "--output raptor.index");
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    raptor::raptor_index<> index{};
+    {
+        std::ifstream is{"raptor.index", std::ios::binary};
+        cereal::BinaryInputArchive iarchive{is};
+        index.load_parameters(iarchive);
+    }
+    EXPECT_EQ(index.parsed_version(), raptor::raptor_index<>::version);
+
+    compare_index(ibf_path(16, 19), "raptor.index");
+}
+
+TEST_F(upgrade, version_2_hibf)
+{
+    cli_test_result const result =
+        execute_app("raptor", "upgrade", "--input ", data("three_levels.hibf"), "--output raptor.index");
+    EXPECT_EQ(result.out, std::string{});
+    EXPECT_EQ(result.err, std::string{});
+    RAPTOR_ASSERT_ZERO_EXIT(result);
+
+    compare_index<raptor::index_structure::hibf>(data("three_levels.hibf"), "raptor.index");
+}